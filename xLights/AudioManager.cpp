@@ -24,8 +24,10 @@
 #include "AudioManager.h"
 #include "kiss_fft/tools/kiss_fftr.h"
 #include "../xSchedule/md5.h"
+#include "VampFeatureCache.h"
 #include "ExternalHooks.h"
 #include "Parallel.h"
+#include "MemoryAccounting.h"
 
 extern "C"
 {
@@ -1444,86 +1446,60 @@ void AudioManager::DoPolyphonicTranscription(wxProgressDialog* dlg, AudioManager
     }
     else
     {
-        float *pdata[2];
-        long frames = _lengthMS / _intervalMS;
-        while (frames * _intervalMS < _lengthMS)
-        {
-            frames++;
-        }
-
         size_t pref_step = pt->getPreferredStepSize();
         size_t pref_block = pt->getPreferredBlockSize();
 
-        int channels = GetChannels();
-        if (channels > (int)pt->getMaxChannelCount()) {
-            channels = 1;
-        }
-
         logger_pianodata.debug("Channels %d.", GetChannels());
         logger_pianodata.debug("Step %d.", pref_step);
         logger_pianodata.debug("Block %d.", pref_block);
-        pt->initialise(channels, pref_step, pref_block);
-
-        bool first = true;
-        int start = 0;
-        long len = GetTrackSize();
-        float totalLen = len;
-        int lastProgress = 0;
-        while (len)
-        {
-            int progress = (((float)(totalLen - len) * 25) / totalLen);
-            if (lastProgress < progress)
-            {
-                fn(dlg, progress);
-                lastProgress = progress;
-            }
-            pdata[0] = GetRawLeftDataPtr(start);
-            wxASSERT(pdata[0] != nullptr);
-            pdata[1] = GetRawRightDataPtr(start);
 
-            Vamp::RealTime timestamp = Vamp::RealTime::frame2RealTime(start, GetRate());
-            Vamp::Plugin::FeatureSet features = pt->process(pdata, timestamp);
-
-            if (first && features.size() > 0)
-            {
-                logger_base.warn("DoPolyphonicTranscription: Polyphonic transcription data process oddly retrieved data.");
-                first = false;
-            }
-            if (len > pref_step)
+        // the same song transcribes the same every time
+        VampFeatureCache::Features transcription;
+        std::string cacheKey = VampFeatureCache::GetKey(this, pt, _vamp.GetPluginKey(pt), 0, pref_step, pref_block);
+        if (VampFeatureCache::Load(cacheKey, transcription))
+        {
+            logger_pianodata.debug("Polyphonic Transcription result loaded from cache.");
+            fn(dlg, 25);
+        }
+        else
+        {
+            try
             {
-                len -= pref_step;
+                transcription = VampFeatureCache::Run(this, pt, 0, pref_step, pref_block, true, [dlg, fn](int pct) { fn(dlg, pct / 4); });
+                if (!transcription.processed.empty())
+                {
+                    logger_base.warn("DoPolyphonicTranscription: Polyphonic transcription data process oddly retrieved data.");
+                }
+                VampFeatureCache::Save(cacheKey, transcription);
             }
-            else
+            catch (...)
             {
-                len = 0;
+                logger_base.warn("DoPolyphonicTranscription: Polyphonic Transcription threw an error getting the remaining features.");
             }
-            start += pref_step;
         }
 
         // Process the Polyphonic Transcription
         try
         {
             unsigned int total = 0;
-            logger_pianodata.debug("About to extract Polyphonic Transcription result.");
-            Vamp::Plugin::FeatureSet features = pt->getRemainingFeatures();
-            logger_pianodata.debug("Polyphonic Transcription result retrieved.");
+            Vamp::Plugin::FeatureList& features = transcription.remaining;
             logger_pianodata.debug("Start,Duration,CalcStart,CalcEnd,midinote");
-            for (size_t j = 0; j < features[0].size(); j++)
+            for (size_t j = 0; j < features.size(); j++)
             {
                 if (j % 10 == 0)
                 {
-                    fn(dlg, (int)(((float)j * 75.0) / (float)features[0].size()) + 25.0);
+                    fn(dlg, (int)(((float)j * 75.0) / (float)features.size()) + 25.0);
                 }
 
-                long currentstart = features[0][j].timestamp.sec * 1000 + features[0][j].timestamp.msec();
-                long currentend = currentstart + features[0][j].duration.sec * 1000 + features[0][j].duration.msec();
+                long currentstart = features[j].timestamp.sec * 1000 + features[j].timestamp.msec();
+                long currentend = currentstart + features[j].duration.sec * 1000 + features[j].duration.msec();
 
-                //printf("%f\t%f\t%f\n",(float)currentstart/1000.0, (float)currentend/1000.0, features[0][j].values[0]);
+                //printf("%f\t%f\t%f\n",(float)currentstart/1000.0, (float)currentend/1000.0, features[j].values[0]);
                 if (logger_pianodata.isDebugEnabled())
                 {
-                    logger_pianodata.debug("%d.%03d,%d.%03d,%d,%d,%f", features[0][j].timestamp.sec, features[0][j].timestamp.msec(), features[0][j].duration.sec, features[0][j].duration.msec(), currentstart, currentend, features[0][j].values[0]);
+                    logger_pianodata.debug("%d.%03d,%d.%03d,%d,%d,%f", features[j].timestamp.sec, features[j].timestamp.msec(), features[j].duration.sec, features[j].duration.msec(), currentstart, currentend, features[j].values[0]);
                 }
-                total += features[0][j].values.size();
+                total += features[j].values.size();
 
                 int sframe = currentstart / _intervalMS;
                 if (currentstart - sframe * _intervalMS > _intervalMS / 2) {
@@ -1531,7 +1507,7 @@ void AudioManager::DoPolyphonicTranscription(wxProgressDialog* dlg, AudioManager
                 }
                 int eframe = currentend / _intervalMS;
                 while (sframe <= eframe) {
-                    _frameData[sframe][4].push_back(features[0][j].values[0]);
+                    _frameData[sframe][4].push_back(features[j].values[0]);
                     sframe++;
                 }
             }
@@ -2163,6 +2139,7 @@ AudioManager::~AudioManager()
         if (_filtered.back()->pcmdata) {
             free(_filtered.back()->pcmdata);
         }
+        MemoryAccounting::Remove(MemoryAccounting::AUDIO, _filtered.back()->bytes);
         delete _filtered.back();
         _filtered.pop_back();
     }
@@ -2181,6 +2158,8 @@ AudioManager::~AudioManager()
 		free(_data[0]);
 		_data[0] = nullptr;
 	}
+    MemoryAccounting::Remove(MemoryAccounting::AUDIO, _accountedBytes);
+    _accountedBytes = 0;
     logger_base.debug("AudioManager::~AudioManager Done");
 }
 
@@ -2384,6 +2363,10 @@ int AudioManager::OpenMediaFile()
         return 1;
     }
 
+    MemoryAccounting::Remove(MemoryAccounting::AUDIO, _accountedBytes);
+    _accountedBytes = size * (_data[1] != _data[0] ? 2 : 1) + (_pcmdata != nullptr ? _pcmdatasize + PCMFUDGE : 0);
+    MemoryAccounting::Add(MemoryAccounting::AUDIO, _accountedBytes);
+
     // only initialise if we successfully got data
     if (_pcmdata != nullptr)
     {
@@ -2888,7 +2871,8 @@ void AudioManager::SwitchTo(AUDIOSAMPLETYPE type, int lowNote, int highNote) {
         fad->lowNote = 0;
         fad->highNote = 0;
         fad->type = AUDIOSAMPLETYPE::RAW;
-        _filtered.push_back(fad);
+        fad->summary0.Build(fad->data0, _trackSize);
+        AddFilteredAudioData(fad);
     }
 
     FilteredAudioData* fad = nullptr;
@@ -2928,7 +2912,8 @@ void AudioManager::SwitchTo(AUDIOSAMPLETYPE type, int lowNote, int highNote) {
                 fad->highNote = 0;
                 fad->type = type;
                 NormaliseFilteredAudioData(fad);
-                _filtered.push_back(fad);
+                fad->summary0.Build(fad->data0, _trackSize);
+                AddFilteredAudioData(fad);
             }
         }
         break;
@@ -3009,7 +2994,8 @@ void AudioManager::SwitchTo(AUDIOSAMPLETYPE type, int lowNote, int highNote) {
             fad->highNote = highNote;
             fad->type = type;
             NormaliseFilteredAudioData(fad);
-            _filtered.push_back(fad);
+            fad->summary0.Build(fad->data0, _trackSize);
+            AddFilteredAudioData(fad);
         }
     }
     break;
@@ -3017,6 +3003,10 @@ void AudioManager::SwitchTo(AUDIOSAMPLETYPE type, int lowNote, int highNote) {
             break;
     }
 
+    if (fad) {
+        _filteredData = fad->type != AUDIOSAMPLETYPE::RAW;
+    }
+
     if (fad && _pcmdata && fad->pcmdata) {
         memcpy(_pcmdata, fad->pcmdata, _pcmdatasize);
     }
@@ -3038,6 +3028,14 @@ void AudioManager::SwitchTo(AUDIOSAMPLETYPE type, int lowNote, int highNote) {
     }
 }
 
+void AudioManager::AddFilteredAudioData(FilteredAudioData* fad)
+{
+    long datasize = sizeof(float) * (_trackSize + _extra);
+    fad->bytes = datasize * (fad->data1 != nullptr ? 2 : 1) + (fad->pcmdata != nullptr ? _pcmdatasize + PCMFUDGE : 0);
+    MemoryAccounting::Add(MemoryAccounting::AUDIO, fad->bytes);
+    _filtered.push_back(fad);
+}
+
 FilteredAudioData* AudioManager::GetFilteredAudioData(AUDIOSAMPLETYPE type, int lowNote, int highNote)
 {
     while (_filtered.size() == 0) {
@@ -3052,6 +3050,86 @@ FilteredAudioData* AudioManager::GetFilteredAudioData(AUDIOSAMPLETYPE type, int
     return nullptr;
 }
 
+void AudioSummary::Build(const float* data, long size)
+{
+    _levels.clear();
+    if (data == nullptr || size <= 0) {
+        return;
+    }
+
+    Level base;
+    long blocks = ((size - 1) >> BASE_SHIFT) + 1;
+    base.min.resize(blocks);
+    base.max.resize(blocks);
+    parallel_for(0, blocks, [&base, data, size](int b) {
+        long s = (long)b << BASE_SHIFT;
+        long e = std::min(s + (1L << BASE_SHIFT), size);
+        float mn = data[s];
+        float mx = data[s];
+        for (long i = s; i < e; i++) {
+            mn = std::min(mn, data[i]);
+            mx = std::max(mx, data[i]);
+        }
+        base.min[b] = mn;
+        base.max[b] = mx;
+    }, 256);
+    _levels.push_back(std::move(base));
+
+    while (_levels.back().min.size() > 1) {
+        const Level& prev = _levels.back();
+        Level next;
+        size_t n = (prev.min.size() + 1) / 2;
+        next.min.resize(n);
+        next.max.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            size_t a = i * 2;
+            size_t b = std::min(a + 1, prev.min.size() - 1);
+            next.min[i] = std::min(prev.min[a], prev.min[b]);
+            next.max[i] = std::max(prev.max[a], prev.max[b]);
+        }
+        _levels.push_back(std::move(next));
+    }
+}
+
+template<typename B, typename S>
+void AudioSummary::Visit(long start, long end, B&& block, S&& sample) const
+{
+    long pos = start;
+    while (pos < end) {
+        int level = -1;
+        if (!_levels.empty() && (pos & ((1L << BASE_SHIFT) - 1)) == 0) {
+            // find the biggest aligned block that fits
+            while (level + 1 < (int)_levels.size()) {
+                long len = 1L << (BASE_SHIFT + level + 1);
+                if ((pos & (len - 1)) != 0 || pos + len > end) {
+                    break;
+                }
+                level++;
+            }
+        }
+        if (level < 0) {
+            sample(pos);
+            pos++;
+        } else {
+            block(level, pos >> (BASE_SHIFT + level));
+            pos += 1L << (BASE_SHIFT + level);
+        }
+    }
+}
+
+void AudioSummary::GetMinMax(const float* data, long start, long end, float& minimum, float& maximum) const
+{
+    Visit(start, end,
+        [this, &minimum, &maximum](int level, long index) {
+            minimum = std::min(minimum, _levels[level].min[index]);
+            maximum = std::max(maximum, _levels[level].max[index]);
+        },
+        [data, &minimum, &maximum](long index) {
+            minimum = std::min(minimum, data[index]);
+            maximum = std::max(maximum, data[index]);
+        });
+}
+
 void AudioManager::GetLeftDataMinMax(long start, long end, float& minimum, float& maximum, AUDIOSAMPLETYPE type, int lowNote, int highNote)
 {
     static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
@@ -3069,9 +3147,14 @@ void AudioManager::GetLeftDataMinMax(long start, long end, float& minimum, float
         return;
     }
 
-    for (int j = start; j < std::min(end, _trackSize); j++) {
-        minimum = std::min(minimum, fad->data0[j]);
-        maximum = std::max(maximum, fad->data0[j]);
+    end = std::min(end, _trackSize);
+    if (fad->summary0.IsBuilt()) {
+        fad->summary0.GetMinMax(fad->data0, start, end, minimum, maximum);
+    } else {
+        for (long j = start; j < end; j++) {
+            minimum = std::min(minimum, fad->data0[j]);
+            maximum = std::max(maximum, fad->data0[j]);
+        }
     }
 }
 
@@ -3193,8 +3276,18 @@ std::string AudioManager::Hash()
             wxMilliSleep(100);
         }
 
+        // always the unfiltered audio so the hash is the same whatever filter is showing ... the copy of it is only
+        // made when a filter is first applied (GetFilteredAudioData would wait forever for it) so until then it is _data
+        float* data = _data[0];
+        if (!_filtered.empty()) {
+            FilteredAudioData* fad = GetFilteredAudioData(AUDIOSAMPLETYPE::RAW, -1, -1);
+            if (fad != nullptr) {
+                data = fad->data0;
+            }
+        }
+
         MD5 md5;
-        md5.update((unsigned char *)_data[0], sizeof(float)*_trackSize);
+        md5.update((unsigned char *)data, sizeof(float)*_trackSize);
         md5.finalize();
         _hash = md5.hexdigest();
     }
@@ -3257,6 +3350,7 @@ void xLightsVamp::LoadPlugins(AudioManager* paudio)
 			continue;
 		}
 		_loadedPlugins.push_back(p);
+		_pluginKeys[p] = pluginList[x];
 	}
 }
 
@@ -3366,6 +3460,12 @@ Vamp::Plugin* xLightsVamp::GetPlugin(std::string name)
 	return p;
 }
 
+std::string xLightsVamp::GetPluginKey(Vamp::Plugin* plugin) const
+{
+    auto it = _pluginKeys.find(plugin);
+    return it == _pluginKeys.end() ? plugin->getIdentifier() : it->second;
+}
+
 void SDL::SetAudioDevice(const std::string& device)
 {
 #ifndef __WXMSW__
@@ -58,6 +58,7 @@ class xLightsVamp
 	std::vector<Vamp::Plugin *> _loadedPlugins;
 	std::map<std::string, Vamp::Plugin *> _allplugins;
 	std::vector<Vamp::Plugin *> _allloadedPlugins;
+	std::map<Vamp::Plugin *, std::string> _pluginKeys;
 	void LoadPlugins(AudioManager* paudio);
 
 public:
@@ -75,6 +76,8 @@ public:
 	std::list<std::string> GetAvailablePlugins(AudioManager* paudio);
 	std::list<std::string> GetAllAvailablePlugins(AudioManager* paudio);
 	Vamp::Plugin* GetPlugin(std::string name);
+	// the loader's library:identifier key ... unique where the identifier alone is only unique within its library
+	std::string GetPluginKey(Vamp::Plugin* plugin) const;
 };
 
 typedef enum FRAMEDATATYPE {
@@ -189,6 +192,30 @@ public:
     bool IsNoAudio() { return _audioDeviceFailed; }
 };
 
+// Min and max of a channel for blocks of samples at successively halved resolutions so
+// range queries at any zoom level only have to look at a handful of blocks
+class AudioSummary
+{
+public:
+    void Build(const float* data, long size);
+    bool IsBuilt() const { return !_levels.empty(); }
+    // minimum and maximum are only ever widened
+    void GetMinMax(const float* data, long start, long end, float& minimum, float& maximum) const;
+
+private:
+    static const int BASE_SHIFT = 6; // the finest level summarises blocks of 64 samples
+    struct Level
+    {
+        std::vector<float> min;
+        std::vector<float> max;
+    };
+    std::vector<Level> _levels;
+
+    // calls block(level, index) for the largest blocks covering [start, end) and sample(index) for the ragged ends
+    template<typename B, typename S>
+    void Visit(long start, long end, B&& block, S&& sample) const;
+};
+
 typedef struct FilteredAudioData
 {
     AUDIOSAMPLETYPE type;
@@ -197,6 +224,8 @@ typedef struct FilteredAudioData
     float* data0 = nullptr;
     float* data1 = nullptr;
     int16_t* pcmdata = nullptr;
+    size_t bytes = 0; // memory accounted for the buffers above
+    AudioSummary summary0; // summary of data0
 } FilteredAudioData;
 
 class AudioManager
@@ -231,9 +260,11 @@ class AudioManager
 	MEDIAPLAYINGSTATE _media_state;
 	bool _polyphonicTranscriptionDone = false;
     std::vector<FilteredAudioData*> _filtered;
+    size_t _accountedBytes = 0;
     int _sdlid = 0;
     bool _ok = false;
     std::string _hash;
+    bool _filteredData = false;
     std::future<void> _prepFrameData;
     std::future<void> _loadingAudio;
 
@@ -258,6 +289,7 @@ class AudioManager
     void SetLoadedData(long pos);
 
     void NormaliseFilteredAudioData(FilteredAudioData* fad);
+    void AddFilteredAudioData(FilteredAudioData* fad);
 
     static bool WriteAudioFrame( AVFormatContext *oc, AVCodecContext* codecContext, AVStream *st, float *sampleBuff, int sampleCount, bool clearQueue = false );
 
@@ -305,6 +337,8 @@ public:
     float GetRawRightData(long offset);
     float GetRawLeftData(long offset);
     void SwitchTo(AUDIOSAMPLETYPE type, int lowNote = 0, int highNote = 127);
+    // the filtered data is not the original audio
+    bool IsFiltered() const { return _filteredData; }
     void GetLeftDataMinMax(long start, long end, float& minimum, float& maximum, AUDIOSAMPLETYPE type = AUDIOSAMPLETYPE::ANY, int lowNote = -1, int highNote = -1);
 	float* GetFilteredRightDataPtr(long offset);
 	float* GetFilteredLeftDataPtr(long offset);
@@ -271,6 +271,73 @@ void xlColor::toHSV(HSVValue &v) const {
 }
 
 
+void xlColorsToHSV(const xlColor* rgb, float* hsv, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        float r = rgb[i].red / 255.0f;
+        float g = rgb[i].green / 255.0f;
+        float b = rgb[i].blue / 255.0f;
+        float mx = std::max(r, std::max(g, b));
+        float mn = std::min(r, std::min(g, b));
+        float chroma = mx - mn;
+        float scale = 1.0f / (6.0f * chroma + 1e-20f);
+        float h = (mx == r) ? (g - b) * scale : ((mx == g) ? (b - r) * scale + (1.0f / 3.0f) : (r - g) * scale + (2.0f / 3.0f));
+        hsv[i * 3] = h < 0.0f ? h + 1.0f : h;
+        hsv[i * 3 + 1] = chroma / (mx + 1e-20f);
+        hsv[i * 3 + 2] = mx;
+    }
+}
+
+void xlColorsFromHSV(const float* hsv, xlColor* rgb, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        float h = hsv[i * 3] * 6.0f;
+        float s = hsv[i * 3 + 1];
+        float v = hsv[i * 3 + 2];
+        int sector = (int)std::floor(h);
+        if (sector >= 6) {
+            // single precision rounding can land exactly on a hue of 1
+            h -= 6.0f;
+            sector = 0;
+        }
+        float f = h - sector;
+        float p = v * (1.0f - s);
+        float q = v * (1.0f - s * f);
+        float t = v * (1.0f - s * (1.0f - f));
+        float r, g, b;
+        switch (sector) {
+        case 0: r = v; g = t; b = p; break;
+        case 1: r = q; g = v; b = p; break;
+        case 2: r = p; g = v; b = t; break;
+        case 3: r = p; g = q; b = v; break;
+        case 4: r = t; g = p; b = v; break;
+        default: r = v; g = p; b = q; break;
+        }
+        rgb[i].red = (uint8_t)(r * 255.0f);
+        rgb[i].green = (uint8_t)(g * 255.0f);
+        rgb[i].blue = (uint8_t)(b * 255.0f);
+    }
+}
+
+void xlColorsAdjustHSV(xlColor* pixels, size_t count, float hueAdjust, float saturationAdjust, float valueAdjust) {
+    static const size_t BLOCK = 64;
+    float hsv[BLOCK * 3];
+    for (size_t start = 0; start < count; start += BLOCK) {
+        size_t n = std::min(BLOCK, count - start);
+        xlColorsToHSV(&pixels[start], hsv, n);
+        for (size_t i = 0; i < n; i++) {
+            float& h = hsv[i * 3];
+            h += hueAdjust;
+            if (h < 0.0f) {
+                h += 1.0f;
+            } else if (h >= 1.0f) {
+                h -= 1.0f;
+            }
+            hsv[i * 3 + 1] = std::min(std::max(hsv[i * 3 + 1] + saturationAdjust, 0.0f), 1.0f);
+            hsv[i * 3 + 2] = std::min(std::max(hsv[i * 3 + 2] + valueAdjust, 0.0f), 1.0f);
+        }
+        xlColorsFromHSV(hsv, &pixels[start], n);
+    }
+}
+
 HSVValue::HSVValue(const xlColor &c) {
     toHSV(c, *this);
 }
@@ -287,6 +287,13 @@ typedef std::vector<xlColor> xlColorVector;
 typedef std::vector<ColorCurve> xlColorCurveVector;
 typedef std::vector<HSVValue> hsvVector;
 
+// Batch conversions for rows of pixels. hsv holds hue, saturation, value triplets. They work in single
+// precision so results can be one step away from asHSV/fromHSV in any channel. Alpha is left alone.
+void xlColorsToHSV(const xlColor* rgb, float* hsv, size_t count);
+void xlColorsFromHSV(const float* hsv, xlColor* rgb, size_t count);
+// Shifts the hue (wrapping) and the saturation and value (clamped) of a row of pixels in place
+void xlColorsAdjustHSV(xlColor* pixels, size_t count, float hueAdjust, float saturationAdjust, float valueAdjust);
+
 enum ColorDisplayMode
 {
     MODE_HUE,
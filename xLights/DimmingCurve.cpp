@@ -88,6 +88,10 @@ public:
                 break;
         }
     }
+    virtual bool IsPerChannel() const override {
+        // 4 only touches greys so depends on all three
+        return channel != 4;
+    }
     virtual void reverse(xlColor &c) {
         switch (channel) {
             case -1:
@@ -227,6 +231,9 @@ public:
             blue->apply(c);
         }
     }
+    virtual bool IsPerChannel() const override {
+        return (red == nullptr || red->IsPerChannel()) && (green == nullptr || green->IsPerChannel()) && (blue == nullptr || blue->IsPerChannel());
+    }
     virtual void reverse(xlColor &c) {
         if (red != nullptr) {
             red->reverse(c);
@@ -251,6 +258,20 @@ DimmingCurve::~DimmingCurve()
 {
 }
 
+void DimmingCurve::BuildTables()
+{
+    _hasTables = IsPerChannel();
+    if (_hasTables) {
+        for (int x = 0; x < 256; x++) {
+            xlColor c(x, x, x);
+            apply(c);
+            _tables[0][x] = c.red;
+            _tables[1][x] = c.green;
+            _tables[2][x] = c.blue;
+        }
+    }
+}
+
 static const std::string &validate(const std::string &in, const std::string &def) {
     if (in == "") {
         return def;
@@ -300,7 +321,11 @@ DimmingCurve *DimmingCurve::createFromXML(wxXmlNode *node) {
             if (blue) {
                 delete blue;
             }
-            return createCurve(dc);
+            DimmingCurve *all = createCurve(dc);
+            if (all != nullptr) {
+                all->BuildTables();
+            }
+            return all;
         } else if ("red" == dc->GetName()) {
             red = createCurve(dc, 0);
         } else if ("green" == dc->GetName()) {
@@ -311,18 +336,25 @@ DimmingCurve *DimmingCurve::createFromXML(wxXmlNode *node) {
         dc = dc->GetNext();
     }
     if (red != nullptr || blue != nullptr || green != nullptr) {
-        return new CompositeDimmingCurve(red, green, blue);
+        DimmingCurve *c = new CompositeDimmingCurve(red, green, blue);
+        c->BuildTables();
+        return c;
     }
     return nullptr;
 }
 
 DimmingCurve *DimmingCurve::createBrightnessGamma(int brightness, float gamma) {
     BasicDimmingCurve *c = new BasicDimmingCurve(brightness, gamma, -1);
+    c->BuildTables();
     return c;
 }
 DimmingCurve *DimmingCurve::createFromFile(const wxString &fileName) {
+    DimmingCurve *c = nullptr;
     if (FileExists(fileName)) {
-        return new FileDimmingCurve(fileName, -1);
+        c = new FileDimmingCurve(fileName, -1);
+    } else {
+        c = new BasicDimmingCurve(100, 1.0, -1);
     }
-    return new BasicDimmingCurve(100, 1.0, -1);
+    c->BuildTables();
+    return c;
 }
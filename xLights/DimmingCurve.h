@@ -10,6 +10,8 @@
  * License: https://github.com/smeighan/xLights/blob/master/License.txt
  **************************************************************/
 
+#include <cstdint>
+
 #include "Color.h"
 
 class wxXmlNode;
@@ -27,7 +29,18 @@ class DimmingCurve
         static DimmingCurve *createFromXML(wxXmlNode *node);
         static DimmingCurve *createBrightnessGamma(int brightness, float gamma);
         static DimmingCurve *createFromFile(const wxString &file);
+
+        // red, green and blue lookup tables doing what apply() does or nullptr if the curve cant be applied to each
+        // channel on its own
+        const uint8_t* const* GetTables() const { return _hasTables ? _tablePtrs : nullptr; }
+        // apply() changes each of red, green and blue based only on its own value
+        virtual bool IsPerChannel() const { return true; }
     
     protected:
+        void BuildTables();
+
     private:
+        bool _hasTables = false;
+        uint8_t _tables[3][256];
+        const uint8_t* _tablePtrs[3] = { _tables[0], _tables[1], _tables[2] };
 };
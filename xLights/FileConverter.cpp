@@ -1561,9 +1561,9 @@ void FileConverter::ReadFalconFile(ConvertParameters& params)
         return;
     }
 
-    std::vector<std::pair<uint32_t, uint32_t>> rng;
-    rng.push_back(std::pair<uint32_t, uint32_t>(0, numChannels));
-    file->prepareRead(rng);
+    if (params.read_mode == ConvertParameters::READ_MODE_LOAD_MAIN) {
+        params.seq_data.SetSparseRanges(params.xLightsFrm->AllModels.GetUsedChannelRanges());
+    }
     if (params.read_mode == ConvertParameters::READ_MODE_LOAD_MAIN ||
         params.read_mode == ConvertParameters::READ_MODE_IMPORT) {
         params.seq_data.init(numChannels, falconPeriods, seqStepTime);
@@ -1574,6 +1574,15 @@ void FileConverter::ReadFalconFile(ConvertParameters& params)
         channel_offset = params.data_layer->GetChannelOffset();
     }
 
+    std::vector<std::pair<uint32_t, uint32_t>> rng;
+    if (channel_offset == 0 && params.read_mode == ConvertParameters::READ_MODE_LOAD_MAIN && params.seq_data.IsSparse()) {
+        // only read the channels models use, the rest of the sparse data is never touched
+        rng = params.seq_data.GetUsedRanges();
+    } else {
+        rng.push_back(std::pair<uint32_t, uint32_t>(0, numChannels));
+    }
+    file->prepareRead(rng);
+
     uint8_t *tmpBuf = new uint8_t[numChannels];
     int periodsRead = 0;
     while (periodsRead < falconPeriods) {
@@ -1688,8 +1697,20 @@ void FileConverter::WriteFalconPiFile(ConvertParameters& params)
 
     file->writeHeader();
     size_t size = params.seq_data.NumFrames();
-    for (int x = 0; x < size; x++) {
-        file->addFrame(x, &params.seq_data[x][0]);
+    if (params.seq_data.IsSparse()) {
+        // only the used spans hold anything ... copy those into a frame whose gaps stay zero rather than reading
+        // every channel of every frame
+        std::vector<uint8_t> frame(std::max(stepSize, (size_t)params.seq_data.NumChannels()), 0);
+        for (int x = 0; x < size; x++) {
+            params.seq_data[x].ForEachUsedRange([&frame](uint32_t start, unsigned char* data, uint32_t count) {
+                memcpy(&frame[start], data, count);
+            });
+            file->addFrame(x, &frame[0]);
+        }
+    } else {
+        for (int x = 0; x < size; x++) {
+            file->addFrame(x, &params.seq_data[x][0]);
+        }
     }
     file->finalize();
     delete file;
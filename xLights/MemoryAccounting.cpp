@@ -0,0 +1,150 @@
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <wx/wx.h>
+
+#include "MemoryAccounting.h"
+
+#include <algorithm>
+
+#include <log4cpp/Category.hh>
+
+std::atomic<int64_t> MemoryAccounting::_bytes[MemoryAccounting::CATEGORY_COUNT];
+std::atomic<uint64_t> MemoryAccounting::_budget(0);
+std::atomic_bool MemoryAccounting::_reclaiming(false);
+std::mutex MemoryAccounting::_lock;
+std::list<MemoryAccounting::ReclaimerInfo> MemoryAccounting::_reclaimers;
+int MemoryAccounting::_nextId = 1;
+
+int64_t MemoryAccounting::GetTotalBytes()
+{
+    int64_t total = 0;
+    for (int i = 0; i < CATEGORY_COUNT; i++) {
+        total += _bytes[i];
+    }
+    return total;
+}
+
+const char* MemoryAccounting::GetName(Category category)
+{
+    switch (category) {
+    case SEQUENCE_DATA:
+        return "Sequence Data";
+    case RENDER_CACHE:
+        return "Render Cache";
+    case PIXEL_BUFFERS:
+        return "Pixel Buffers";
+    case AUDIO:
+        return "Audio";
+    case EFFECT_CACHES:
+        return "Effect Caches";
+    default:
+        break;
+    }
+    return "Unknown";
+}
+
+bool MemoryAccounting::WouldExceedBudget(uint64_t extraBytes)
+{
+    uint64_t budget = _budget;
+    if (budget == 0) {
+        return false;
+    }
+    return (uint64_t)std::max((int64_t)0, GetTotalBytes()) + extraBytes > budget;
+}
+
+int MemoryAccounting::RegisterReclaimer(Category category, ReclaimCost cost, Reclaimer reclaimer)
+{
+    std::unique_lock<std::mutex> locker(_lock);
+    int id = _nextId++;
+
+    // keep the list in cost order so reclaiming can just walk it
+    auto it = _reclaimers.begin();
+    while (it != _reclaimers.end() && it->cost <= cost) {
+        ++it;
+    }
+    _reclaimers.insert(it, ReclaimerInfo{ id, category, cost, reclaimer });
+    return id;
+}
+
+void MemoryAccounting::UnregisterReclaimer(int id)
+{
+    std::unique_lock<std::mutex> locker(_lock);
+    _reclaimers.remove_if([id](const ReclaimerInfo& r) { return r.id == id; });
+}
+
+void MemoryAccounting::CheckBudget()
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    uint64_t budget = _budget;
+    if (budget == 0) {
+        return;
+    }
+    int64_t total = GetTotalBytes();
+    if (total <= (int64_t)budget) {
+        return;
+    }
+
+    // only one thread reclaims at a time ... the rest carry on
+    bool expected = false;
+    if (!_reclaiming.compare_exchange_strong(expected, true)) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> locker(_lock);
+        for (const auto& it : _reclaimers) {
+            total = GetTotalBytes();
+            if (total <= (int64_t)budget) {
+                break;
+            }
+            size_t freed = it.reclaimer((size_t)(total - budget));
+            if (freed > 0) {
+                logger_base.debug("Memory budget %lluMB exceeded ... %s released %lluKB.",
+                                  (unsigned long long)(budget / (1024 * 1024)), GetName(it.category), (unsigned long long)(freed / 1024));
+            }
+        }
+    }
+    total = GetTotalBytes();
+    if (total > (int64_t)budget) {
+        static int64_t lastWarned = 0;
+        // dont fill the log if we are stuck over budget
+        if (total > lastWarned + 64 * 1024 * 1024 || total < lastWarned) {
+            lastWarned = total;
+            logger_base.warn("Memory budget %lluMB still exceeded after releasing caches.\n%s",
+                             (unsigned long long)(budget / (1024 * 1024)), (const char*)GetReport().c_str());
+        }
+    }
+    _reclaiming = false;
+}
+
+std::string MemoryAccounting::GetReport()
+{
+    std::string res;
+    for (int i = 0; i < CATEGORY_COUNT; i++) {
+        res += wxString::Format("    %-14s %10.1fMB\n", GetName((Category)i), (double)_bytes[i] / (1024.0 * 1024.0)).ToStdString();
+    }
+    res += wxString::Format("    %-14s %10.1fMB", "Total", (double)GetTotalBytes() / (1024.0 * 1024.0)).ToStdString();
+    if (_budget != 0) {
+        res += wxString::Format(" of %lluMB budget", (unsigned long long)(_budget / (1024 * 1024))).ToStdString();
+    }
+    return res;
+}
+
+std::string MemoryAccounting::GetReportJSON()
+{
+    std::string res = "{";
+    for (int i = 0; i < CATEGORY_COUNT; i++) {
+        res += wxString::Format("\"%s\":%lld,", GetName((Category)i), (long long)_bytes[i]).ToStdString();
+    }
+    res += wxString::Format("\"total\":%lld,\"budget\":%llu}", (long long)GetTotalBytes(), (unsigned long long)_budget).ToStdString();
+    return res;
+}
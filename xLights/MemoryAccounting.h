@@ -0,0 +1,84 @@
+#pragma once
+
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+
+// Central tally of the memory held by the big consumers during rendering.
+//
+// Each subsystem adds and removes the bytes it holds against its category. Caches which can give memory
+// back register a reclaimer with a cost ... when the total goes over the budget the cheapest to rebuild
+// are asked to release memory first. Reclaimers are called from whichever thread noticed the budget was
+// exceeded and so must only try_lock anything they need and skip what they cannot get.
+class MemoryAccounting
+{
+public:
+    enum Category
+    {
+        SEQUENCE_DATA,
+        RENDER_CACHE,
+        PIXEL_BUFFERS,
+        AUDIO,
+        EFFECT_CACHES,
+        CATEGORY_COUNT
+    };
+
+    // lower cost reclaimers are asked first
+    enum ReclaimCost
+    {
+        COST_REDRAW,
+        COST_DISK_RELOAD,
+        COST_RERENDER
+    };
+
+    typedef std::function<size_t(size_t bytesWanted)> Reclaimer;
+
+    static void Add(Category category, int64_t bytes) { _bytes[category] += bytes; }
+    static void Remove(Category category, int64_t bytes) { _bytes[category] -= bytes; }
+    static int64_t GetBytes(Category category) { return _bytes[category]; }
+    static int64_t GetTotalBytes();
+    static const char* GetName(Category category);
+
+    // 0 means no budget
+    static void SetBudget(uint64_t bytes) { _budget = bytes; }
+    static uint64_t GetBudget() { return _budget; }
+    static bool WouldExceedBudget(uint64_t extraBytes);
+
+    static int RegisterReclaimer(Category category, ReclaimCost cost, Reclaimer reclaimer);
+    static void UnregisterReclaimer(int id);
+
+    // Call at points where the caller holds no locks a reclaimer might need. Cheap when under budget.
+    static void CheckBudget();
+
+    static std::string GetReport();
+    static std::string GetReportJSON();
+
+private:
+    struct ReclaimerInfo
+    {
+        int id;
+        Category category;
+        ReclaimCost cost;
+        Reclaimer reclaimer;
+    };
+
+    static std::atomic<int64_t> _bytes[CATEGORY_COUNT];
+    static std::atomic<uint64_t> _budget;
+    static std::atomic_bool _reclaiming;
+    static std::mutex _lock;
+    static std::list<ReclaimerInfo> _reclaimers;
+    static int _nextId;
+};
@@ -0,0 +1,238 @@
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <wx/wx.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+#include "NoteTimeline.h"
+#include "sequencer/EffectLayer.h"
+#include "sequencer/Effect.h"
+#include "UtilFunctions.h"
+
+#include <log4cpp/Category.hh>
+
+std::shared_ptr<const NoteTimeline> NoteTimeline::Get(EffectLayer* timing, const std::string& track)
+{
+    static log4cpp::Category& logger_pianodata = log4cpp::Category::getInstance(std::string("log_pianodata"));
+
+    struct Entry
+    {
+        uint64_t fingerprint = 0;
+        std::weak_ptr<const NoteTimeline> timeline;
+    };
+    static std::mutex lock;
+    static std::map<std::string, Entry> timelines;
+
+    if (timing == nullptr) {
+        return nullptr;
+    }
+
+    uint64_t fingerprint = GetFingerprint(timing);
+
+    std::unique_lock<std::mutex> locker(lock);
+    Entry& entry = timelines[track];
+    std::shared_ptr<const NoteTimeline> res = entry.timeline.lock();
+    if (res == nullptr || entry.fingerprint != fingerprint) {
+        logger_pianodata.debug("Loading notes from timing track " + track);
+        res = std::shared_ptr<const NoteTimeline>(new NoteTimeline(timing));
+        entry.fingerprint = fingerprint;
+        entry.timeline = res;
+    }
+
+    // forget tracks nobody is using anymore
+    for (auto it = timelines.begin(); it != timelines.end();) {
+        if (it->second.timeline.expired() && it->first != track) {
+            it = timelines.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return res;
+}
+
+uint64_t NoteTimeline::GetFingerprint(EffectLayer* timing)
+{
+    uint64_t h = FNV1A_SEED;
+    for (int j = 0; j < timing->GetEffectCount(); ++j) {
+        Effect* e = timing->GetEffect(j);
+        for (uint32_t v : { (uint32_t)e->GetStartTimeMS(), (uint32_t)e->GetEndTimeMS() }) {
+            h = FNV1a(h, v);
+        }
+        h = FNV1a(h, e->GetEffectName());
+        h = FNV1a(h, 0xFF);
+    }
+    return h;
+}
+
+NoteTimeline::NoteTimeline(EffectLayer* timing)
+{
+    for (int j = 0; j < timing->GetEffectCount(); ++j) {
+        Effect* e = timing->GetEffect(j);
+        if (e->GetEndTimeMS() <= e->GetStartTimeMS()) {
+            continue;
+        }
+        Interval interval;
+        interval.startMS = e->GetStartTimeMS();
+        interval.endMS = e->GetEndTimeMS();
+        for (const auto& s : ExtractNotes(e->GetEffectName())) {
+            int n = ConvertNote(s);
+            if (std::find(interval.notes.begin(), interval.notes.end(), n) == interval.notes.end()) {
+                interval.notes.push_back(n);
+            }
+        }
+        if (!interval.notes.empty()) {
+            _intervals.push_back(interval);
+        }
+    }
+
+    std::stable_sort(_intervals.begin(), _intervals.end(), [](const Interval& a, const Interval& b) { return a.startMS < b.startMS; });
+    _maxEndMS.reserve(_intervals.size());
+    int maxEnd = 0;
+    for (const auto& it : _intervals) {
+        maxEnd = std::max(maxEnd, it.endMS);
+        _maxEndMS.push_back(maxEnd);
+    }
+}
+
+std::vector<int> NoteTimeline::GetNotesAt(int ms) const
+{
+    std::vector<int> res;
+
+    // last interval starting at or before ms then back while an earlier one could still be sounding
+    auto it = std::upper_bound(_intervals.begin(), _intervals.end(), ms, [](int t, const Interval& i) { return t < i.startMS; });
+    for (int i = (int)(it - _intervals.begin()) - 1; i >= 0 && _maxEndMS[i] > ms; --i) {
+        if (_intervals[i].endMS > ms) {
+            if (res.empty()) {
+                res = _intervals[i].notes;
+            } else {
+                for (int n : _intervals[i].notes) {
+                    if (std::find(res.begin(), res.end(), n) == res.end()) {
+                        res.push_back(n);
+                    }
+                }
+            }
+        }
+    }
+    return res;
+}
+
+std::list<std::string> NoteTimeline::ExtractNotes(const std::string& label)
+{
+    std::string n = label;
+    std::transform(n.begin(), n.end(), n.begin(), ::toupper);
+
+    std::list<std::string> res;
+
+    std::string s = "";
+    for (const auto& it : n)
+    {
+        if (it == ':' || it == ' ' || it == ';' || it == ',')
+        {
+            if (s != "")
+            {
+                res.push_back(s);
+                s = "";
+            }
+        }
+        else
+        {
+            if ((it >= 'A' && it <= 'G') ||
+                (it == '#') ||
+                (it >= '0' && it <= '9'))
+            {
+                s += it;
+            }
+        }
+    }
+
+    if (s != "")
+    {
+        res.push_back(s);
+    }
+
+    return res;
+}
+
+int NoteTimeline::ConvertNote(const std::string& note)
+{
+    std::string n = note;
+    int nletter;
+    std::transform(n.begin(), n.end(), n.begin(), ::toupper);
+
+    switch (n[0])
+    {
+    case 'A':
+        nletter = 9;
+        break;
+    case 'B':
+        nletter = 11;
+        break;
+    case 'C':
+        nletter = 0;
+        break;
+    case 'D':
+        nletter = 2;
+        break;
+    case 'E':
+        nletter = 4;
+        break;
+    case 'F':
+        nletter = 5;
+        break;
+    case 'G':
+        nletter = 7;
+        break;
+    default:
+        {
+            int number = wxAtoi(n);
+            if (number < 0) number = 0;
+            if (number > 127) number = 127;
+            return number;
+        }
+    }
+
+    n = n.substr(1);
+    int sharp = 0;
+    if (n.find('#') != std::string::npos)
+    {
+        sharp = 1;
+    }
+    else if (n.find('B') != std::string::npos)
+    {
+        sharp = -1;
+    }
+
+    int octave = 4;
+
+    if (n != "")
+    {
+        if (n[0] == '#')
+        {
+            n = n.substr(1);
+        }
+        else if (n[0] == 'B')
+        {
+            n = n.substr(1);
+        }
+    }
+
+    if (n != "")
+    {
+        octave = wxAtoi(n);
+    }
+
+    int number = 12 + (octave * 12) + nletter + sharp;
+    if (number < 0) number = 0;
+    if (number > 127) number = 127;
+    return number;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+class EffectLayer;
+
+// The notes in a notes timing track (as created by importing MIDI, MusicXML or audio notes) indexed by time.
+//
+// Every effect rendering from the same track shares one timeline. It is built the first time it is asked for and
+// again only when the timing marks change. It is freed once no effect holds it.
+class NoteTimeline
+{
+public:
+    // nullptr if there is no such timing track
+    static std::shared_ptr<const NoteTimeline> Get(EffectLayer* timing, const std::string& track);
+
+    // midi note numbers sounding at ms ... the union if timing marks overlap
+    std::vector<int> GetNotesAt(int ms) const;
+    bool IsEmpty() const { return _intervals.empty(); }
+
+    // "C#4, E4" ... note names or midi numbers
+    static std::list<std::string> ExtractNotes(const std::string& label);
+    static int ConvertNote(const std::string& note);
+
+private:
+    struct Interval
+    {
+        int startMS;
+        int endMS;
+        std::vector<int> notes;
+    };
+
+    NoteTimeline(EffectLayer* timing);
+    static uint64_t GetFingerprint(EffectLayer* timing);
+
+    // sorted by start with the latest end of any interval up to and including each one
+    std::vector<Interval> _intervals;
+    std::vector<int> _maxEndMS;
+};
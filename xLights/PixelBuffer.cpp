@@ -19,7 +19,10 @@
 #include "xLightsMain.h"
 #include <log4cpp/Category.hh>
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstring>
 #include <random>
 #include "Parallel.h"
 #include "UtilFunctions.h"
@@ -1391,19 +1394,23 @@ void PixelBufferClass::GetMixedColor(int node, const std::vector<bool> & validLa
                 int x = coord.bufX;
                 int y = coord.bufY;
 
+                bool adjusted = !thelayer->adjustedPixels.empty();
                 if (thelayer->isMasked(x, y)
                     || x < 0
                     || y < 0
                     || x >= thelayer->BufferWi
                     || y >= thelayer->BufferHt
                     ) {
-                    color.Set(0, 0, 0, 0);
+                    color = adjusted ? thelayer->adjustedClear : xlCLEAR;
+                } else if (adjusted) {
+                    const RenderBuffer& b = thelayer->buffer;
+                    color = (x < b.BufferWi && y < b.BufferHt) ? thelayer->adjustedPixels[y * b.BufferWi + x] : thelayer->adjustedBlack;
                 } else {
                     thelayer->buffer.GetPixel(x, y, color);
                 }
 
                 // adjust for HSV adjustments
-                if (thelayer->needsHSVAdjust) {
+                if (thelayer->needsHSVAdjust && !adjusted) {
                     HSVValue hsv = color.asHSV();
 
                     if (thelayer->outputHueAdjust != 0) {
@@ -1764,179 +1771,107 @@ static void boxesForGauss(int d, int n, std::vector<float> &boxes)  // standard
     }
 }
 
-#define RED(a, b) a[(b)*4]
-#define GREEN(a, b) a[(b)*4 + 1]
-#define BLUE(a, b) a[(b)*4 + 2]
-#define ALPHA(a, b) a[(b)*4 + 3]
-static inline void SET(std::vector<float>& ar, int idx, float r, float g, float b, float a) {
-    idx *= 4;
-    ar[idx++] = r;
-    ar[idx++] = g;
-    ar[idx++] = b;
-    ar[idx] = a;
-}
-
-static void boxBlurH_4 (const std::vector<float>& scl, std::vector<float>& tcl, int w, int h, float r) {
-    float iarr = 1.0f / (r+r+1.0f);
-    for(int i=0; i<h; i++) {
-        int ti = i*w;
-        int li = ti;
-        int ri = ti+r;
-        int maxri = ti + w - 1;
-        int fvIdx = ti;
-        int lvIdx = ti+w-1;
-
-        float valr = (r+1.0) * RED(scl,fvIdx);
-        float valg = (r+1.0) * GREEN(scl,fvIdx);
-        float valb = (r+1.0) * BLUE(scl,fvIdx);
-        float vala = (r+1.0) * ALPHA(scl,fvIdx);
-
-        float fvRed = RED(scl, fvIdx);
-        float fvGreen = GREEN(scl, fvIdx);
-        float fvBlue = BLUE(scl, fvIdx);
-        float fvAlpha = ALPHA(scl, fvIdx);
-        float lvRed = RED(scl, lvIdx);
-        float lvGreen = GREEN(scl, lvIdx);
-        float lvBlue = BLUE(scl, lvIdx);
-        float lvAlpha = ALPHA(scl, lvIdx);
-
-        for (int j=0; j<r; j++) {
-            int idx = j < w ? ti+j : lvIdx;
-            valr += RED(scl, idx);
-            valg += GREEN(scl, idx);
-            valb += BLUE(scl, idx);
-            vala += ALPHA(scl, idx);
-        }
-        for (int j=0  ; j<=r ; j++) {
-            int idx = ri <= maxri ? ri++ : lvIdx;
-            valr += RED(scl, idx) - fvRed;
-            valg += GREEN(scl, idx) - fvGreen;
-            valb += BLUE(scl, idx) - fvBlue;
-            vala += ALPHA(scl, idx) - fvAlpha;
-
-            if (ti <= maxri) {
-                SET(tcl, ti, valr*iarr, valg*iarr, valb*iarr, vala*iarr);
-                ti++;
+// rows per job ... small buffers are not worth farming out
+static inline int RowsPerJob(int w)
+{
+    return std::max(1, 2048 / std::max(w, 1));
+}
+
+// Sliding window sums of the RGBA values in src over the window [x - lo, x + hi] along each row. When clamp the edge
+// pixels repeat beyond the edge otherwise pixels beyond the edge contribute nothing.
+template<bool clamp>
+static void BoxSumH(const int32_t* src, int32_t* dst, int w, int h, int lo, int hi)
+{
+    parallel_for(0, h, [src, dst, w, lo, hi](int y) {
+        const int32_t* s = src + (size_t)y * w * 4;
+        int32_t* d = dst + (size_t)y * w * 4;
+        int32_t sum[4] = { 0, 0, 0, 0 };
+        for (int i = -lo; i <= hi; ++i) {
+            int x = clamp ? std::clamp(i, 0, w - 1) : i;
+            if (x >= 0 && x < w) {
+                for (int c = 0; c < 4; ++c) {
+                    sum[c] += s[x * 4 + c];
+                }
             }
         }
-        for (int j=r+1; j<w-r; j++) {
-            int c = ri <= maxri ? ri++ : lvIdx;
-            int c2 = li <= maxri ? li++ : lvIdx;
-            valr += RED(scl, c) - RED(scl, c2);
-            valg += GREEN(scl, c) - GREEN(scl, c2);
-            valb += BLUE(scl, c) - BLUE(scl, c2);
-            vala += ALPHA(scl, c) - ALPHA(scl, c2);
-            if (ti <= maxri) {
-                SET(tcl, ti, valr*iarr, valg*iarr, valb*iarr, vala*iarr);
-                ti++;
+        for (int x = 0; x < w; ++x) {
+            for (int c = 0; c < 4; ++c) {
+                d[x * 4 + c] = sum[c];
             }
-        }
-
-        for (int j=w-r; j<w  ; j++) {
-            int c2 = li <= maxri ? li++: lvIdx;
-            valr += lvRed - RED(scl, c2);
-            valg += lvGreen - GREEN(scl, c2);
-            valb += lvBlue - BLUE(scl, c2);
-            vala += lvAlpha - ALPHA(scl, c2);
-            if (ti <= maxri) {
-                SET(tcl, ti, valr*iarr, valg*iarr, valb*iarr, vala*iarr);
-                ti++;
+            int in = x + hi + 1;
+            int out = x - lo;
+            if (clamp) {
+                in = std::min(in, w - 1);
+                out = std::max(out, 0);
+            }
+            if (in < w) {
+                for (int c = 0; c < 4; ++c) {
+                    sum[c] += s[in * 4 + c];
+                }
+            }
+            if (out >= 0) {
+                for (int c = 0; c < 4; ++c) {
+                    sum[c] -= s[out * 4 + c];
+                }
             }
         }
-    }
+    }, RowsPerJob(w));
 }
 
-static void boxBlurT_4 (const std::vector<float>& scl, std::vector<float>& tcl, int w, int h, float r) {
-    float iarr = 1.0f / (r+r+1.0f);
-    for(int i=0; i<w; i++) {
-        int ti = i;
-        int li = ti;
-        int ri = ti+r*w;
-
-        int maxri = ti+w*(h-1);
-
-        int fvIdx = ti;
-        int lvIdx = ti+w*(h-1);
-
-        float fvRed = RED(scl, fvIdx);
-        float fvGreen = GREEN(scl, fvIdx);
-        float fvBlue = BLUE(scl, fvIdx);
-        float fvAlpha = ALPHA(scl, fvIdx);
-        float lvRed = RED(scl, lvIdx);
-        float lvGreen = GREEN(scl, lvIdx);
-        float lvBlue = BLUE(scl, lvIdx);
-        float lvAlpha = ALPHA(scl, lvIdx);
-
-        float valr = (r+1)*fvRed;
-        float valg = (r+1)*fvGreen;
-        float valb = (r+1)*fvBlue;
-        float vala = (r+1)*fvAlpha;
-
-        for(int j=0; j<r; j++) {
-            int idx = j < w ? ti+j*w : lvIdx;
-            valr += RED(scl, idx);
-            valg += GREEN(scl, idx);
-            valb += BLUE(scl, idx);
-            vala += ALPHA(scl, idx);
-        }
-        for(int j=0  ; j<=r ; j++) {
-            int idx = ri <= maxri ? ri : lvIdx;
-            valr += RED(scl, idx) - fvRed;
-            valg += GREEN(scl, idx) - fvGreen;
-            valb += BLUE(scl, idx) - fvBlue;
-            vala += ALPHA(scl, idx) - fvAlpha;
-            if (ti <= maxri) {
-                SET(tcl, ti, valr*iarr, valg*iarr, valb*iarr, vala*iarr);
+// As BoxSumH but down each column. Columns are done a strip at a time so each step reads a run of a row.
+template<bool clamp>
+static void BoxSumV(const int32_t* src, int32_t* dst, int w, int h, int lo, int hi)
+{
+    static const int STRIP = 32;
+    int strips = (w + STRIP - 1) / STRIP;
+    parallel_for(0, strips, [src, dst, w, h, lo, hi](int strip) {
+        int x0 = strip * STRIP;
+        int n = std::min(STRIP, w - x0) * 4;
+        int32_t sum[STRIP * 4];
+        memset(sum, 0, sizeof(sum));
+        auto add = [src, w, x0, n, &sum](int y, int sign) {
+            const int32_t* s = src + ((size_t)y * w + x0) * 4;
+            for (int i = 0; i < n; ++i) {
+                sum[i] += sign * s[i];
             }
-            ri+=w;
-            ti+=w;
-        }
-        for(int j=r+1; j<h-r; j++) {
-            int c = ri <= maxri ? ri : lvIdx;
-            int c2 = li <= maxri ? li : lvIdx;
-            valr += RED(scl, c) - RED(scl, c2);
-            valg += GREEN(scl, c) - GREEN(scl, c2);
-            valb += BLUE(scl, c) - BLUE(scl, c2);
-            vala += ALPHA(scl, c) - ALPHA(scl, c2);
-            if (ti <= maxri) {
-                SET(tcl, ti, valr*iarr, valg*iarr, valb*iarr, vala*iarr);
+        };
+        for (int i = -lo; i <= hi; ++i) {
+            int y = clamp ? std::clamp(i, 0, h - 1) : i;
+            if (y >= 0 && y < h) {
+                add(y, 1);
             }
-            li+=w; ri+=w; ti+=w;
-        }
-        for(int j=h-r; j<h  ; j++) {
-            int c2 = li <= maxri ? li : lvIdx;
-            valr += lvRed - RED(scl, c2);
-            valg += lvGreen - GREEN(scl, c2);
-            valb += lvBlue - BLUE(scl, c2);
-            vala += lvAlpha - ALPHA(scl, c2);
-            if (ti <= maxri) {
-                SET(tcl, ti, valr*iarr, valg*iarr, valb*iarr, vala*iarr);
+        }
+        for (int y = 0; y < h; ++y) {
+            memcpy(dst + ((size_t)y * w + x0) * 4, sum, n * sizeof(int32_t));
+            int in = y + hi + 1;
+            int out = y - lo;
+            if (clamp) {
+                in = std::min(in, h - 1);
+                out = std::max(out, 0);
+            }
+            if (in < h) {
+                add(in, 1);
+            }
+            if (out >= 0) {
+                add(out, -1);
             }
-            li += w;
-            ti += w;
         }
-    }
+    }, std::max(1, 64 / std::max(h, 1)));
 }
 
-static void boxBlur_4(std::vector<float>& scl, std::vector<float>& tcl, int w, int h, float r, int size) {
-    tcl = scl;
-    //memcpy(tcl, scl, sizeof(float)*4*size);
-    boxBlurH_4(tcl, scl, w, h, r);
-    boxBlurT_4(scl, tcl, w, h, r);
-}
-
-static void gaussBlur_4(std::vector<float>& scl, std::vector<float>& tcl, int w, int h, int r, int size) {
-    std::vector<float> bxs;
-    boxesForGauss(r - 1, 3, bxs);
-    boxBlur_4 (scl, tcl, w, h, (bxs[0]-1)/2, size);
-    boxBlur_4 (tcl, scl, w, h, (bxs[1]-1)/2, size);
-    boxBlur_4 (scl, tcl, w, h, (bxs[2]-1)/2, size);
-}
-
-static inline int roundInt(float r) {
-    int tmp = static_cast<int> (r);
-    tmp += (r-tmp>=.5) - (r-tmp<=-.5);
-    return tmp;
+// the layer's pixels as w * h RGBA ints ... anything missing off the end of the buffer reads as pad
+static void LoadBlurValues(const xlColor* pixels, size_t pixCount, int w, int h, std::vector<int32_t>& values, const xlColor& pad)
+{
+    size_t n = (size_t)w * h;
+    size_t count = std::min(n, pixCount);
+    values.resize(n * 4);
+    for (size_t i = 0; i < n; ++i) {
+        const xlColor& c = i < count ? pixels[i] : pad;
+        values[i * 4] = c.red;
+        values[i * 4 + 1] = c.green;
+        values[i * 4 + 2] = c.blue;
+        values[i * 4 + 3] = c.alpha;
+    }
 }
 
 void PixelBufferClass::Blur(LayerInfo* layer, float offset)
@@ -1954,32 +1889,45 @@ void PixelBufferClass::Blur(LayerInfo* layer, float offset)
     if (b < 2) {
         return;
     }
+    int w = layer->BufferWi;
+    int h = layer->BufferHt;
+    if (w <= 0 || h <= 0) {
+        return;
+    }
     if (b > 2 && layer->BufferWi > 6 && layer->BufferHt > 6) {
         if (!GPURenderUtils::Blur(&layer->buffer, b)) {
             GPURenderUtils::waitForRenderCompletion(&layer->buffer);
-            int os = std::max((int)layer->buffer.pixelVector.size(), layer->BufferWi * layer->BufferHt);
-            int pixCount = layer->buffer.pixelVector.size();
-            std::vector<float> input;
-            input.resize(os * 4);
-            std::vector<float> tmp;
-            tmp.resize(os * 4);
-            //float * input = new float[pixCount * 4];
-            //float * tmp = new float[pixCount * 4];
-            for (int x = 0; x < pixCount; x++) {
-                const xlColor &c = layer->buffer.pixels[x];
-                input[x * 4] = c.red;
-                input[x * 4 + 1] = c.green;
-                input[x * 4 + 2] = c.blue;
-                input[x * 4 + 3] = c.alpha;
-            }
-            gaussBlur_4(input, tmp, layer->BufferWi, layer->BufferHt, b, pixCount);
 
-            for (int x = 0; x < pixCount; x++) {
-                layer->buffer.pixels[x].Set(roundInt(tmp[x*4]),
-                                            roundInt(tmp[x*4 + 1]),
-                                            roundInt(tmp[x*4 + 2]),
-                                            roundInt(tmp[x*4 + 3]));
+            // three box blurs approximate the gaussian. The sums are kept whole through all six passes and divided
+            // once at the end so nothing is lost to rounding along the way.
+            std::vector<float> bxs;
+            boxesForGauss(b - 1, 3, bxs);
+            LoadBlurValues(layer->buffer.pixels, layer->buffer.pixelVector.size(), w, h, layer->blurValues, xlCLEAR);
+            int32_t* values = layer->blurValues.data();
+            layer->blurTemp.resize(layer->blurValues.size());
+            int32_t* temp = layer->blurTemp.data();
+            int32_t divisor = 1;
+            for (float box : bxs) {
+                int r = ((int)box - 1) / 2;
+                if (r > 0) {
+                    BoxSumH<true>(values, temp, w, h, r, r);
+                    BoxSumV<true>(temp, values, w, h, r, r);
+                    divisor *= (2 * r + 1) * (2 * r + 1);
+                }
             }
+
+            int pixCount = std::min((size_t)w * h, layer->buffer.pixelVector.size());
+            xlColor* pixels = layer->buffer.pixels;
+            parallel_for(0, h, [values, pixels, w, pixCount, divisor](int y) {
+                int end = std::min((y + 1) * w, pixCount);
+                for (int x = y * w; x < end; ++x) {
+                    const int32_t* v = &values[x * 4];
+                    pixels[x].Set((v[0] + divisor / 2) / divisor,
+                                  (v[1] + divisor / 2) / divisor,
+                                  (v[2] + divisor / 2) / divisor,
+                                  (v[3] + divisor / 2) / divisor);
+                }
+            }, RowsPerJob(w));
         }
     } else {
         //small blur
@@ -1994,34 +1942,25 @@ void PixelBufferClass::Blur(LayerInfo* layer, float offset)
             d = (b - 1) / 2;
             u = (b - 1) / 2;
         }
-        RenderBuffer orig(layer->buffer);
-        for (int x = 0; x < layer->BufferWi; x++) {
-            for (int y = 0; y < layer->BufferHt; y++) {
-                int r = 0;
-                int g = 0;
-                int b2 = 0;
-                int a = 0;
-                int sm = 0;
-                for (int i = x - d; i <= x + u; i++) {
-                    if (i >= 0 && i < layer->BufferWi) {
-                        for (int j = y - d; j <= y + u; j++) {
-                            if (j >=0 && j < layer->BufferHt) {
-                                const xlColor &c = orig.GetPixel(i, j);
-                                r += c.red;
-                                g += c.green;
-                                b2 += c.blue;
-                                a += c.alpha;
-                                ++sm;
-                            }
-                        }
-                    }
-                }
-                if (sm == 0) {
-                    sm = 1;
-                }
-                layer->buffer.SetPixel(x, y, xlColor(r/sm, g/sm, b2/sm, a/sm));
+
+        // average of the pixels within the window which are actually on the buffer
+        LoadBlurValues(layer->buffer.pixels, layer->buffer.pixelVector.size(), w, h, layer->blurValues, xlBLACK);
+        int32_t* values = layer->blurValues.data();
+        layer->blurTemp.resize(layer->blurValues.size());
+        int32_t* temp = layer->blurTemp.data();
+        BoxSumH<false>(values, temp, w, h, d, u);
+        BoxSumV<false>(temp, values, w, h, d, u);
+
+        int pixCount = std::min((size_t)w * h, layer->buffer.pixelVector.size());
+        xlColor* pixels = layer->buffer.pixels;
+        parallel_for(0, h, [values, pixels, w, h, d, u, pixCount](int y) {
+            int rows = std::min(y + u, h - 1) - std::max(y - d, 0) + 1;
+            for (int x = 0; x < w && y * w + x < pixCount; ++x) {
+                int sm = rows * (std::min(x + u, w - 1) - std::max(x - d, 0) + 1);
+                const int32_t* v = &values[(y * w + x) * 4];
+                pixels[y * w + x].Set(v[0] / sm, v[1] / sm, v[2] / sm, v[3] / sm);
             }
-        }
+        }, RowsPerJob(w));
     }
 }
 
@@ -2560,16 +2499,16 @@ void PixelBufferClass::MergeBuffersForLayer(int layer) {
 
 void PixelBufferClass::SetLayer(int layer, int period, bool resetState)
 {
-    layers[layer]->buffer.SetState(period, resetState, modelName);
+    layers[layer]->buffer.SetState(period, resetState, modelName, layer);
     if (layers[layer]->modelBuffers == &layers[layer]->deepModelBuffers) {
         const ModelGroup* grp = dynamic_cast<const ModelGroup*>(model);
         std::list<Model*> flat_models = grp->GetFlatModels(false);
         std::list<Model*>::iterator it_m = flat_models.begin();
         for (auto it = layers[layer]->modelBuffers->begin(); it != layers[layer]->modelBuffers->end(); ++it, it_m++) {
             if (frame->AllModels[(*it_m)->Name()] == nullptr) {
-                (*it)->SetState(period, resetState, (*it_m)->GetFullName());
+                (*it)->SetState(period, resetState, (*it_m)->GetFullName(), layer);
             } else {
-                (*it)->SetState(period, resetState, (*it_m)->Name());
+                (*it)->SetState(period, resetState, (*it_m)->Name(), layer);
             }
         }
     } else if (layers[layer]->modelBuffers) {
@@ -2577,9 +2516,9 @@ void PixelBufferClass::SetLayer(int layer, int period, bool resetState)
         const ModelGroup* grp = dynamic_cast<const ModelGroup*>(model);
         for (auto it = layers[layer]->modelBuffers->begin(); it != layers[layer]->modelBuffers->end(); ++it, cnt++) {
             if (frame->AllModels[grp->Models()[cnt]->Name()] == nullptr) {
-                (*it)->SetState(period, resetState, grp->Models()[cnt]->GetFullName());
+                (*it)->SetState(period, resetState, grp->Models()[cnt]->GetFullName(), layer);
             } else {
-                (*it)->SetState(period, resetState, grp->Models()[cnt]->Name());
+                (*it)->SetState(period, resetState, grp->Models()[cnt]->Name(), layer);
             }
         }
     }
@@ -2605,64 +2544,50 @@ static inline bool IsInRange(const std::vector<bool> &restrictRange, size_t star
     return restrictRange[start];
 }
 
-void PixelBufferClass::GetColors(unsigned char *fdata, const std::vector<bool> &restrictRange) {
+// Writes the node's channels with the model's dimming curve applied. Curves which work on each colour on its own are
+// looked up on the way out. Anything else changes the node's colour first ... returns true if it had to do that.
+static inline bool GetCurvedForChannels(NodeBaseClass* n, unsigned char* buf)
+{
+    DimmingCurve* curve = n->model != nullptr ? n->model->modelDimmingCurve : nullptr; // model should never be null
+    if (curve == nullptr) {
+        n->GetForChannels(buf);
+        return false;
+    }
+    const uint8_t* const* tables = curve->GetTables();
+    if (tables != nullptr && n->GetForChannelsCurved(buf, tables)) {
+        return false;
+    }
 
-    // KW ... I think this needs to be optimised
+    if (n->GetChanCount() == 1) {
+        uint8_t b[3] = { 0, 0, 0 };
+        n->GetForChannels(b);
+        xlColor color(b[0], b[0], b[0]);
+        curve->apply(color);
+        n->SetColor(color);
+    } else {
+        xlColor color;
+        n->GetColor(color);
+        curve->apply(color);
+        n->SetColor(color);
+    }
+    n->GetForChannels(buf);
+    return true;
+}
+
+void PixelBufferClass::GetColors(unsigned char *fdata, const std::vector<bool> &restrictRange) {
 
     if (layers[0] != nullptr) { // I dont like this ... it should never be null
-        if (layers[0]->buffer.Nodes.size() < 1000) {
-            //smaller model, no sense in setting up the parallel_for
-            for (auto &n : layers[0]->buffer.Nodes) {
-                size_t start = n->ActChan;
-                if (IsInRange(restrictRange, start)) {
-                    if (n->model != nullptr) { // nor this
-                        DimmingCurve *curve = n->model->modelDimmingCurve;
-                        if (curve != nullptr) {
-                            if (n->GetChanCount() == 1) {
-                                uint8_t buf[3] = {0, 0, 0};
-                                n->GetForChannels(buf);
-                                xlColor color(buf[0], buf[0], buf[0]);
-                                curve->apply(color);
-
-                                n->SetColor(color);
-                            } else {
-                                xlColor color;
-                                n->GetColor(color);
-                                curve->apply(color);
-                                n->SetColor(color);
-                            }
-                        }
-                    }
-                    n->GetForChannels(&fdata[start]);
+        std::atomic_bool curved(false);
+        parallel_for(0, layers[0]->buffer.Nodes.size(), [&](int i) {
+            auto &n = layers[0]->buffer.Nodes[i];
+            size_t start = n->ActChan;
+            if (IsInRange(restrictRange, start)) {
+                if (GetCurvedForChannels(n.get(), &fdata[start])) {
+                    curved = true;
                 }
             }
-        } else {
-            parallel_for(0,  layers[0]->buffer.Nodes.size(), [&](int i) {
-                auto &n = layers[0]->buffer.Nodes[i];
-                size_t start = n->ActChan;
-                if (IsInRange(restrictRange, start)) {
-                    if (n->model != nullptr) { // nor this
-                        DimmingCurve *curve = n->model->modelDimmingCurve;
-                        if (curve != nullptr) {
-                            if (n->GetChanCount() == 1) {
-                                uint8_t buf[3] = {0, 0, 0};
-                                n->GetForChannels(buf);
-                                xlColor color(buf[0], buf[0], buf[0]);
-                                curve->apply(color);
-
-                                n->SetColor(color);
-                            } else {
-                                xlColor color;
-                                n->GetColor(color);
-                                curve->apply(color);
-                                n->SetColor(color);
-                            }
-                        }
-                    }
-                    n->GetForChannels(&fdata[start]);
-                }
-            }, 500);
-        }
+        }, 500);
+        curvedNodes = curved;
     }
 }
 
@@ -2706,6 +2631,20 @@ void PixelBufferClass::SetColors(int layer, const unsigned char *fdata)
 
 }
 
+// a copy of the layer's pixels to read from while they are rewritten ... anything missing off the end of the buffer
+// reads as black as it would through GetPixel
+static const xlColor* CopyLayerPixels(const xlColor* pixels, size_t pixCount, int w, int h, xlColorVector& copy)
+{
+    size_t n = (size_t)w * h;
+    size_t count = std::min(n, pixCount);
+    copy.resize(n);
+    if (count > 0) {
+        memcpy(&copy[0], pixels, count * sizeof(xlColor));
+    }
+    std::fill(copy.begin() + count, copy.end(), xlBLACK);
+    return copy.data();
+}
+
 void PixelBufferClass::RotateX(LayerInfo* layer, float offset)
 {
     // Now do the rotation around a point on the x axis
@@ -2722,25 +2661,37 @@ void PixelBufferClass::RotateX(LayerInfo* layer, float offset)
             xpivot = layer->XPivotValueCurve.GetOutputValueAt(offset, layer->buffer.GetStartTimeMS(), layer->buffer.GetEndTimeMS());
         }
 
-        RenderBuffer orig(layer->buffer);
-        layer->buffer.Clear();
-
+        int w = layer->buffer.BufferWi;
+        int h = layer->buffer.BufferHt;
         float sine = sin((xrotation + 90) * M_PI / 180);
         float pivot = xpivot * layer->buffer.BufferWi / 100;
 
-        for (int x = pivot; x < layer->buffer.BufferWi; ++x) {
-            float tox = sine * (x - pivot) + pivot;
-            for (int y = 0; y < layer->buffer.BufferHt; ++y) {
-                layer->buffer.SetPixel(tox, y, orig.GetPixel(x, y));
+        // every row moves the same way so work out once which column lands in each column ... where two land on the
+        // same column the last one wins
+        std::vector<int>& from = layer->transformMap;
+        from.assign(w, -1);
+        for (int x = pivot; x < w; ++x) {
+            int tox = sine * (x - pivot) + pivot;
+            if (tox >= 0 && tox < w) {
+                from[tox] = x;
             }
         }
-
         for (int x = pivot - 1; x >= 0; --x) {
-            float tox = -1 * sine * (pivot - x) + pivot;
-            for (int y = 0; y < layer->buffer.BufferHt; ++y) {
-                layer->buffer.SetPixel(tox, y, orig.GetPixel(x, y));
+            int tox = -1 * sine * (pivot - x) + pivot;
+            if (tox >= 0 && tox < w) {
+                from[tox] = x;
             }
         }
+
+        const xlColor* orig = CopyLayerPixels(layer->buffer.pixels, layer->buffer.pixelVector.size(), w, h, layer->transformPixels);
+        xlColor* pixels = layer->buffer.pixels;
+        int pixCount = std::min((size_t)w * h, layer->buffer.pixelVector.size());
+        const int* fromX = from.data();
+        parallel_for(0, h, [orig, pixels, fromX, w, pixCount](int y) {
+            for (int x = 0; x < w && y * w + x < pixCount; ++x) {
+                pixels[y * w + x] = fromX[x] < 0 ? xlCLEAR : orig[y * w + fromX[x]];
+            }
+        }, RowsPerJob(w));
     }
 }
 
@@ -2760,25 +2711,36 @@ void PixelBufferClass::RotateY(LayerInfo* layer, float offset)
             ypivot = layer->YPivotValueCurve.GetOutputValueAt(offset, layer->buffer.GetStartTimeMS(), layer->buffer.GetEndTimeMS());
         }
 
-        RenderBuffer orig(layer->buffer);
-        layer->buffer.Clear();
-
+        int w = layer->buffer.BufferWi;
+        int h = layer->buffer.BufferHt;
         float sine = sin((yrotation + 90) * M_PI / 180);
         float pivot = ypivot * layer->buffer.BufferHt / 100;
 
-        for (int y = pivot; y < layer->buffer.BufferHt; ++y) {
-            float toy = sine * (y - pivot) + pivot;
-            for (int x = 0; x < layer->buffer.BufferWi; ++x) {
-                layer->buffer.SetPixel(x, toy, orig.GetPixel(x, y));
+        // which row lands in each row ... where two land on the same row the last one wins
+        std::vector<int>& from = layer->transformMap;
+        from.assign(h, -1);
+        for (int y = pivot; y < h; ++y) {
+            int toy = sine * (y - pivot) + pivot;
+            if (toy >= 0 && toy < h) {
+                from[toy] = y;
             }
         }
-
         for (int y = pivot - 1; y >= 0; --y) {
-            float toy = -1 * sine * (pivot - y) + pivot;
-            for (int x = 0; x < layer->buffer.BufferWi; ++x) {
-                layer->buffer.SetPixel(x, toy, orig.GetPixel(x, y));
+            int toy = -1 * sine * (pivot - y) + pivot;
+            if (toy >= 0 && toy < h) {
+                from[toy] = y;
             }
         }
+
+        const xlColor* orig = CopyLayerPixels(layer->buffer.pixels, layer->buffer.pixelVector.size(), w, h, layer->transformPixels);
+        xlColor* pixels = layer->buffer.pixels;
+        int pixCount = std::min((size_t)w * h, layer->buffer.pixelVector.size());
+        const int* fromY = from.data();
+        parallel_for(0, h, [orig, pixels, fromY, w, pixCount](int y) {
+            for (int x = 0; x < w && y * w + x < pixCount; ++x) {
+                pixels[y * w + x] = fromY[y] < 0 ? xlCLEAR : orig[fromY[y] * w + x];
+            }
+        }, RowsPerJob(w));
     }
 }
 
@@ -2813,8 +2775,6 @@ void PixelBufferClass::RotateZAndZoom(LayerInfo* layer, float offset)
         GPURenderUtils::waitForRenderCompletion(&layer->buffer);
 
         static const float PI_2 = 6.283185307f;
-        xlColor c;
-        RenderBuffer orig(layer->buffer);
         int q = layer->zoomquality;
         int cx = layer->pivotpointx;
         if (layer->PivotPointXValueCurve.IsActive()) {
@@ -2832,26 +2792,63 @@ void PixelBufferClass::RotateZAndZoom(LayerInfo* layer, float offset)
         float anglecos = cos(-angle);
         float anglesin = sin(-angle);
 
-        layer->buffer.Clear();
-        for (int x = 0; x < layer->BufferWi; x++) {
+        int w = layer->buffer.BufferWi;
+        int h = layer->buffer.BufferHt;
+        size_t n = (size_t)w * h;
+        if (layer->zoomSourceSize < n) {
+            layer->zoomSource.reset(new std::atomic<uint64_t>[n]());
+            layer->zoomSourceSize = n;
+        }
+        std::atomic<uint64_t>* source = layer->zoomSource.get();
+
+        // Each sub pixel sample of each pixel is pushed to where it lands and the last one pushed to a pixel used to
+        // win. Samples are numbered in that order and each pixel keeps the highest number that lands on it so the
+        // columns can be pushed in parallel and still give the same answer.
+        parallel_for(0, w, [source, w, h, q, inc, xoff, yoff, anglecos, anglesin, zoom](int x) {
             for (int i = 0; i < q; i++) {
-                for (int y = 0; y < layer->BufferHt; y++) {
-                    orig.GetPixel(x, y, c);
+                float xx = (float)x + ((float)i * inc) - xoff;
+                float ux = xoff + anglecos * xx * zoom;
+                float vx = yoff + -anglesin * xx * zoom;
+                uint64_t sample = ((uint64_t)x * q + i) * h * q;
+                for (int y = 0; y < h; y++) {
                     for (int j = 0; j < q; j++) {
-                        float xx = (float)x + ((float)i * inc) - xoff;
+                        ++sample;
                         float yy = (float)y + ((float)j * inc) - yoff;
-                        float u = xoff + anglecos * xx * zoom + anglesin * yy * zoom;
-                        if (u >= 0 && u < layer->BufferWi) {
-                            float v = yoff + -anglesin * xx * zoom + anglecos * yy * zoom;
-
-                            if (v >= 0 && v < layer->BufferHt) {
-                                layer->buffer.SetPixel(u, v, c);
+                        float u = ux + anglesin * yy * zoom;
+                        if (u >= 0 && u < w) {
+                            float v = vx + anglecos * yy * zoom;
+                            if (v >= 0 && v < h) {
+                                std::atomic<uint64_t>& s = source[(int)v * w + (int)u];
+                                uint64_t cur = s.load(std::memory_order_relaxed);
+                                while (cur < sample && !s.compare_exchange_weak(cur, sample, std::memory_order_relaxed)) {
+                                }
                             }
                         }
                     }
                 }
             }
-        }
+        }, std::max(1, 2048 / std::max(h * q * q, 1)));
+
+        const xlColor* orig = CopyLayerPixels(layer->buffer.pixels, layer->buffer.pixelVector.size(), w, h, layer->transformPixels);
+        xlColor* pixels = layer->buffer.pixels;
+        int pixCount = std::min(n, layer->buffer.pixelVector.size());
+        parallel_for(0, h, [source, orig, pixels, w, h, q, pixCount](int y) {
+            for (int x = 0; x < w; ++x) {
+                int idx = y * w + x;
+                uint64_t sample = source[idx].exchange(0, std::memory_order_relaxed);
+                if (idx < pixCount) {
+                    if (sample == 0) {
+                        pixels[idx] = xlCLEAR;
+                    } else {
+                        // back to the pixel the sample came from
+                        --sample;
+                        uint64_t fromY = (sample / q) % h;
+                        uint64_t fromX = sample / q / h / q;
+                        pixels[idx] = orig[fromY * w + fromX];
+                    }
+                }
+            }
+        }, RowsPerJob(w));
     }
 }
 
@@ -2890,6 +2887,65 @@ bool PixelBufferClass::IsCanvasMix(int layer) const
     return layers[layer]->canvas;
 }
 
+bool PixelBufferClass::IsLayerMixStatic(int layer) const
+{
+    const LayerInfo* l = layers[layer];
+
+    // if any of these are in play the mixed output changes from frame to frame even if the pixels dont
+    return !(l->fadeInSteps > 0 || l->fadeOutSteps > 0 ||
+             l->sparkle_count > 0 || l->use_music_sparkle_count || l->effectMixVaries ||
+             l->SparklesValueCurve.IsActive() || l->BrightnessValueCurve.IsActive() ||
+             l->HueAdjustValueCurve.IsActive() || l->SaturationAdjustValueCurve.IsActive() || l->ValueAdjustValueCurve.IsActive() ||
+             IsVariableSubBuffer(layer));
+}
+
+bool PixelBufferClass::IsLayerStatic(int layer) const
+{
+    const LayerInfo* l = layers[layer];
+
+    if (l->persistent || l->canvas || IsVariableSubBuffer(layer) || l->freezeAfterFrame != 999999 || l->suppressUntil != 0) {
+        return false;
+    }
+    // in and out transitions rewrite the layer's pixels in place so they would be applied again to the reused pixels
+    if (l->fadeInSteps > 0 || l->fadeOutSteps > 0) {
+        return false;
+    }
+    if (l->BlurValueCurve.IsActive() || l->rotations != 0.0f ||
+        l->RotationValueCurve.IsActive() || l->XRotationValueCurve.IsActive() || l->YRotationValueCurve.IsActive() ||
+        l->ZoomValueCurve.IsActive() || l->RotationsValueCurve.IsActive() ||
+        l->PivotPointXValueCurve.IsActive() || l->PivotPointYValueCurve.IsActive() ||
+        l->XPivotValueCurve.IsActive() || l->YPivotValueCurve.IsActive()) {
+        return false;
+    }
+
+    // colour curves over time change the palette every frame
+    const PaletteClass& palette = l->buffer.palette;
+    for (size_t i = 0; i < palette.Size(); i++) {
+        if (palette.GetColorCurve(i).IsActive() && palette.GetColorCurve(i).GetTimeCurve() == TC_TIME) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t PixelBufferClass::GetLayerMixHash(int layer)
+{
+    LayerInfo* l = layers[layer];
+
+    if (!IsLayerMixStatic(layer)) {
+        return 0;
+    }
+
+    GPURenderUtils::waitForRenderCompletion(&l->buffer);
+
+    uint64_t hash = FNV1A_SEED;
+    hash = FNV1a(hash, l->buffer.BufferWi);
+    hash = FNV1a(hash, l->buffer.BufferHt);
+    hash = FNV1a(hash, l->buffer.Nodes.size());
+    hash = FNV1aWords(hash, l->buffer.GetPixels(), l->buffer.GetPixelCount() * sizeof(xlColor));
+    return hash == 0 ? 1 : hash;
+}
+
 void PixelBufferClass::PrepareVariableSubBuffer(int EffectPeriod, int layer)
 {
     if (!IsVariableSubBuffer(layer)) return;
@@ -3006,6 +3062,26 @@ void PixelBufferClass::CalcOutput(int EffectPeriod, const std::vector<bool> & va
         GPURenderUtils::waitForRenderCompletion(&layers[ii]->buffer);
     }
 
+    // apply the output hsv adjustments to whole rows up front rather than converting every node on its own
+    for (int ii = 0; ii < numLayers; ii++) {
+        LayerInfo* l = layers[ii];
+        RenderBuffer& b = l->buffer;
+        if (validLayers[ii] && l->needsHSVAdjust && b.BufferWi > 0 && b.BufferHt > 0 && b.GetPixelCount() >= b.BufferWi * b.BufferHt) {
+            l->adjustedPixels.resize(b.BufferWi * b.BufferHt);
+            parallel_for(0, b.BufferHt, [l, &b](int y) {
+                xlColor* row = &l->adjustedPixels[y * b.BufferWi];
+                std::copy(b.GetPixels() + y * b.BufferWi, b.GetPixels() + (y + 1) * b.BufferWi, row);
+                xlColorsAdjustHSV(row, b.BufferWi, l->outputHueAdjust, l->outputSaturationAdjust, l->outputValueAdjust);
+            }, 16);
+            l->adjustedClear = xlCLEAR;
+            xlColorsAdjustHSV(&l->adjustedClear, 1, l->outputHueAdjust, l->outputSaturationAdjust, l->outputValueAdjust);
+            l->adjustedBlack = xlBLACK;
+            xlColorsAdjustHSV(&l->adjustedBlack, 1, l->outputHueAdjust, l->outputSaturationAdjust, l->outputValueAdjust);
+        } else {
+            l->adjustedPixels.clear();
+        }
+    }
+
     // layer calculation and map to output
     size_t NodeCount = layers[0]->buffer.Nodes.size();
     int countValid = 0;
@@ -12,6 +12,9 @@
 
 #include <wx/xml/xml.h>
 
+#include <atomic>
+#include <memory>
+
 #include "models/Model.h"
 #include "models/SingleLineModel.h"
 #include "RenderBuffer.h"
@@ -228,6 +231,17 @@ private:
         float outputSaturationAdjust;
         float outputValueAdjust;
         bool  needsHSVAdjust = false;
+        // buffer pixels with the hsv adjustment already applied, built a row at a time by CalcOutput
+        xlColorVector adjustedPixels;
+        xlColor adjustedClear;
+        xlColor adjustedBlack;
+        // scratch for Blur and the rotations kept from frame to frame so they dont allocate every frame
+        std::vector<int32_t> blurValues;
+        std::vector<int32_t> blurTemp;
+        xlColorVector transformPixels;
+        std::vector<int> transformMap;
+        std::unique_ptr<std::atomic<uint64_t>[]> zoomSource;
+        size_t zoomSourceSize = 0;
         int   outputSparkleCount = 0;
         int   outputBrightnessAdjust = 0;
         float outputEffectMixThreshold;
@@ -263,6 +277,7 @@ private:
     void GetMixedColor(int node, const std::vector<bool> & validLayers, int EffectPeriod, int saveLayer);
 
     std::string modelName;
+    bool curvedNodes = false;
     std::string lastBufferType;
     std::string lastCamera;
     std::string lastBufferTransform;
@@ -283,6 +298,13 @@ public:
     uint32_t GetChanCountPerNode() const;
     MixTypes GetMixType(int layer) const;
     bool IsCanvasMix(int layer) const;
+    // hash of everything the layer contributes to a mix, 0 if that also depends on the frame (fades, value curves, sparkles)
+    uint64_t GetLayerMixHash(int layer);
+    // the way the layer is mixed into the output is the same every frame
+    bool IsLayerMixStatic(int layer) const;
+    // the buffer settings (sub buffer, blur, rotozoom, palette ...) do nothing which changes from frame to frame so if
+    // the effect draws the same pixels the layer buffer will be the same as the frame before
+    bool IsLayerStatic(int layer) const;
     int GetFrameTimeInMS() const { return frameTimeInMs; }
 
     bool IsVariableSubBuffer(int layer) const;
@@ -322,6 +344,8 @@ public:
     void CalcOutput(int EffectPeriod, const std::vector<bool> &validLayers, int saveLayer = 0);
     void SetColors(int layer, const unsigned char *fdata);
     void GetColors(unsigned char *fdata, const std::vector<bool> &restrictRange);
+    // GetColors had to dim some node colours in place so they are no longer what CalcOutput left there
+    bool HasCurvedNodes() const { return curvedNodes; }
 
     //place for GPU Renderers to attach extra data/objects it needs
     void *gpuRenderData = nullptr;
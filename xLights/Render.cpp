@@ -26,10 +26,14 @@
 #include "PixelBuffer.h"
 #include "Parallel.h"
 #include "ExternalHooks.h"
+#include "RenderBenchmark.h"
+#include "MemoryAccounting.h"
 
 #include <log4cpp/Category.hh>
 
 #define END_OF_RENDER_FRAME INT_MAX
+// number of frames ahead we ask a disk backed SequenceData to page in
+#define PREFETCH_FRAMES 32
 
 //other common strings
 static const std::string STR_EMPTY("");
@@ -56,6 +60,12 @@ public:
         settingsMaps.resize(l);
         effectStates.resize(l);
         validLayers.resize(l + 1); //extra one for the blending layer
+        canvasLayers.resize(l);
+        canvasKeys.resize(l, 0);
+        canvasComposites.resize(l);
+        staticEffects.resize(l);
+        staticLayers.resize(l);
+        staticValid.resize(l);
     }
 
     int numLayers;
@@ -67,6 +77,23 @@ public:
     std::vector<SettingsMap> settingsMaps;
     std::vector<bool> effectStates;
     std::vector<bool> validLayers;
+
+    // for canvas layers the lower layers selected to be mixed in (parsed once per effect) and
+    // the last composite along with a key describing what went into it so it can be reused
+    std::vector<std::vector<bool>> canvasLayers;
+    std::vector<uint64_t> canvasKeys;
+    std::vector<xlColorVector> canvasComposites;
+
+    // effects which draw the same thing every frame, whether the layer buffer still holds what they drew on
+    // lastFrame and if that was valid
+    std::vector<bool> staticEffects;
+    std::vector<bool> staticLayers;
+    std::vector<bool> staticValid;
+    int lastFrame = -1;
+    // the nodes still hold the output mixed for lastFrame
+    bool outputCalculated = false;
+    int reusedLayerFrames = 0;
+    int reusedOutputFrames = 0;
 };
 
 class RenderEvent {
@@ -534,6 +561,56 @@ public:
         return frame - (ef->GetStartTimeMS() / frameTime);
     }
 
+    // Parse the layers a canvas effect mixes in once when the effect starts rather than every frame
+    void SetCanvasLayers(EffectLayerInfo &info, int layer) {
+        std::vector<bool>& selected = info.canvasLayers[layer];
+        selected.assign(info.validLayers.size(), true);
+        const std::string ls = info.settingsMaps[layer].Get("LayersSelected", "");
+        if (ls != "") {
+            std::fill(selected.begin(), selected.end(), false);
+            wxArrayString sel = wxSplit(ls, '|');
+            for (const auto& it : sel) {
+                int i = wxAtoi(it) + layer + 1;
+                if (i >= 0 && i < selected.size()) {
+                    selected[i] = true;
+                }
+            }
+        }
+        info.canvasKeys[layer] = 0;
+        info.canvasComposites[layer].clear();
+    }
+
+    // Describes what the composite preloaded into a canvas layer is built from. 0 means it has to be
+    // recalculated every frame
+    uint64_t GetCanvasKey(EffectLayerInfo &info, PixelBufferClass *buffer, int layer, const std::vector<bool> &vl) {
+        if (buffer->IsVariableSubBuffer(layer)) {
+            return 0;
+        }
+        uint64_t key = FNV1A_SEED;
+        auto mix = [&key](uint64_t v) {
+            key = FNV1a(key, v);
+        };
+        RenderBuffer& rb = buffer->BufferForLayer(layer, -1);
+        mix((uint64_t)(uintptr_t)info.currentEffects[layer]);
+        mix(rb.BufferWi);
+        mix(rb.BufferHt);
+        for (int i = layer + 1; i < vl.size(); i++) {
+            if (vl[i]) {
+                if (i >= info.numLayers) {
+                    return 0;
+                }
+                uint64_t h = buffer->GetLayerMixHash(i);
+                if (h == 0) {
+                    return 0;
+                }
+                mix(i);
+                mix((uint64_t)(uintptr_t)info.currentEffects[i]);
+                mix(h);
+            }
+        }
+        return key == 0 ? 1 : key;
+    }
+
     bool ProcessFrame(int frame, Element *el, EffectLayerInfo &info, PixelBufferClass *buffer, int strand = -1, bool blend = false) {
         wxStopWatch sw;
         bool effectsToUpdate = false;
@@ -542,6 +619,8 @@ public:
         for (int x = 0; x < info.validLayers.size(); x++) {
             info.validLayers[x] = false;
         }
+        // if nothing changes on any layer the output will be the same as last frame
+        bool outputStatic = !blend && info.outputCalculated && info.lastFrame == frame - 1;
 
         // To support canvas mix type we must render them bottom to top
         for (int layer = numLayers - 1; layer >= 0; --layer) {
@@ -553,7 +632,10 @@ public:
                 info.currentEffects[layer] = ef;
                 SetInializingStatus(frame, layer, strand);
                 initialize(layer, frame, ef, info.settingsMaps[layer], buffer);
-                info.effectStates[layer] = true;
+                info.effectStates[layer] = !ResumeFromCheckpoint(layer, frame, info, buffer);
+                SetCanvasLayers(info, layer);
+                SetStaticEffect(info, layer, buffer);
+                outputStatic = false;
             }
 
             if (buffer->IsVariableSubBuffer(layer)) {
@@ -566,68 +648,95 @@ public:
                 freeze = buffer->GetFreezeFrame(layer) != 999999 && buffer->GetFreezeFrame(layer) <= GetEffectFrame(ef, frame, mainBuffer->GetFrameTimeInMS());
             }
 
-            if ((!persist && !freeze) || info.currentEffects[layer] == nullptr || info.currentEffects[layer]->GetEffectIndex() == -1) {
-                buffer->Clear(layer);
-            }
-
             bool suppress = false;
             if (ef != nullptr && buffer != nullptr) {
                 suppress = buffer->GetSuppressUntil(layer) > GetEffectFrame(ef, frame, mainBuffer->GetFrameTimeInMS());
             }
 
+            // the buffer still holds exactly what the effect would draw
+            if (!freeze && !suppress && info.staticLayers[layer] && info.lastFrame == frame - 1) {
+                // the mix still needs to know which frame it is on
+                buffer->SetLayer(layer, frame, false);
+                info.validLayers[layer] = info.staticValid[layer];
+                effectsToUpdate |= info.validLayers[layer];
+                info.reusedLayerFrames++;
+                continue;
+            }
+            info.staticLayers[layer] = false;
+            if (ef != nullptr) {
+                outputStatic = false;
+            }
+
+            if ((!persist && !freeze) || info.currentEffects[layer] == nullptr || info.currentEffects[layer]->GetEffectIndex() == -1) {
+                buffer->Clear(layer);
+            }
+
             SetRenderingStatus(frame, &info.settingsMaps[layer], layer, strand, -1, true);
             bool b = info.effectStates[layer];
 
             if (!freeze) {
                 // Mix canvas pre-loads the buffer with data from underlying layers
                 if (buffer->IsCanvasMix(layer) && layer < numLayers - 1) {
-                    auto vl = info.validLayers;
-                    if (info.settingsMaps[layer].Get("LayersSelected", "") != "") {
-                        // remove from valid layers any layers we dont need to include
-                        wxArrayString ls = wxSplit(info.settingsMaps[layer].Get("LayersSelected", ""), '|');
-                        for (int i = layer + 1; i < vl.size(); i++) {
-                            if (vl[i]) {
-                                bool found = false;
-                                for (auto it = ls.begin(); !found && it != ls.end(); ++it) {
-                                    if (wxAtoi(*it) + layer + 1 == i) {
-                                        found = true;
-                                    }
-                                }
-                                if (!found) {
-                                    vl[i] = false;
-                                }
-                            }
-                        }
+                    // only the selected lower layers take part
+                    const std::vector<bool>& selected = info.canvasLayers[layer];
+                    std::vector<bool> vl(info.validLayers.size(), false);
+                    for (int i = layer + 1; i < vl.size(); i++) {
+                        vl[i] = info.validLayers[i] && (i >= selected.size() || selected[i]);
                     }
 
                     // preload the buffer with the output from the lower layers
                     RenderBuffer& rb = buffer->BufferForLayer(layer, -1);
-
-                    // I have to calc the output here to apply blend, rotozoom and transitions
-                    buffer->CalcOutput(frame, vl, layer);
-                    std::vector<bool> done(rb.GetPixelCount());
-                    rb.CopyNodeColorsToPixels(done);
-                    // now fill in any spaces in the buffer that don't have nodes mapped to them
-                    parallel_for(0, rb.BufferHt, [&rb, &buffer, &done, &vl, frame](int y) {
-                        for (int x = 0; x < rb.BufferWi; x++) {
-                            if (!done[y * rb.BufferWi + x]) {
-                                xlColor c = xlBLACK;
-                                buffer->GetMixedColor(x, y, c, vl, frame);
-                                rb.SetPixel(x, y, c);
+                    xlColorVector& composite = info.canvasComposites[layer];
+                    uint64_t key = GetCanvasKey(info, buffer, layer, vl);
+                    RenderStageTimer::Scope canvasTimer(RenderStageTimer::STAGE_CANVAS);
+                    if (key != 0 && key == info.canvasKeys[layer] && composite.size() == rb.GetPixelCount()) {
+                        // lower layers are unchanged since the last frame
+                        std::copy(composite.begin(), composite.end(), rb.GetPixels());
+                    } else {
+                        // I have to calc the output here to apply blend, rotozoom and transitions
+                        buffer->CalcOutput(frame, vl, layer);
+                        std::vector<bool> done(rb.GetPixelCount());
+                        rb.CopyNodeColorsToPixels(done);
+                        // now fill in any spaces in the buffer that don't have nodes mapped to them
+                        parallel_for(0, rb.BufferHt, [&rb, &buffer, &done, &vl, frame](int y) {
+                            for (int x = 0; x < rb.BufferWi; x++) {
+                                if (!done[y * rb.BufferWi + x]) {
+                                    xlColor c = xlBLACK;
+                                    buffer->GetMixedColor(x, y, c, vl, frame);
+                                    rb.SetPixel(x, y, c);
+                                }
                             }
+                            });
+
+                        if (key != 0) {
+                            composite.assign(rb.GetPixels(), rb.GetPixels() + rb.GetPixelCount());
+                        } else {
+                            composite.clear();
                         }
-                        });
+                        info.canvasKeys[layer] = key;
+                    }
                 }
 
-                info.validLayers[layer] = xLights->RenderEffectFromMap(suppress, ef, layer, frame, info.settingsMaps[layer], *buffer, b, true, &renderEvent);
+                {
+                    RenderStageTimer::Scope effectTimer(RenderStageTimer::STAGE_EFFECTS);
+                    info.validLayers[layer] = xLights->RenderEffectFromMap(suppress, ef, layer, frame, info.settingsMaps[layer], *buffer, b, true, &renderEvent);
+                }
                 effectsToUpdate |= info.validLayers[layer];
                 info.effectStates[layer] = b;
 
+                // snapshot what the effect drew ... blur and zoom are applied again when it is restored
+                if (info.validLayers[layer]) {
+                    xLights->_renderCheckpoints.Save(ef, layer, frame, *buffer);
+                }
+
                 if (suppress) {
                     info.validLayers[layer] = false;
                 } else {
+                    RenderStageTimer::Scope blurZoomTimer(RenderStageTimer::STAGE_BLUR_ZOOM);
                     buffer->HandleLayerBlurZoom(frame, layer);
                 }
+                info.staticLayers[layer] = info.staticEffects[layer] && !suppress;
+                info.staticValid[layer] = info.validLayers[layer];
             } else {
                 info.validLayers[layer] = true;
                 info.effectStates[layer] = b;
@@ -636,14 +745,26 @@ public:
         }
 
         if (effectsToUpdate) {
+            RenderStageTimer::Scope calcOutputTimer(RenderStageTimer::STAGE_CALC_OUTPUT);
             SetCalOutputStatus(frame, strand);
             if (blend) {
                 buffer->SetColors(numLayers, &((*seqData)[frame][0]));
                 info.validLayers[numLayers] = true;
             }
-            buffer->CalcOutput(frame, info.validLayers);
+            outputStatic = outputStatic && !buffer->HasCurvedNodes();
+            for (int layer = 0; layer < numLayers && outputStatic; layer++) {
+                outputStatic = !info.validLayers[layer] || buffer->IsLayerMixStatic(layer);
+            }
+            if (outputStatic) {
+                // the nodes still hold last frame's output
+                info.reusedOutputFrames++;
+            } else {
+                buffer->CalcOutput(frame, info.validLayers);
+            }
             buffer->GetColors(&((*seqData)[frame][0]), rangeRestriction);
         }
+        info.outputCalculated = effectsToUpdate;
+        info.lastFrame = frame;
 
         if (sw.Time() > 500)
         {
@@ -710,7 +831,8 @@ public:
                 mainModelInfo.currentEffects[layer] = findEffectForFrame(elayer, startFrame, mainModelInfo.currentEffectIdxs[layer]);
                 SetGenericStatus("Initializing starting effect for %s, startFrame %d, and layer %d ", (int)startFrame, layer, false, true);
                 initialize(layer, startFrame, mainModelInfo.currentEffects[layer], mainModelInfo.settingsMaps[layer], mainBuffer);
-                mainModelInfo.effectStates[layer] = true;
+                mainModelInfo.effectStates[layer] = !ResumeFromCheckpoint(layer, startFrame, mainModelInfo, mainBuffer);
+                SetStaticEffect(mainModelInfo, layer, mainBuffer);
             }
 
             for (int frame = startFrame; frame <= endFrame; ++frame) {
@@ -720,6 +842,9 @@ public:
                 if (abort) {
                     break;
                 }
+                if ((frame - startFrame) % PREFETCH_FRAMES == 0) {
+                    seqData->Prefetch(frame, PREFETCH_FRAMES * 2);
+                }
 
                 if (!HasNext() &&
                         (origChangeCount != rowToRender->getChangeCount()
@@ -798,6 +923,17 @@ public:
                 }
             }
             SetGenericStatus("%s: All done - Completed frame %d ", endFrame, true, true);
+
+            int reusedLayerFrames = mainModelInfo.reusedLayerFrames;
+            int reusedOutputFrames = mainModelInfo.reusedOutputFrames;
+            for (const auto& it : subModelInfos) {
+                reusedLayerFrames += it->reusedLayerFrames;
+                reusedOutputFrames += it->reusedOutputFrames;
+            }
+            if (reusedLayerFrames > 0) {
+                renderLog.debug("Model %s frames %d-%d: %d layer frames and %d output frames were unchanged and not rendered.",
+                                (const char*)rowToRender->GetModelName().c_str(), (int)startFrame, (int)endFrame, reusedLayerFrames, reusedOutputFrames);
+            }
         } catch ( std::exception &ex) {
             wxASSERT(false); // so when we debug we catch them
             printf("Caught an exception %s", ex.what());
@@ -854,6 +990,65 @@ private:
         }
     }
 
+    // Effects which draw the same thing every frame only need to be rendered on the first
+    void SetStaticEffect(EffectLayerInfo &info, int layer, PixelBufferClass *buffer) {
+        Effect* ef = info.currentEffects[layer];
+        info.staticLayers[layer] = false;
+        info.staticEffects[layer] = false;
+        if (ef == nullptr || ef->GetEffectIndex() < 0 || ef->IsRenderDisabled() || !buffer->IsLayerStatic(layer)) {
+            return;
+        }
+        RenderableEffect* reff = xLights->GetEffectManager().GetEffect(ef->GetEffectIndex());
+        info.staticEffects[layer] = reff != nullptr && reff->IsStatic(ef, info.settingsMaps[layer], buffer->BufferForLayer(layer, -1));
+    }
+
+    // A stateful effect which started before frame would otherwise start again from scratch at frame. Restore
+    // the nearest snapshot taken on an earlier render and replay the frames from there so the effect picks up
+    // where it would have been.
+    bool ResumeFromCheckpoint(int layer, int frame, EffectLayerInfo &info, PixelBufferClass *buffer) {
+        Effect* ef = info.currentEffects[layer];
+        if (ef == nullptr || ef->GetEffectIndex() < 0 || ef->IsRenderDisabled() || buffer->IsCanvasMix(layer)) {
+            return false;
+        }
+        int frameTime = buffer->GetFrameTimeInMS();
+        if (frameTime <= 0 || ef->GetStartTimeMS() / frameTime >= frame) {
+            return false;
+        }
+        RenderableEffect* reff = xLights->GetEffectManager().GetEffect(ef->GetEffectIndex());
+        if (reff == nullptr || reff->CanRenderPartialTimeInterval()) {
+            return false;
+        }
+        int from = xLights->_renderCheckpoints.Restore(ef, layer, frame - 1, *buffer);
+        if (from < 0) {
+            return false;
+        }
+
+        renderLog.debug("Model %s layer %d effect %s resuming from frame %d to render from frame %d.",
+                        (const char*)buffer->GetModelName().c_str(), layer, (const char*)ef->GetEffectName().c_str(), from, frame);
+        if (buffer->GetSuppressUntil(layer) <= GetEffectFrame(ef, from, frameTime)) {
+            buffer->HandleLayerBlurZoom(from, layer);
+        }
+        bool reset = false;
+        for (int f = from + 1; f < frame && !abort; ++f) {
+            int effectFrame = GetEffectFrame(ef, f, frameTime);
+            if (buffer->GetFreezeFrame(layer) != 999999 && buffer->GetFreezeFrame(layer) <= effectFrame) {
+                break;
+            }
+            if (buffer->IsVariableSubBuffer(layer)) {
+                buffer->PrepareVariableSubBuffer(f, layer);
+            }
+            if (!buffer->IsPersistent(layer)) {
+                buffer->Clear(layer);
+            }
+            bool suppress = buffer->GetSuppressUntil(layer) > effectFrame;
+            xLights->RenderEffectFromMap(suppress, ef, layer, f, info.settingsMaps[layer], *buffer, reset, true, &renderEvent);
+            if (!suppress) {
+                buffer->HandleLayerBlurZoom(f, layer);
+            }
+        }
+        return true;
+    }
+
     Effect *findEffectForFrame(EffectLayer* layer, int frame, int &lastIdx) {
         if (layer == nullptr) {
             return nullptr;
@@ -976,6 +1171,7 @@ public:
         jobs = nullptr;
         aggregators = nullptr;
         renderProgressDialog = nullptr;
+        seqData = nullptr;
     };
     std::function<void()> callback;
     int numRows;
@@ -985,6 +1181,7 @@ public:
     AggregatorRenderer **aggregators;
     RenderProgressDialog *renderProgressDialog;
     std::list<Model *> restriction;
+    SequenceData *seqData;
 };
 
 void xLightsFrame::LogRenderStatus()
@@ -1018,6 +1215,7 @@ void xLightsFrame::LogRenderStatus()
             }
         }
     }
+    logger_base.debug("Memory use:\n%s", (const char *)MemoryAccounting::GetReport().c_str());
     logger_base.debug("*************************************");
 }
 
@@ -1139,6 +1337,7 @@ void xLightsFrame::UpdateRenderStatus() {
             }
             _appProgress->SetValue(0);
             _appProgress->Reset();
+            rpi->seqData->Flush();
             RenderDone();
             delete []rpi->jobs;
             delete []rpi->aggregators;
@@ -1451,6 +1650,7 @@ void xLightsFrame::Render(SequenceElements& seqElements,
         pi->renderProgressDialog = renderProgressDialog;
         pi->restriction = restrictToModels;
         pi->aggregators = aggregators;
+        pi->seqData = &seqData;
 
         renderProgressInfo.push_back(pi);
         RenderStatusTimer.Start(100, false);
@@ -2077,8 +2277,11 @@ bool xLightsFrame::RenderEffectFromMap(bool suppress, Effect* effectObj, int lay
                             }
 
                             wxStopWatch sw;
+                            rb->fromRenderCache = false;
                             if (effectObj != nullptr && reff->SupportsRenderCache(SettingsMap)) {
-                                if (!effectObj->GetFrame(*rb, _renderCache)) {
+                                if (effectObj->GetFrame(*rb, _renderCache)) {
+                                    rb->fromRenderCache = true;
+                                } else {
                                     reff->Render(effectObj, SettingsMap, *rb);
                                     effectObj->AddFrame(*rb, _renderCache);
                                 }
@@ -2094,6 +2297,7 @@ bool xLightsFrame::RenderEffectFromMap(bool suppress, Effect* effectObj, int lay
 
                             if (suppress && oldBuffer != nullptr) {
                                 oldBuffer->needToInit = rb->needToInit;
+                                oldBuffer->fromRenderCache = rb->fromRenderCache;
                                 oldBuffer->infoCache = rb->infoCache;
                                 delete newBuffer;
                             }
@@ -0,0 +1,206 @@
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <wx/wx.h>
+#include <wx/file.h>
+
+#include "RenderBenchmark.h"
+#include "../xSchedule/wxJSON/jsonreader.h"
+#include "../xSchedule/wxJSON/jsonwriter.h"
+
+#include <log4cpp/Category.hh>
+
+std::atomic_bool RenderStageTimer::_enabled(false);
+std::atomic<uint64_t> RenderStageTimer::_nanos[RenderStageTimer::STAGE_COUNT];
+
+void RenderStageTimer::Start()
+{
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        _nanos[i] = 0;
+    }
+    _enabled = true;
+}
+
+void RenderStageTimer::Stop()
+{
+    _enabled = false;
+}
+
+double RenderStageTimer::GetMS(Stage stage)
+{
+    return (double)_nanos[stage] / 1000000.0;
+}
+
+const char* RenderStageTimer::GetName(Stage stage)
+{
+    switch (stage) {
+    case STAGE_EFFECTS:
+        return "effects";
+    case STAGE_CANVAS:
+        return "canvas";
+    case STAGE_BLUR_ZOOM:
+        return "blur_zoom";
+    case STAGE_CALC_OUTPUT:
+        return "calc_output";
+    default:
+        break;
+    }
+    return "unknown";
+}
+
+void RenderBenchmark::AddStageTimes(const std::string& prefix)
+{
+    for (int i = 0; i < RenderStageTimer::STAGE_COUNT; i++) {
+        RenderStageTimer::Stage s = (RenderStageTimer::Stage)i;
+        Set(prefix + RenderStageTimer::GetName(s) + "_ms", RenderStageTimer::GetMS(s));
+    }
+}
+
+static wxString ChecksumString(uint64_t checksum)
+{
+    return wxString::Format("%016llx", (unsigned long long)checksum);
+}
+
+static wxJSONValue ToJSONValue(const std::map<std::string, double>& values, const std::map<std::string, uint64_t>& checksums)
+{
+    wxJSONValue val;
+    for (const auto& it : values) {
+        val[it.first] = it.second;
+    }
+    if (!checksums.empty()) {
+        wxJSONValue& cs = val["checksums"];
+        for (const auto& it : checksums) {
+            cs[it.first] = ChecksumString(it.second);
+        }
+    }
+    return val;
+}
+
+std::string RenderBenchmark::ToJSON() const
+{
+    wxString str;
+    wxJSONWriter writer(wxJSONWRITER_NONE, 0, 3);
+    writer.Write(ToJSONValue(_values, _checksums), str);
+    return str.ToStdString();
+}
+
+bool RenderBenchmark::Save(const std::string& file) const
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    wxString str;
+    wxJSONWriter writer(wxJSONWRITER_STYLED, 0, 3);
+    writer.Write(ToJSONValue(_values, _checksums), str);
+
+    wxFile f;
+    if (!f.Create(file, true) || !f.Write(str)) {
+        logger_base.warn("Unable to write render benchmark results to %s.", (const char*)file.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool RenderBenchmark::LoadBaseline(const std::string& file)
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    _baseline.clear();
+    _baselineChecksums.clear();
+
+    wxFile f;
+    wxString str;
+    if (!wxFile::Exists(file) || !f.Open(file) || !f.ReadAll(&str)) {
+        logger_base.warn("Unable to read render benchmark baseline %s.", (const char*)file.c_str());
+        return false;
+    }
+
+    wxJSONValue val;
+    wxJSONReader reader;
+    if (reader.Parse(str, &val) != 0 || !val.IsObject()) {
+        logger_base.warn("Render benchmark baseline %s is not valid json.", (const char*)file.c_str());
+        return false;
+    }
+    for (const auto& name : val.GetMemberNames()) {
+        const wxJSONValue& v = val[name];
+        if (v.IsDouble()) {
+            _baseline[name.ToStdString()] = v.AsDouble();
+        } else if (v.IsInt()) {
+            _baseline[name.ToStdString()] = v.AsInt();
+        }
+    }
+    if (val.HasMember("checksums")) {
+        const wxJSONValue& cs = val["checksums"];
+        for (const auto& name : cs.GetMemberNames()) {
+            unsigned long long checksum = 0;
+            if (cs[name].AsString().ToULongLong(&checksum, 16)) {
+                _baselineChecksums[name.ToStdString()] = checksum;
+            }
+        }
+    }
+    return !_baseline.empty() || !_baselineChecksums.empty();
+}
+
+std::string RenderBenchmark::CompareJSON(double tolerance, int& regressions, int pixelTolerance) const
+{
+    regressions = 0;
+    wxJSONValue val;
+    for (const auto& it : _values) {
+        auto b = _baseline.find(it.first);
+        if (b == _baseline.end()) {
+            continue;
+        }
+        bool rate = it.first.size() > 4 && it.first.compare(it.first.size() - 4, 4, "_fps") == 0;
+
+        // percent change where positive is always an improvement
+        double change = 0.0;
+        if (b->second > 0.0) {
+            change = rate ? (it.second - b->second) * 100.0 / b->second : (b->second - it.second) * 100.0 / b->second;
+        }
+
+        // stages which barely register are dominated by timer noise
+        bool regressed = change < -tolerance && (rate || b->second >= 1.0 || it.second >= 1.0);
+        if (regressed) {
+            regressions++;
+        }
+
+        wxJSONValue& m = val[it.first];
+        m["baseline"] = b->second;
+        m["current"] = it.second;
+        m["changepct"] = change;
+        m["regressed"] = regressed;
+    }
+
+    wxJSONValue changed;
+    changed.SetType(wxJSONTYPE_ARRAY);
+    for (const auto& it : _checksums) {
+        if (_renderDiffs.find(it.first) != _renderDiffs.end()) {
+            continue;
+        }
+        auto b = _baselineChecksums.find(it.first);
+        if (b != _baselineChecksums.end() && b->second != it.second) {
+            changed.Append(wxString(it.first));
+            regressions++;
+        }
+    }
+    for (const auto& it : _renderDiffs) {
+        val["renderdiff"][it.first] = it.second;
+        if (it.second > pixelTolerance) {
+            changed.Append(wxString(it.first));
+            regressions++;
+        }
+    }
+    val["outputchanged"] = changed;
+    val["regressions"] = regressions;
+
+    wxString str;
+    wxJSONWriter writer(wxJSONWRITER_NONE, 0, 3);
+    writer.Write(val, str);
+    return str.ToStdString();
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+
+// Time spent in each stage of a render, summed across all the render threads.
+//
+// Stages are only timed between Start and Stop so a normal render pays nothing more than a flag check.
+class RenderStageTimer
+{
+public:
+    enum Stage
+    {
+        STAGE_EFFECTS,
+        STAGE_CANVAS,
+        STAGE_BLUR_ZOOM,
+        STAGE_CALC_OUTPUT,
+        STAGE_COUNT
+    };
+
+    static void Start();
+    static void Stop();
+    static bool IsEnabled() { return _enabled; }
+    static double GetMS(Stage stage);
+    static const char* GetName(Stage stage);
+
+    // times the enclosing block
+    class Scope
+    {
+    public:
+        explicit Scope(Stage stage) : _stage(stage), _timing(_enabled)
+        {
+            if (_timing) {
+                _start = std::chrono::steady_clock::now();
+            }
+        }
+        ~Scope()
+        {
+            if (_timing) {
+                _nanos[_stage] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count();
+            }
+        }
+
+    private:
+        Stage _stage;
+        bool _timing;
+        std::chrono::steady_clock::time_point _start;
+    };
+
+private:
+    static std::atomic_bool _enabled;
+    static std::atomic<uint64_t> _nanos[STAGE_COUNT];
+};
+
+// The measurements from one benchmark run.
+//
+// Names ending in _fps are rates where bigger is better ... everything else is a time where smaller
+// is better. Checksums of rendered output can be recorded alongside so a later run can show an optimisation
+// did not change what is rendered. Results can be saved as json and used as the baseline for a later run.
+class RenderBenchmark
+{
+public:
+    void Set(const std::string& name, double value) { _values[name] = value; }
+    void SetChecksum(const std::string& name, uint64_t checksum) { _checksums[name] = checksum; }
+    // largest difference in any colour channel between a render and the baseline render of the same thing
+    void SetRenderDifference(const std::string& name, int maxChannelDiff) { _renderDiffs[name] = maxChannelDiff; }
+    void AddStageTimes(const std::string& prefix);
+
+    std::string ToJSON() const;
+    bool Save(const std::string& file) const;
+    bool LoadBaseline(const std::string& file);
+    bool HasBaseline() const { return !_baseline.empty() || !_baselineChecksums.empty(); }
+
+    // Anything more than tolerance percent worse than the baseline is counted as a regression as is
+    // any checksum which differs from the baseline. Where the render itself was compared the output only
+    // counts as changed if a colour channel moved by more than pixelTolerance.
+    std::string CompareJSON(double tolerance, int& regressions, int pixelTolerance = 0) const;
+
+private:
+    std::map<std::string, double> _values;
+    std::map<std::string, uint64_t> _checksums;
+    std::map<std::string, int> _renderDiffs;
+    std::map<std::string, double> _baseline;
+    std::map<std::string, uint64_t> _baselineChecksums;
+};
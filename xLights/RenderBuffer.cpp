@@ -24,10 +24,15 @@
 #include "models/DMX/DmxModel.h"
 #include "models/DMX/DmxColorAbility.h"
 #include "GPURenderUtils.h"
+#include "MemoryAccounting.h"
 
 #include <log4cpp/Category.hh>
 #include "Parallel.h"
 
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
 template <class CTX>
 class ContextPool {
 public:
@@ -54,22 +59,57 @@ public:
             return allocator();
         }
 
+        CTX *ret = nullptr;
+        bool refill = false;
         {
             std::unique_lock<std::mutex> locker(lock);
-            CTX *ret = contexts.front();
-            contexts.pop();
-            return ret;
+            if (!contexts.empty()) {
+                ret = contexts.front();
+                contexts.pop();
+                if (lowWaterCallback && !refillPending && contexts.size() < lowWater) {
+                    refillPending = true;
+                    refill = true;
+                }
+            }
         }
+        if (refill) {
+            lowWaterCallback();
+        }
+        if (ret == nullptr) {
+            // another thread took the last one
+            ret = allocator();
+        }
+        return ret;
     }
     void ReleaseContext(CTX *pctx) {
         std::unique_lock<std::mutex> locker(lock);
         contexts.push(pctx);
     }
+
+    // Creates contexts up front so that render threads find one waiting rather than having to
+    // wait for the main thread to make one. Must be called on the thread the allocator creates contexts on.
+    void Prime(size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            ReleaseContext(allocator());
+        }
+        std::unique_lock<std::mutex> locker(lock);
+        refillPending = false;
+    }
+
+    // Called (once until the next Prime) when taking a context leaves fewer than lw in the pool
+    void SetLowWater(size_t lw, std::function<void()> cb) {
+        std::unique_lock<std::mutex> locker(lock);
+        lowWater = lw;
+        lowWaterCallback = cb;
+    }
     
 private:
     std::mutex lock;
     std::queue<CTX*> contexts;
     std::function<CTX* ()> allocator;
+    std::function<void()> lowWaterCallback;
+    size_t lowWater = 0;
+    bool refillPending = false;
     std::string _type;
 };
 
@@ -95,6 +135,17 @@ void DrawingContext::Initialize(wxWindow *parent) {
                 return tdc;
             }
         });
+        // Text effects (lyrics in particular) can need a lot of these. Keep a stock built on the main
+        // thread and top it up in the background so render threads rarely block waiting for one.
+        size_t stock = std::max(4u, std::min(16u, std::thread::hardware_concurrency()));
+        TEXT_CONTEXT_POOL->Prime(stock);
+        TEXT_CONTEXT_POOL->SetLowWater(stock / 2, [parent, stock]() {
+            parent->CallAfter([stock]() {
+                if (TEXT_CONTEXT_POOL != nullptr) {
+                    TEXT_CONTEXT_POOL->Prime(stock);
+                }
+            });
+        });
     }
     if (PATH_CONTEXT_POOL == nullptr) {
         PATH_CONTEXT_POOL = new ContextPool<PathDrawingContext>([parent]() {
@@ -636,6 +687,7 @@ RenderBuffer::~RenderBuffer()
         GPURenderUtils::cleanUp(this);
         gpuRenderData = nullptr;
     }
+    MemoryAccounting::Remove(MemoryAccounting::PIXEL_BUFFERS, _accountedBytes);
 }
 
 PathDrawingContext * RenderBuffer::GetPathDrawingContext()
@@ -681,6 +733,10 @@ void RenderBuffer::InitBuffer(int newBufferHt, int newBufferWi, const std::strin
     tempbufVector.resize(NumPixels);
     tempbuf = &tempbufVector[0];
     isTransformed = (bufferTransform != "None");
+
+    size_t bytes = sizeof(xlColor) * (pixelVector.capacity() + tempbufVector.capacity());
+    MemoryAccounting::Add(MemoryAccounting::PIXEL_BUFFERS, (int64_t)bytes - (int64_t)_accountedBytes);
+    _accountedBytes = bytes;
 }
 
 void RenderBuffer::Clear()
@@ -758,6 +814,58 @@ float RenderBuffer::cos(float rad)
     return sinTable.cos(rad);
 }
 
+PolarTable::PolarTable(int maxX, int maxY) :
+    _maxX(maxX), _maxY(maxY), _stride(maxX + 1)
+{
+    _radius.resize((size_t)(maxX + 1) * (maxY + 1));
+    _angle.resize((size_t)(maxX + 1) * (2 * maxY + 1));
+    parallel_for(0, maxY + 1, [this, maxX](int y) {
+        size_t idx = (size_t)y * _stride;
+        for (int x = 0; x <= maxX; x++, idx++) {
+            _radius[idx] = std::hypot(x, y);
+        }
+    }, 64);
+    // atan2 is only odd in x so both signs of y are stored
+    parallel_for(0, 2 * maxY + 1, [this, maxX, maxY](int row) {
+        size_t idx = (size_t)row * _stride;
+        for (int x = 0; x <= maxX; x++, idx++) {
+            _angle[idx] = std::atan2(x, row - maxY);
+        }
+    }, 64);
+    MemoryAccounting::Add(MemoryAccounting::EFFECT_CACHES, GetSize());
+}
+
+PolarTable::~PolarTable()
+{
+    MemoryAccounting::Remove(MemoryAccounting::EFFECT_CACHES, GetSize());
+}
+
+// 1024 x 1024 offsets is about 25MB ... anything bigger just does the maths
+#define POLAR_TABLE_MAX_ENTRIES (1025 * 1025)
+
+std::shared_ptr<const PolarTable> RenderBuffer::GetPolarTable(int maxX, int maxY)
+{
+    static std::mutex polarTableLock;
+    static std::shared_ptr<const PolarTable> polarTable;
+
+    maxX = std::max(0, maxX);
+    maxY = std::max(0, maxY);
+    std::unique_lock<std::mutex> locker(polarTableLock);
+    if (polarTable == nullptr || polarTable->GetMaxX() < maxX || polarTable->GetMaxY() < maxY) {
+        if ((int64_t)(maxX + 1) * (maxY + 1) > POLAR_TABLE_MAX_ENTRIES) {
+            return nullptr;
+        }
+        // grow to cover every size asked for so far so buffers of different shapes dont keep rebuilding it
+        if (polarTable != nullptr && (int64_t)(std::max(maxX, polarTable->GetMaxX()) + 1) * (std::max(maxY, polarTable->GetMaxY()) + 1) <= POLAR_TABLE_MAX_ENTRIES) {
+            maxX = std::max(maxX, polarTable->GetMaxX());
+            maxY = std::max(maxY, polarTable->GetMaxY());
+        }
+        // anyone still using the old table keeps it until they are done
+        polarTable = std::make_shared<const PolarTable>(maxX, maxY);
+    }
+    return polarTable;
+}
+
 // generates a random number between num1 and num2 inclusive
 double RenderBuffer::RandomRange(double num1, double num2) const
 {
@@ -772,7 +880,7 @@ double RenderBuffer::RandomRange(double num1, double num2) const
         lo = num2;
         hi = num1;
     }
-    return rand01()*(hi-lo)+ lo;
+    return _random.Rand01()*(hi-lo)+ lo;
 }
 
 void RenderBuffer::Color2HSV(const xlColor& color, HSVValue& hsv) const
@@ -1245,7 +1353,7 @@ const xlColor& RenderBuffer::GetTempPixelRGB(int x, int y)
     return xlBLACK;
 }
 
-void RenderBuffer::SetState(int period, bool ResetState, const std::string& model_name)
+void RenderBuffer::SetState(int period, bool ResetState, const std::string& model_name, int layer)
 {
     if (ResetState) {
         needToInit = true;
@@ -1253,6 +1361,14 @@ void RenderBuffer::SetState(int period, bool ResetState, const std::string& mode
     curPeriod = period;
     cur_model = model_name;
     curPeriod = period;
+
+    // seed from things which are the same every render so the same frame always gets the same numbers
+    uint64_t seed = FNV1a(FNV1A_SEED, model_name);
+    for (uint32_t v : { (uint32_t)layer, (uint32_t)curEffStartPer, (uint32_t)period }) {
+        seed = FNV1a(seed, v);
+    }
+    _random.Seed(seed);
+
     palette.UpdateForProgress(GetEffectTimeIntervalPosition());
     dmx_buffer = false;
     Model* m = GetModel();
@@ -1409,6 +1525,7 @@ RenderBuffer::RenderBuffer(RenderBuffer& buffer) : pixelVector(buffer.pixels, &b
     fadeinsteps = buffer.fadeinsteps;
     fadeoutsteps = buffer.fadeoutsteps;
     needToInit = buffer.needToInit;
+    fromRenderCache = buffer.fromRenderCache;
     tempInt = buffer.tempInt;
     tempInt2 = buffer.tempInt2;
     allowAlpha = buffer.allowAlpha;
@@ -1417,6 +1534,7 @@ RenderBuffer::RenderBuffer(RenderBuffer& buffer) : pixelVector(buffer.pixels, &b
     BufferHt = buffer.BufferHt;
     BufferWi = buffer.BufferWi;
     infoCache = buffer.infoCache;
+    _random = buffer._random;
 
     pixels = &pixelVector[0];
     _textDrawingContext = buffer._textDrawingContext;
@@ -15,6 +15,8 @@
 #include <list>
 #include <vector>
 #include <atomic>
+#include <cmath>
+#include <memory>
 #include <wx/colour.h>
 #include <wx/dcclient.h>
 #include <wx/dcmemory.h>
@@ -394,10 +396,75 @@ public:
     }
 };
 
+// Small fast PCG32 generator used by effects instead of rand().
+//
+// rand() shares one locked state between all the render threads so results depended on how the threads
+// interleaved. Each render buffer has its own generator reseeded every frame so renders are repeatable.
+class RenderRandom {
+public:
+    void Seed(uint64_t seed) {
+        _state = 0;
+        Next();
+        _state += seed;
+        Next();
+    }
+    uint32_t Next() {
+        uint64_t old = _state;
+        _state = old * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+        uint32_t rot = (uint32_t)(old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+    // 0 to 0x7FFFFFFF like rand()
+    int Rand() { return (int)(Next() >> 1); }
+    // 0 to 1 not including 1
+    double Rand01() { return (double)Next() * (1.0 / 4294967296.0); }
+
+private:
+    uint64_t _state = 0x853c49e6748fea9bULL;
+};
+
+// Distance and angle of every integer offset from a centre point.
+//
+// Effects which work in polar coordinates (Pinwheel, Shockwave ...) look these up rather than calling hypot and
+// atan2 for every pixel every frame. The values are the doubles hypot and atan2 return so renders do not change.
+// Only offsets with dx >= 0 are stored (and dy >= 0 for the radius), the rest follow exactly by symmetry.
+class PolarTable {
+public:
+    PolarTable(int maxX, int maxY);
+    ~PolarTable();
+
+    int GetMaxX() const { return _maxX; }
+    int GetMaxY() const { return _maxY; }
+    size_t GetSize() const { return sizeof(double) * (_radius.size() + _angle.size()); }
+
+    // offsets must be within +/- GetMaxX(), GetMaxY()
+    double Radius(int dx, int dy) const {
+        return _radius[std::abs(dy) * _stride + std::abs(dx)];
+    }
+    // std::atan2(dx, dy) in radians
+    double Angle(int dx, int dy) const {
+        double a = _angle[(dy + _maxY) * _stride + std::abs(dx)];
+        return dx < 0 ? -a : a;
+    }
+
+private:
+    int _maxX;
+    int _maxY;
+    int _stride;
+    std::vector<double> _radius;
+    std::vector<double> _angle;
+};
+
 class /*NCCDLLEXPORT*/ EffectRenderCache {
 public:
 	EffectRenderCache();
 	virtual ~EffectRenderCache();
+
+    // Effects whose state carries from frame to frame return a copy of it so a render can resume part way
+    // through the effect. nullptr means the effect can only be rendered from its start.
+    virtual EffectRenderCache* Checkpoint() const { return nullptr; }
+    virtual size_t GetCheckpointSize() const { return 0; }
 };
 
 class /*NCCDLLEXPORT*/ RenderBuffer {
@@ -420,7 +487,12 @@ public:
     void SetAllowAlphaChannel(bool a);
     bool IsDmxBuffer() const { return dmx_buffer; }
 
-    void SetState(int period, bool reset, const std::string& model_name);
+    void SetState(int period, bool reset, const std::string& model_name, int layer);
+
+    // per buffer random numbers ... use these in effects rather than rand() and rand01()
+    int Rand() { return _random.Rand(); }
+    double Rand01() { return _random.Rand01(); }
+    RenderRandom& GetRandom() { return _random; }
 
     void SetEffectDuration(int startMsec, int endMsec);
     void GetEffectPeriods(int& curEffStartPer, int& curEffEndPer) const;  // nobody wants endPer?
@@ -463,6 +535,9 @@ public:
     static float cot(float rad) { return cos(rad) / sin(rad); }
     static float acot(float rad) { return M_PI/2.0 - atan(rad); }
 
+    // shared table covering offsets up to +/- maxX, maxY ... nullptr if that would be too big to be worth caching
+    static std::shared_ptr<const PolarTable> GetPolarTable(int maxX, int maxY);
+
     double calcAccel(double ratio, double accel);
 
     uint8_t ChannelBlend(uint8_t c1, uint8_t c2, float ratio);
@@ -500,6 +575,8 @@ private:
     xlColorVector tempbufVector;
     xlColor *pixels = nullptr;
     xlColor *tempbuf = nullptr;
+    size_t _accountedBytes = 0;
+    mutable RenderRandom _random;
 
     friend class MetalRenderBufferComputeData;
 public:
@@ -525,6 +602,7 @@ public:
     int fadeoutsteps = 0;
 
     bool needToInit = false;
+    bool fromRenderCache = false; // the frame was read back from the render cache so the effect state did not move on
     bool allowAlpha = false;
     bool dmx_buffer = false;
     bool _isCopy = false;
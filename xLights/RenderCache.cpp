@@ -22,6 +22,7 @@
 #include "UtilFunctions.h"
 #include "TraceLog.h"
 #include "ExternalHooks.h"
+#include "MemoryAccounting.h"
 
 #pragma region RenderCache
 
@@ -78,13 +79,43 @@ RenderCache::RenderCache()
 {
     _enabled = true;
 	_cacheFolder = "";
+
+    // cached frames which are already saved can be dropped and read back from disk
+    _reclaimerId = MemoryAccounting::RegisterReclaimer(MemoryAccounting::RENDER_CACHE, MemoryAccounting::COST_DISK_RELOAD,
+                                                       [this](size_t bytesWanted) { return SpillItems(bytesWanted); });
 }
 
 RenderCache::~RenderCache()
 {
+    MemoryAccounting::UnregisterReclaimer(_reclaimerId);
     Close();
 }
 
+void RenderCache::TrackItem(RenderCacheItem* item)
+{
+    std::unique_lock<std::mutex> lock(_itemsLock);
+    _items.push_back(item);
+}
+
+void RenderCache::UntrackItem(RenderCacheItem* item)
+{
+    std::unique_lock<std::mutex> lock(_itemsLock);
+    _items.remove(item);
+}
+
+size_t RenderCache::SpillItems(size_t bytesWanted)
+{
+    // this is called from whatever thread tripped the memory budget so never wait on anything
+    std::unique_lock<std::mutex> lock(_itemsLock, std::try_to_lock);
+    if (!lock.owns_lock()) return 0;
+
+    size_t freed = 0;
+    for (auto it = _items.begin(); it != _items.end() && freed < bytesWanted; ++it) {
+        freed += (*it)->Spill();
+    }
+    return freed;
+}
+
 void RenderCache::LoadCache()
 {
     // the thread self deletes so we dont need to track it
@@ -399,12 +430,13 @@ void RenderCache::Purge(SequenceElements* sequenceElements, bool dodelete)
 #pragma region RenderCacheItem
 RenderCacheItem::~RenderCacheItem()
 {
+    _renderCache->UntrackItem(this);
+    if (_pendingSave.valid()) _pendingSave.wait();
     PurgeFrames();
 }
 
-void RenderCacheItem::PurgeFrames()
+void RenderCacheItem::FreeFrames()
 {
-    _purged = true;
     for (auto& it : _frames)
     {
         for (int x = it.second.size() - 1; x >= 0; --x) {
@@ -414,6 +446,75 @@ void RenderCacheItem::PurgeFrames()
             }
         }
     }
+    MemoryAccounting::Remove(MemoryAccounting::RENDER_CACHE, _memoryBytes);
+    _memoryBytes = 0;
+}
+
+void RenderCacheItem::PurgeFrames()
+{
+    std::unique_lock<std::recursive_mutex> lock(_frameLock);
+    _purged = true;
+    _spilled = false;
+    FreeFrames();
+}
+
+size_t RenderCacheItem::Spill()
+{
+    std::unique_lock<std::recursive_mutex> lock(_frameLock, std::try_to_lock);
+    if (!lock.owns_lock()) return 0;
+
+    if (_purged || _spilled || _memoryBytes == 0) return 0;
+
+    // writing the file here would hold up whichever thread tripped the budget with all its locks held ... a fully
+    // rendered item is saved in the background instead and spilled on a later pass
+    if (_dirty) {
+        if (HasAllFrames() && (!_pendingSave.valid() || _pendingSave.wait_for(std::chrono::seconds(0)) == std::future_status::ready)) {
+            _pendingSave = std::async(std::launch::async, [this]() { Save(); });
+        }
+        return 0;
+    }
+
+    // only frames which match what is on disk can be dropped
+    if (_firstFrameOffset == 0) return 0;
+    if (!FileExists(_cacheFile)) return 0;
+
+    size_t freed = _memoryBytes;
+    FreeFrames();
+    _spilled = true;
+    return freed;
+}
+
+bool RenderCacheItem::Reload()
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    _spilled = false;
+
+    wxFile file;
+    if (!file.Open(_cacheFile) || file.Seek(_firstFrameOffset) == wxInvalidOffset) {
+        logger_base.warn("Render cache file %s could not be reloaded.", (const char*)_cacheFile.c_str());
+        PurgeFrames();
+        return false;
+    }
+
+    for (auto& itm : _frames)
+    {
+        long fs = _frameSize.at(itm.first);
+        for (int i = 0; i < itm.second.size(); i++) {
+            unsigned char* frameBuffer = (unsigned char *)malloc(fs);
+            if (frameBuffer == nullptr || file.Read(frameBuffer, fs) != fs)
+            {
+                free(frameBuffer);
+                logger_base.warn("Render cache file %s could not be reloaded.", (const char*)_cacheFile.c_str());
+                PurgeFrames();
+                return false;
+            }
+            itm.second[i] = frameBuffer;
+            _memoryBytes += fs;
+        }
+    }
+    MemoryAccounting::Add(MemoryAccounting::RENDER_CACHE, _memoryBytes);
+    return true;
 }
 
 std::string RenderCacheItem::GetModelName(RenderBuffer* buffer)
@@ -437,6 +538,7 @@ std::string RenderCacheItem::GetModelName(RenderBuffer* buffer)
 
 RenderCacheItem::RenderCacheItem(RenderCache* renderCache, Effect* effect, RenderBuffer* buffer) : _renderCache(renderCache)
 {
+    _renderCache->TrackItem(this);
     _purged = false;
     _dirty = true;
     std::string mname = GetModelName(buffer);
@@ -573,11 +675,27 @@ void RenderCacheItem::AddFrame(RenderBuffer* buffer)
         return;
     }
 
+    {
+        std::unique_lock<std::recursive_mutex> lock(_frameLock);
+        AddFrameLocked(buffer);
+    }
+    MemoryAccounting::CheckBudget();
+}
+
+void RenderCacheItem::AddFrameLocked(RenderBuffer* buffer)
+{
+    static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
     if (_purged)
     {
         return;
     }
 
+    if (_spilled && !Reload())
+    {
+        return;
+    }
+
     // allow up to 3 times physical memory
     // This means the render cache will be swapped out ... but I think that is still better than re-rendering
     if (IsExcessiveMemoryUsage(3.0))
@@ -630,6 +748,9 @@ void RenderCacheItem::AddFrame(RenderBuffer* buffer)
     if (_frames.at(mname)[frame] != nullptr) {
         free(_frames.at(mname)[frame]);
         _frames.at(mname)[frame] = nullptr;
+    } else {
+        _memoryBytes += _frameSize.at(mname);
+        MemoryAccounting::Add(MemoryAccounting::RENDER_CACHE, _frameSize.at(mname));
     }
 
     _frames.at(mname)[frame] = frameBuffer;
@@ -654,6 +775,7 @@ void RenderCacheItem::AddFrame(RenderBuffer* buffer)
 bool RenderCacheItem::GetFrame(RenderBuffer* buffer)
 {
     static log4cpp::Category& logger_rcache = log4cpp::Category::getInstance(std::string("log_rendercache"));
+    std::unique_lock<std::recursive_mutex> lock(_frameLock);
     std::string mname = GetModelName(buffer);
     if (_frameSize.find(mname) == _frameSize.end())
     {
@@ -661,13 +783,18 @@ bool RenderCacheItem::GetFrame(RenderBuffer* buffer)
         return false;
     }
 
-    auto modelFrames = _frames[mname];
     if (_frameSize.at(mname) != (sizeof(xlColor) * buffer->GetPixelCount()))
     {
         logger_rcache.info("RenderCache::GetFrame on model " + mname + " failed due to frame size difference.");
         return false;
     }
 
+    if (_spilled && !Reload())
+    {
+        return false;
+    }
+    const auto& modelFrames = _frames[mname];
+
     int frame = buffer->curPeriod - buffer->curEffStartPer;
 
     if (frame < modelFrames.size() && modelFrames[frame]) {
@@ -683,6 +810,7 @@ bool RenderCacheItem::GetFrame(RenderBuffer* buffer)
 
 void RenderCacheItem::Save()
 {
+    std::unique_lock<std::recursive_mutex> lock(_frameLock);
     if (_purged) return;
     if (!_dirty) return;
 
@@ -692,15 +820,7 @@ void RenderCacheItem::Save()
     char zero = 0x00;
 
     // check all the data is there
-    for (const auto& itm : _frames)
-    {
-        for (const auto& it : itm.second)
-        {
-            // we are missing data
-            //wxASSERT(false);
-            if (it == nullptr) return;
-        }
-    }
+    if (!HasAllFrames()) return;
 
     wxFile file;
 
@@ -730,16 +850,24 @@ void RenderCacheItem::Save()
         }
 
         // write the frames
+        bool ok = true;
+        long firstFrameOffset = file.Tell();
         for (const auto& itm : _frames)
         {
             for (const auto& it : itm.second)
             {
                 wxASSERT(it != nullptr);
-                file.Write(it, _frameSize.at(itm.first));
+                ok = file.Write(it, _frameSize.at(itm.first)) == (size_t)_frameSize.at(itm.first) && ok;
             }
         }
 
         file.Close();
+
+        if (ok)
+        {
+            _firstFrameOffset = firstFrameOffset;
+            _dirty = false;
+        }
     }
     else
     {
@@ -747,11 +875,26 @@ void RenderCacheItem::Save()
     }
 }
 
-bool RenderCacheItem::IsDone(RenderBuffer* buffer) const
+bool RenderCacheItem::HasAllFrames() const
+{
+    for (const auto& itm : _frames)
+    {
+        for (const auto& it : itm.second)
+        {
+            // we are missing data
+            if (it == nullptr) return false;
+        }
+    }
+    return true;
+}
+
+bool RenderCacheItem::IsDone(RenderBuffer* buffer)
 {
+    std::unique_lock<std::recursive_mutex> lock(_frameLock);
+    if (_spilled) return !_purged;
     int frame = buffer->curPeriod - buffer->curEffStartPer;
     std::string mname = GetModelName(buffer);
-    auto modelFrames = _frames.at(mname);
+    const auto& modelFrames = _frames.at(mname);
     return modelFrames[frame];
 }
 
@@ -759,6 +902,7 @@ RenderCacheItem::RenderCacheItem(RenderCache* renderCache, const std::string& fi
 {
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
 
+    _renderCache->TrackItem(this);
     _cacheFile = filename;
     wxFileName fn(_cacheFile);
     _purged = false;
@@ -815,6 +959,7 @@ RenderCacheItem::RenderCacheItem(RenderCache* renderCache, const std::string& fi
         long firstFrameOffset = ps - headerBuffer;
 
         file.Seek(firstFrameOffset);
+        _firstFrameOffset = firstFrameOffset;
 
         for (auto& itm : _frames)
         {
@@ -831,6 +976,8 @@ RenderCacheItem::RenderCacheItem(RenderCache* renderCache, const std::string& fi
 
                 file.Read(frameBuffer, _frameSize.at(itm.first));
                 itm.second[i] = frameBuffer;
+                _memoryBytes += _frameSize.at(itm.first);
+                MemoryAccounting::Add(MemoryAccounting::RENDER_CACHE, _frameSize.at(itm.first));
             }
         }
 
@@ -15,6 +15,7 @@
 #include <map>
 #include <vector>
 #include <mutex>
+#include <future>
 
 class Effect;
 class RenderCache;
@@ -29,9 +30,18 @@ class RenderCacheItem
     std::map<std::string, std::string> _properties;
     std::map<std::string, std::vector<unsigned char *>> _frames;
     std::map<std::string, long> _frameSize;
+    mutable std::recursive_mutex _frameLock;
     bool _purged;
     bool _dirty;
+    bool _spilled = false;
+    long _firstFrameOffset = 0;
+    size_t _memoryBytes = 0;
+    std::future<void> _pendingSave;
     static std::string GetModelName(RenderBuffer* buffer);
+    bool HasAllFrames() const;
+    void FreeFrames();
+    bool Reload();
+    void AddFrameLocked(RenderBuffer* buffer);
 
 public:
     RenderCacheItem(RenderCache* renderCache, const std::string& file);
@@ -44,8 +54,11 @@ public:
     bool IsMatch(Effect* effect, RenderBuffer* buffer);
     void Delete();
     void Save();
-    bool IsDone(RenderBuffer* buffer) const;
+    bool IsDone(RenderBuffer* buffer);
     const std::string& Description() const { return _cacheFile; }
+
+    // release the frames if they are safely on disk ... they are read back on next use
+    size_t Spill();
 };
 
 class RenderCache
@@ -55,8 +68,12 @@ class RenderCache
 	std::list<RenderCacheItem*> _cache;
     std::string _enabled; // Disabled | Locked Only | Enabled
     std::mutex _loadMutex;
+    int _reclaimerId = 0;
+    std::mutex _itemsLock;
+    std::list<RenderCacheItem*> _items;
 
     void Close();
+    size_t SpillItems(size_t bytesWanted);
     void LoadCache();
 
     public:
@@ -73,4 +90,6 @@ class RenderCache
         std::mutex& GetLoadMutex() { return _loadMutex; }
         void AddCacheItem(RenderCacheItem* rci);
         bool IsEffectOkForCaching(Effect* effect) const;
+        void TrackItem(RenderCacheItem* item);
+        void UntrackItem(RenderCacheItem* item);
 };
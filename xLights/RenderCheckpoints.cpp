@@ -0,0 +1,219 @@
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include "RenderCheckpoints.h"
+#include "RenderBuffer.h"
+#include "PixelBuffer.h"
+#include "MemoryAccounting.h"
+#include "sequencer/Effect.h"
+#include "UtilFunctions.h"
+
+#include <algorithm>
+
+RenderBufferCheckpoint::~RenderBufferCheckpoint()
+{
+    if (_cache != nullptr) {
+        delete _cache;
+        _cache = nullptr;
+    }
+}
+
+bool RenderBufferCheckpoint::Save(RenderBuffer& buffer, int cacheId)
+{
+    if (buffer.fromRenderCache) {
+        return false;
+    }
+    auto it = buffer.infoCache.find(cacheId);
+    if (it == buffer.infoCache.end() || it->second == nullptr) {
+        return false;
+    }
+    _cache = it->second->Checkpoint();
+    if (_cache == nullptr) {
+        return false;
+    }
+
+    // some effects build on what they drew last frame
+    _pixels.assign(buffer.GetPixels(), buffer.GetPixels() + buffer.GetPixelCount());
+    _tempbuf.assign(buffer.GetTempBuf(), buffer.GetTempBuf() + buffer.GetPixelCount());
+    _tempInt = buffer.tempInt;
+    _tempInt2 = buffer.tempInt2;
+    _bytes = sizeof(RenderBufferCheckpoint) + _cache->GetCheckpointSize() + sizeof(xlColor) * (_pixels.size() + _tempbuf.size());
+    return true;
+}
+
+void RenderBufferCheckpoint::Restore(RenderBuffer& buffer, int cacheId) const
+{
+    EffectRenderCache*& cache = buffer.infoCache[cacheId];
+    if (cache != nullptr) {
+        delete cache;
+    }
+    // the snapshot may be restored again so the buffer gets its own copy
+    cache = _cache->Checkpoint();
+
+    if (_pixels.size() == buffer.GetPixelCount()) {
+        std::copy(_pixels.begin(), _pixels.end(), buffer.GetPixels());
+        std::copy(_tempbuf.begin(), _tempbuf.end(), buffer.GetTempBuf());
+    }
+    buffer.tempInt = _tempInt;
+    buffer.tempInt2 = _tempInt2;
+    buffer.needToInit = false;
+}
+
+RenderCheckpoints::RenderCheckpoints()
+{
+    _reclaimerId = MemoryAccounting::RegisterReclaimer(MemoryAccounting::EFFECT_CACHES, MemoryAccounting::COST_RERENDER,
+                                                       [this](size_t bytesWanted) { return Reclaim(bytesWanted); });
+}
+
+RenderCheckpoints::~RenderCheckpoints()
+{
+    MemoryAccounting::UnregisterReclaimer(_reclaimerId);
+    Clear();
+}
+
+uint64_t RenderCheckpoints::GetFingerprint(Effect* effect, int layer, PixelBufferClass& buffer)
+{
+    uint64_t h = FNV1a(FNV1A_SEED, effect->GetSettingsAsString());
+    h = FNV1a(h, effect->GetPaletteAsString());
+    uint32_t cnt = buffer.BufferCountForLayer(layer);
+    for (uint32_t v : { (uint32_t)effect->GetStartTimeMS(), (uint32_t)effect->GetEndTimeMS(), (uint32_t)buffer.GetFrameTimeInMS(), cnt }) {
+        h = FNV1a(h, v);
+    }
+    for (uint32_t i = 0; i < cnt; i++) {
+        RenderBuffer& rb = buffer.BufferForLayer(layer, i);
+        h = FNV1a(h, (uint32_t)rb.BufferWi);
+        h = FNV1a(h, (uint32_t)rb.BufferHt);
+    }
+    return h;
+}
+
+RenderCheckpoints::Key RenderCheckpoints::GetKey(Effect* effect, int layer, PixelBufferClass& buffer)
+{
+    return Key(buffer.GetModelName(), layer, effect->GetID());
+}
+
+void RenderCheckpoints::Save(Effect* effect, int layer, int frame, PixelBufferClass& buffer)
+{
+    if (effect == nullptr || effect->GetEffectIndex() < 0 || buffer.GetFrameTimeInMS() <= 0) {
+        return;
+    }
+    int interval = std::max(1, CHECKPOINT_INTERVAL_MS / buffer.GetFrameTimeInMS());
+    int startFrame = effect->GetStartTimeMS() / buffer.GetFrameTimeInMS();
+    if (frame <= startFrame || (frame - startFrame) % interval != 0) {
+        return;
+    }
+
+    Checkpoint checkpoint;
+    size_t bytes = 0;
+    uint32_t cnt = buffer.BufferCountForLayer(layer);
+    for (uint32_t i = 0; i < cnt; i++) {
+        std::unique_ptr<RenderBufferCheckpoint> b = std::make_unique<RenderBufferCheckpoint>();
+        if (!b->Save(buffer.BufferForLayer(layer, i), effect->GetEffectIndex())) {
+            return;
+        }
+        bytes += b->GetSize();
+        checkpoint.push_back(std::move(b));
+    }
+
+    // snapshots only save time ... they are not worth pushing out anything else
+    if (MemoryAccounting::WouldExceedBudget(bytes)) {
+        return;
+    }
+
+    uint64_t fingerprint = GetFingerprint(effect, layer, buffer);
+    {
+        std::unique_lock<std::mutex> locker(_lock);
+        EffectCheckpoints& ec = _checkpoints[GetKey(effect, layer, buffer)];
+        if (ec.fingerprint != fingerprint) {
+            Remove(ec);
+            ec.fingerprint = fingerprint;
+        }
+        auto it = ec.frames.find(frame);
+        if (it != ec.frames.end()) {
+            for (const auto& b : it->second) {
+                _bytes -= b->GetSize();
+                MemoryAccounting::Remove(MemoryAccounting::EFFECT_CACHES, b->GetSize());
+            }
+        }
+        ec.frames[frame] = std::move(checkpoint);
+        _bytes += bytes;
+        MemoryAccounting::Add(MemoryAccounting::EFFECT_CACHES, bytes);
+    }
+}
+
+int RenderCheckpoints::Restore(Effect* effect, int layer, int frame, PixelBufferClass& buffer)
+{
+    if (effect == nullptr || effect->GetEffectIndex() < 0) {
+        return -1;
+    }
+    uint64_t fingerprint = GetFingerprint(effect, layer, buffer);
+
+    std::unique_lock<std::mutex> locker(_lock);
+    auto ec = _checkpoints.find(GetKey(effect, layer, buffer));
+    if (ec == _checkpoints.end()) {
+        return -1;
+    }
+    if (ec->second.fingerprint != fingerprint) {
+        // the effect has changed so these are no use to anyone
+        Remove(ec->second);
+        _checkpoints.erase(ec);
+        return -1;
+    }
+
+    auto it = ec->second.frames.upper_bound(frame);
+    if (it == ec->second.frames.begin()) {
+        return -1;
+    }
+    --it;
+    if (it->second.size() != buffer.BufferCountForLayer(layer)) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < it->second.size(); i++) {
+        it->second[i]->Restore(buffer.BufferForLayer(layer, i), effect->GetEffectIndex());
+    }
+    return it->first;
+}
+
+void RenderCheckpoints::Remove(EffectCheckpoints& checkpoints)
+{
+    for (const auto& it : checkpoints.frames) {
+        for (const auto& b : it.second) {
+            _bytes -= b->GetSize();
+            MemoryAccounting::Remove(MemoryAccounting::EFFECT_CACHES, b->GetSize());
+        }
+    }
+    checkpoints.frames.clear();
+}
+
+void RenderCheckpoints::Clear()
+{
+    std::unique_lock<std::mutex> locker(_lock);
+    for (auto& it : _checkpoints) {
+        Remove(it.second);
+    }
+    _checkpoints.clear();
+}
+
+size_t RenderCheckpoints::Reclaim(size_t bytesWanted)
+{
+    std::unique_lock<std::mutex> locker(_lock, std::try_to_lock);
+    if (!locker.owns_lock()) {
+        return 0;
+    }
+    size_t freed = 0;
+    auto it = _checkpoints.begin();
+    while (it != _checkpoints.end() && freed < bytesWanted) {
+        size_t before = _bytes;
+        Remove(it->second);
+        freed += before - _bytes;
+        it = _checkpoints.erase(it);
+    }
+    return freed;
+}
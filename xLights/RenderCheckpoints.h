@@ -0,0 +1,90 @@
+#pragma once
+
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "Color.h"
+
+class Effect;
+class EffectRenderCache;
+class PixelBufferClass;
+class RenderBuffer;
+
+// The state of one render buffer part way through a stateful effect
+class RenderBufferCheckpoint
+{
+public:
+    RenderBufferCheckpoint() {}
+    ~RenderBufferCheckpoint();
+
+    // false if the effect keeps no state which can be copied
+    bool Save(RenderBuffer& buffer, int cacheId);
+    void Restore(RenderBuffer& buffer, int cacheId) const;
+    size_t GetSize() const { return _bytes; }
+
+private:
+    EffectRenderCache* _cache = nullptr;
+    std::vector<xlColor> _pixels;
+    std::vector<xlColor> _tempbuf;
+    int _tempInt = 0;
+    int _tempInt2 = 0;
+    size_t _bytes = 0;
+};
+
+// Snapshots of stateful effects (Fire, Meteors, Life ...) taken every few seconds while they render.
+//
+// Effects which cannot render an arbitrary part of their time interval normally restart at whatever frame a partial
+// render begins on. With a snapshot the render restores the state from the nearest earlier snapshot and replays just
+// the frames in between. Snapshots are keyed by model, layer and effect and are discarded if the effect, its palette
+// or the buffer size has changed since they were taken.
+class RenderCheckpoints
+{
+public:
+    static const int CHECKPOINT_INTERVAL_MS = 5000;
+
+    RenderCheckpoints();
+    virtual ~RenderCheckpoints();
+
+    // take a snapshot if frame is one of the effect's checkpoint frames
+    void Save(Effect* effect, int layer, int frame, PixelBufferClass& buffer);
+
+    // restores the latest snapshot at or before frame returning the frame it was taken on or -1 if there is none
+    int Restore(Effect* effect, int layer, int frame, PixelBufferClass& buffer);
+
+    void Clear();
+    size_t GetSize() const { return _bytes; }
+
+private:
+    typedef std::vector<std::unique_ptr<RenderBufferCheckpoint>> Checkpoint;
+    struct EffectCheckpoints
+    {
+        uint64_t fingerprint = 0;
+        std::map<int, Checkpoint> frames;
+    };
+    typedef std::tuple<std::string, int, int> Key;
+
+    std::mutex _lock;
+    std::map<Key, EffectCheckpoints> _checkpoints;
+    size_t _bytes = 0;
+    int _reclaimerId = 0;
+
+    static uint64_t GetFingerprint(Effect* effect, int layer, PixelBufferClass& buffer);
+    static Key GetKey(Effect* effect, int layer, PixelBufferClass& buffer);
+    void Remove(EffectCheckpoints& checkpoints);
+    size_t Reclaim(size_t bytesWanted);
+};
@@ -103,6 +103,7 @@ void xLightsFrame::NewSequence(const std::string& media, uint32_t durationMS)
     wxFileName xml_file;
     xml_file.SetPath(CurrentDir);
     CurrentSeqXmlFile = new xLightsXmlFile(xml_file);
+    CurrentSeqXmlFile->SetLoadCacheFolder(renderCacheDirectory);
 
     if (_modelBlendDefaultOff) {
         CurrentSeqXmlFile->setSupportsModelBlending(false);
@@ -161,15 +162,15 @@ void xLightsFrame::NewSequence(const std::string& media, uint32_t durationMS)
     memRequired *= max;
     memRequired /= 1024; // ->kb
     memRequired /= 1024; // ->mb
-    if (memRequired > (GetPhysicalMemorySizeMB() - 1024) && (_promptBatchRenderIssues || (!_renderMode && !_checkSequenceMode))) {
+    if (memRequired > (GetPhysicalMemorySizeMB() - 1024) && !SequenceData::WillUseDiskBacking(memRequired * 1024 * 1024) && (_promptBatchRenderIssues || (!_renderMode && !_checkSequenceMode))) {
         DisplayWarning(wxString::Format("The setup requires a large amount of memory (%lu MB) which could result in performance issues.",          (unsigned long)memRequired), this);
     }
 
     if ((max > _seqData.NumChannels()) ||
         (CurrentSeqXmlFile->GetSequenceDurationMS() / ms) > (long)_seqData.NumFrames()) {
-        _seqData.init(max, mMediaLengthMS / ms, ms);
+        InitSequenceData(mMediaLengthMS / ms, ms);
     } else {
-        _seqData.init(max, CurrentSeqXmlFile->GetSequenceDurationMS() / ms, ms);
+        InitSequenceData(CurrentSeqXmlFile->GetSequenceDurationMS() / ms, ms);
     }
 
     // we can render now the sequence data buffers are initialised
@@ -362,6 +363,7 @@ void xLightsFrame::OpenSequence(const wxString passed_filename, ConvertLogDialog
 
         // assign global xml file object
         CurrentSeqXmlFile = new xLightsXmlFile(xml_file);
+        CurrentSeqXmlFile->SetLoadCacheFolder(renderCacheDirectory);
 
         // open the xml file so we can see if it has media
         CurrentSeqXmlFile->Open(GetShowDirectory());
@@ -488,7 +490,7 @@ void xLightsFrame::OpenSequence(const wxString passed_filename, ConvertLogDialog
         memRequired *= numChan;
         memRequired /= 1024; // ->kb
         memRequired /= 1024; // ->mb
-        if (memRequired > (GetPhysicalMemorySizeMB() - 1024) && (_promptBatchRenderIssues || (!_renderMode && !_checkSequenceMode))) {
+        if (memRequired > (GetPhysicalMemorySizeMB() - 1024) && !SequenceData::WillUseDiskBacking(memRequired * 1024 * 1024) && (_promptBatchRenderIssues || (!_renderMode && !_checkSequenceMode))) {
             DisplayWarning(wxString::Format("The setup requires a large amount of memory (%lu MB) which could result in performance issues.", (unsigned long)memRequired), this);
         }
 
@@ -511,9 +513,9 @@ void xLightsFrame::OpenSequence(const wxString passed_filename, ConvertLogDialog
                     }
                 }
             }
-            _seqData.init(numChan, mMediaLengthMS / ms, ms);
+            InitSequenceData(mMediaLengthMS / ms, ms);
         } else if( !loaded_fseq ) {
-            _seqData.init(numChan, CurrentSeqXmlFile->GetSequenceDurationMS() / ms, ms);
+            InitSequenceData(CurrentSeqXmlFile->GetSequenceDurationMS() / ms, ms);
         }
 
         displayElementsPanel->Initialize();
@@ -621,6 +623,7 @@ bool xLightsFrame::CloseSequence()
 
     _renderCache.CleanupCache(&_sequenceElements);
     _renderCache.SetSequence(renderCacheDirectory, "");
+    _renderCheckpoints.Clear();
 
     // clear everything to prepare for new sequence
     if (displayElementsPanel != nullptr) displayElementsPanel->Clear();
@@ -0,0 +1,536 @@
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <wx/wx.h>
+#include <wx/file.h>
+#include <wx/filename.h>
+#include <wx/mstream.h>
+#include <wx/xml/xml.h>
+
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+#include "SequenceCache.h"
+#include "UtilFunctions.h"
+#include "xLightsVersion.h"
+#include "../common/xlBaseApp.h"
+
+#include <log4cpp/Category.hh>
+
+// bump this whenever the layout of the file or of the cached structures changes
+#define SEQUENCE_CACHE_FORMAT 2
+#define SEQUENCE_CACHE_MAGIC "XSQC"
+
+bool SequenceCache::_enabled = true;
+std::atomic<uint64_t> SequenceCache::_generation(0);
+std::mutex SequenceCache::_writeLock;
+
+namespace
+{
+    // Collects the tables while walking the document
+    class SequenceCacheBuilder
+    {
+    public:
+        std::vector<uint32_t> stringOffsets = { 0 };
+        std::vector<char> strings;
+        std::vector<int32_t> effectDB;
+        std::vector<SequenceCache::CachedElement> elements;
+        std::vector<SequenceCache::CachedLayer> layers;
+        std::vector<SequenceCache::CachedEffect> effects;
+
+        int32_t Intern(const std::string& s)
+        {
+            auto it = _interned.find(s);
+            if (it != _interned.end()) return it->second;
+            int32_t index = (int32_t)_interned.size();
+            strings.insert(strings.end(), s.begin(), s.end());
+            stringOffsets.push_back((uint32_t)strings.size());
+            _interned[s] = index;
+            return index;
+        }
+
+        int32_t InternAttribute(wxXmlNode* node, const wxString& name, bool trim)
+        {
+            wxString value;
+            if (!node->GetAttribute(name, &value) || value == "") return -1;
+            if (trim) value.Trim(true).Trim(false);
+            return Intern(value.ToStdString());
+        }
+
+        // Mirrors what SequenceElements::LoadEffects pulls out of each Effect node
+        void AddEffects(SequenceCache::CachedLayer& layer, wxXmlNode* layerNode, bool timing)
+        {
+            layer.firstEffect = (uint32_t)effects.size();
+            for (wxXmlNode* effect = layerNode->GetChildren(); effect != nullptr; effect = effect->GetNext()) {
+                if (effect->GetName() != "Effect") continue;
+
+                SequenceCache::CachedEffect ce{};
+                ce.startTime = 0;
+                ce.endTime = 0;
+                effect->GetAttribute("startTime").ToDouble(&ce.startTime);
+                effect->GetAttribute("endTime").ToDouble(&ce.endTime);
+                ce.isProtected = effect->GetAttribute("protected") == '1' ? 1 : 0;
+                ce.id = 0;
+                ce.ref = -1;
+                ce.settings = -1;
+                ce.palette = -1;
+                if (timing) {
+                    ce.name = Intern(UnXmlSafe(effect->GetAttribute("label")));
+                }
+                else {
+                    ce.name = Intern(effect->GetAttribute("name").ToStdString());
+                    ce.id = wxAtoi(effect->GetAttribute("id", "0"));
+                    if (effect->GetAttribute("ref") != "") {
+                        ce.ref = wxAtoi(effect->GetAttribute("ref"));
+                    }
+                    else {
+                        ce.settings = Intern(ToStdString(effect->GetNodeContent()));
+                    }
+                    wxString tmp;
+                    if (effect->GetAttribute("palette", &tmp)) {
+                        long palette = -1;
+                        tmp.ToLong(&palette);
+                        ce.palette = palette;
+                    }
+                }
+                effects.push_back(ce);
+            }
+            layer.effectCount = (uint32_t)effects.size() - layer.firstEffect;
+        }
+
+        void AddLayer(SequenceCache::LayerType type, int32_t index, int32_t layerNum, int32_t name, wxXmlNode* layerNode, bool timing)
+        {
+            SequenceCache::CachedLayer layer{};
+            layer.type = type;
+            layer.index = index;
+            layer.layer = layerNum;
+            layer.name = name;
+            AddEffects(layer, layerNode, timing);
+            layers.push_back(layer);
+        }
+
+        // Mirrors the layer handling in SequenceElements::LoadElementEffects ... names are stored already trimmed
+        void AddElement(wxXmlNode* elementNode)
+        {
+            SequenceCache::CachedElement element;
+            element.firstLayer = (uint32_t)layers.size();
+            bool timing = elementNode->GetAttribute("type") == "timing";
+            for (wxXmlNode* layerNode = elementNode->GetChildren(); layerNode != nullptr; layerNode = layerNode->GetNext()) {
+                if (layerNode->GetName() == "EffectLayer") {
+                    AddLayer(SequenceCache::LayerType::EFFECT_LAYER, 0, 0, -1, layerNode, timing);
+                }
+                else if (layerNode->GetName() == "SubModelEffectLayer") {
+                    AddLayer(SequenceCache::LayerType::SUBMODEL_LAYER, 0, wxAtoi(layerNode->GetAttribute("layer", "0")),
+                             Intern(layerNode->GetAttribute("name").Trim(true).Trim(false).ToStdString()), layerNode, timing);
+                }
+                else {
+                    int32_t strand = wxAtoi(layerNode->GetAttribute("index"));
+                    AddLayer(SequenceCache::LayerType::STRAND_LAYER, strand, wxAtoi(layerNode->GetAttribute("layer", "0")),
+                             InternAttribute(layerNode, "name", true), layerNode, timing);
+                    if (layerNode->GetName() == "Strand") {
+                        for (wxXmlNode* node = layerNode->GetChildren(); node != nullptr; node = node->GetNext()) {
+                            if (node->GetName() == "Node") {
+                                AddLayer(SequenceCache::LayerType::NODE_LAYER, strand, wxAtoi(node->GetAttribute("index")),
+                                         InternAttribute(node, "name", false), node, timing);
+                            }
+                        }
+                    }
+                }
+            }
+            element.layerCount = (uint32_t)layers.size() - element.firstLayer;
+            elements.push_back(element);
+        }
+
+    private:
+        std::unordered_map<std::string, int32_t> _interned;
+    };
+
+    template<class T>
+    void AppendPOD(std::vector<uint8_t>& out, const T& value)
+    {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&value);
+        out.insert(out.end(), p, p + sizeof(T));
+    }
+
+    template<class T>
+    void AppendVector(std::vector<uint8_t>& out, const std::vector<T>& values)
+    {
+        AppendPOD(out, (uint32_t)values.size());
+        if (!values.empty()) {
+            const uint8_t* p = reinterpret_cast<const uint8_t*>(values.data());
+            out.insert(out.end(), p, p + values.size() * sizeof(T));
+        }
+    }
+
+    // layers and effects have padding in them so they go a field at a time ... the same sequence always gives the same file
+    void AppendLayer(std::vector<uint8_t>& out, const SequenceCache::CachedLayer& l)
+    {
+        AppendPOD(out, l.type);
+        AppendPOD(out, l.index);
+        AppendPOD(out, l.layer);
+        AppendPOD(out, l.name);
+        AppendPOD(out, l.firstEffect);
+        AppendPOD(out, l.effectCount);
+    }
+
+    void AppendEffect(std::vector<uint8_t>& out, const SequenceCache::CachedEffect& e)
+    {
+        AppendPOD(out, e.startTime);
+        AppendPOD(out, e.endTime);
+        AppendPOD(out, e.id);
+        AppendPOD(out, e.name);
+        AppendPOD(out, e.ref);
+        AppendPOD(out, e.settings);
+        AppendPOD(out, e.palette);
+        AppendPOD(out, e.isProtected);
+    }
+
+    template<class T, class F>
+    void AppendRecords(std::vector<uint8_t>& out, const std::vector<T>& values, F&& append)
+    {
+        AppendPOD(out, (uint32_t)values.size());
+        for (const auto& v : values) {
+            append(out, v);
+        }
+    }
+
+    // Bounds checked reader over the bytes of the cache file
+    class CacheReader
+    {
+    public:
+        CacheReader(const std::vector<uint8_t>& data) : _data(data) {}
+
+        template<class T>
+        bool Read(T& value)
+        {
+            if (_pos + sizeof(T) > _data.size()) return false;
+            memcpy(&value, &_data[_pos], sizeof(T));
+            _pos += sizeof(T);
+            return true;
+        }
+
+        template<class T>
+        bool ReadVector(std::vector<T>& values)
+        {
+            uint32_t count = 0;
+            if (!Read(count)) return false;
+            if (_pos + (size_t)count * sizeof(T) > _data.size()) return false;
+            values.resize(count);
+            if (count != 0) {
+                memcpy(values.data(), &_data[_pos], (size_t)count * sizeof(T));
+            }
+            _pos += (size_t)count * sizeof(T);
+            return true;
+        }
+
+        // count records of at least minSize bytes each read by read(record)
+        template<class T, class F>
+        bool ReadRecords(std::vector<T>& values, size_t minSize, F&& read)
+        {
+            uint32_t count = 0;
+            if (!Read(count)) return false;
+            if (_pos + (size_t)count * minSize > _data.size()) return false;
+            values.resize(count);
+            for (auto& v : values) {
+                if (!read(*this, v)) return false;
+            }
+            return true;
+        }
+
+        bool ReadLayer(SequenceCache::CachedLayer& l)
+        {
+            return Read(l.type) && Read(l.index) && Read(l.layer) && Read(l.name) && Read(l.firstEffect) && Read(l.effectCount);
+        }
+
+        bool ReadEffect(SequenceCache::CachedEffect& e)
+        {
+            return Read(e.startTime) && Read(e.endTime) && Read(e.id) && Read(e.name) && Read(e.ref) && Read(e.settings) &&
+                   Read(e.palette) && Read(e.isProtected);
+        }
+
+        bool ReadString(std::string& s)
+        {
+            std::vector<char> chars;
+            if (!ReadVector(chars)) return false;
+            s.assign(chars.begin(), chars.end());
+            return true;
+        }
+
+    private:
+        const std::vector<uint8_t>& _data;
+        size_t _pos = 0;
+    };
+}
+
+std::string SequenceCache::GetCacheFile(const std::string& folder, const std::string& sequenceName)
+{
+    return folder + wxFileName::GetPathSeparator() + "RenderCache" + wxFileName::GetPathSeparator() + sequenceName + ".xsqcache";
+}
+
+// FNV-1a over 64 bit words ... we only need to notice the file changed, not resist tampering
+bool SequenceCache::HashFile(const std::string& filename, uint64_t& hash, uint64_t& size)
+{
+    wxFile file;
+    if (!file.Open(filename)) return false;
+
+    size = file.Length();
+    hash = FNV1A_SEED;
+
+    std::vector<uint8_t> buffer(4 * 1024 * 1024);
+    ssize_t read = 0;
+    while ((read = file.Read(buffer.data(), buffer.size())) > 0) {
+        hash = FNV1aWords(hash, buffer.data(), read);
+    }
+    file.Close();
+    return read >= 0;
+}
+
+std::vector<uint8_t> SequenceCache::Build(wxXmlDocument& doc)
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    std::vector<uint8_t> out;
+    wxXmlNode* root = doc.GetRoot();
+    if (root == nullptr) return out;
+
+    wxXmlNode* effectDBNode = nullptr;
+    wxXmlNode* elementEffectsNode = nullptr;
+    for (wxXmlNode* e = root->GetChildren(); e != nullptr; e = e->GetNext()) {
+        if (e->GetName() == "EffectDB") {
+            effectDBNode = e;
+        }
+        else if (e->GetName() == "ElementEffects") {
+            elementEffectsNode = e;
+        }
+        else if (e->GetName() == "CompressedData") {
+            // only snapshot documents which have been expanded
+            return out;
+        }
+    }
+    if (elementEffectsNode == nullptr) return out;
+
+    wxStopWatch sw;
+
+    SequenceCacheBuilder builder;
+    if (effectDBNode != nullptr) {
+        for (wxXmlNode* n = effectDBNode->GetChildren(); n != nullptr; n = n->GetNext()) {
+            if (n->GetName() == "Effect") {
+                builder.effectDB.push_back(builder.Intern(ToStdString(n->GetNodeContent())));
+            }
+        }
+    }
+
+    // The shell keeps the attributes of every element so the model and timing lists still come from the xml.
+    // Fixed timing tracks are tiny and get generated rather than loaded so they are kept whole.
+    wxXmlNode* elementEffectsShell = new wxXmlNode(wxXML_ELEMENT_NODE, "ElementEffects");
+    for (wxXmlNode* element = elementEffectsNode->GetChildren(); element != nullptr; element = element->GetNext()) {
+        if (element->GetName() != "Element") continue;
+
+        if (element->GetAttribute("type") == "timing" && wxAtoi(element->GetAttribute("fixed", "0")) > 0) {
+            elementEffectsShell->AddChild(new wxXmlNode(*element));
+            SequenceCache::CachedElement ce = { (uint32_t)builder.layers.size(), 0 };
+            builder.elements.push_back(ce);
+        }
+        else {
+            wxXmlNode* shell = new wxXmlNode(wxXML_ELEMENT_NODE, "Element");
+            for (wxXmlAttribute* attr = element->GetAttributes(); attr != nullptr; attr = attr->GetNext()) {
+                shell->AddAttribute(attr->GetName(), attr->GetValue());
+            }
+            elementEffectsShell->AddChild(shell);
+            builder.AddElement(element);
+        }
+    }
+    wxXmlNode* effectDBShell = new wxXmlNode(wxXML_ELEMENT_NODE, "EffectDB");
+
+    // swap the shells in just long enough to write out the rest of the document
+    root->InsertChildAfter(elementEffectsShell, elementEffectsNode);
+    root->RemoveChild(elementEffectsNode);
+    if (effectDBNode != nullptr) {
+        root->InsertChildAfter(effectDBShell, effectDBNode);
+        root->RemoveChild(effectDBNode);
+    }
+    wxMemoryOutputStream xmlOut;
+    doc.Save(xmlOut, wxXML_NO_INDENTATION);
+    root->InsertChildAfter(elementEffectsNode, elementEffectsShell);
+    root->RemoveChild(elementEffectsShell);
+    delete elementEffectsShell;
+    if (effectDBNode != nullptr) {
+        root->InsertChildAfter(effectDBNode, effectDBShell);
+        root->RemoveChild(effectDBShell);
+    }
+    delete effectDBShell;
+
+    out.reserve(xmlOut.GetOutputStreamBuffer()->Tell() + builder.strings.size() +
+                builder.effects.size() * sizeof(CachedEffect) + builder.layers.size() * sizeof(CachedLayer) + 1024);
+    std::string version = xlights_version_string.ToStdString();
+    AppendVector(out, std::vector<char>(version.begin(), version.end()));
+    const char* xml = (const char*)xmlOut.GetOutputStreamBuffer()->GetBufferStart();
+    AppendVector(out, std::vector<char>(xml, xml + xmlOut.GetOutputStreamBuffer()->Tell()));
+    AppendVector(out, builder.stringOffsets);
+    AppendVector(out, builder.strings);
+    AppendVector(out, builder.effectDB);
+    AppendVector(out, builder.elements);
+    AppendRecords(out, builder.layers, AppendLayer);
+    AppendRecords(out, builder.effects, AppendEffect);
+
+    logger_base.debug("SequenceCache: Built snapshot, %d elements, %d layers, %d effects, %d strings, %dKB in %ldms.",
+                      (int)builder.elements.size(), (int)builder.layers.size(), (int)builder.effects.size(),
+                      (int)builder.stringOffsets.size() - 1, (int)(out.size() / 1024), sw.Time());
+    return out;
+}
+
+bool SequenceCache::Write(const std::string& cacheFile, uint64_t hash, uint64_t size, const std::vector<uint8_t>& snapshot)
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    if (snapshot.empty()) return false;
+
+    std::vector<uint8_t> header;
+    header.insert(header.end(), SEQUENCE_CACHE_MAGIC, SEQUENCE_CACHE_MAGIC + 4);
+    AppendPOD(header, (uint32_t)SEQUENCE_CACHE_FORMAT);
+    AppendPOD(header, hash);
+    AppendPOD(header, size);
+
+    wxFileName fn(cacheFile);
+    if (!wxDirExists(fn.GetPath()) && !wxFileName::Mkdir(fn.GetPath(), wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)) {
+        logger_base.warn("SequenceCache: Unable to create folder %s.", (const char*)fn.GetPath().c_str());
+        return false;
+    }
+
+    // write to a temporary file first so a partially written cache is never picked up
+    wxString tmpFile = cacheFile + ".tmp";
+    wxFile f;
+    if (!f.Create(tmpFile, true) || f.Write(header.data(), header.size()) != header.size() ||
+        f.Write(snapshot.data(), snapshot.size()) != snapshot.size()) {
+        logger_base.warn("SequenceCache: Unable to write %s.", (const char*)tmpFile.c_str());
+        f.Close();
+        wxRemoveFile(tmpFile);
+        return false;
+    }
+    f.Close();
+    if (!wxRenameFile(tmpFile, cacheFile, true)) {
+        wxRemoveFile(tmpFile);
+        return false;
+    }
+
+    logger_base.debug("SequenceCache: Wrote %s.", (const char*)cacheFile.c_str());
+    return true;
+}
+
+void SequenceCache::SequenceFileChanging()
+{
+    ++_generation;
+}
+
+void SequenceCache::WriteInBackground(const std::string& cacheFile, const std::string& sequenceFile, std::vector<uint8_t>&& snapshot)
+{
+    if (snapshot.empty()) return;
+
+    uint64_t generation = ++_generation;
+    std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>(std::move(snapshot));
+    std::thread th([cacheFile, sequenceFile, data, generation]() {
+        try
+        {
+            xlCrashHandler::SetupCrashHandlerForNonWxThread();
+            std::unique_lock<std::mutex> lock(_writeLock);
+
+            // a later snapshot replaces this one ... and if the file changed while it was being hashed the hash
+            // would not be of the document the snapshot came from
+            uint64_t hash = 0;
+            uint64_t size = 0;
+            if (generation != _generation || !HashFile(sequenceFile, hash, size) || generation != _generation) return;
+            Write(cacheFile, hash, size, *data);
+        }
+        catch (...)
+        {
+            wxTheApp->OnUnhandledException();
+        }
+    });
+    th.detach();
+}
+
+SequenceCache* SequenceCache::Read(const std::string& cacheFile, uint64_t hash, uint64_t size)
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    if (!wxFileExists(cacheFile)) return nullptr;
+
+    wxFile f;
+    if (!f.Open(cacheFile)) return nullptr;
+
+    // check the key before pulling in the whole file
+    char magic[4];
+    uint32_t format = 0;
+    uint64_t fileHash = 0;
+    uint64_t fileSize = 0;
+    if (f.Read(magic, sizeof(magic)) != sizeof(magic) || memcmp(magic, SEQUENCE_CACHE_MAGIC, 4) != 0 ||
+        f.Read(&format, sizeof(format)) != sizeof(format) || format != SEQUENCE_CACHE_FORMAT ||
+        f.Read(&fileHash, sizeof(fileHash)) != sizeof(fileHash) || fileHash != hash ||
+        f.Read(&fileSize, sizeof(fileSize)) != sizeof(fileSize) || fileSize != size) {
+        logger_base.debug("SequenceCache: %s is stale.", (const char*)cacheFile.c_str());
+        return nullptr;
+    }
+
+    std::vector<uint8_t> data(f.Length() - f.Tell());
+    if (f.Read(data.data(), data.size()) != data.size()) {
+        return nullptr;
+    }
+    f.Close();
+
+    SequenceCache* cache = new SequenceCache();
+    CacheReader reader(data);
+    std::string version;
+    bool ok = reader.ReadString(version) &&
+              version == xlights_version_string.ToStdString() &&
+              reader.ReadString(cache->_xml) &&
+              reader.ReadVector(cache->_stringOffsets) &&
+              reader.ReadVector(cache->_strings) &&
+              reader.ReadVector(cache->_effectDB) &&
+              reader.ReadVector(cache->_elements) &&
+              reader.ReadRecords(cache->_layers, 21, [](CacheReader& r, CachedLayer& l) { return r.ReadLayer(l); }) &&
+              reader.ReadRecords(cache->_effects, 37, [](CacheReader& r, CachedEffect& e) { return r.ReadEffect(e); }) &&
+              cache->IsValid();
+    if (!ok) {
+        logger_base.debug("SequenceCache: %s was written by a different version or is damaged.", (const char*)cacheFile.c_str());
+        delete cache;
+        return nullptr;
+    }
+    return cache;
+}
+
+bool SequenceCache::IsValid() const
+{
+    if (_stringOffsets.empty() || _stringOffsets.back() != _strings.size()) return false;
+    for (size_t i = 1; i < _stringOffsets.size(); i++) {
+        if (_stringOffsets[i] < _stringOffsets[i - 1]) return false;
+    }
+    int32_t strings = (int32_t)_stringOffsets.size() - 1;
+    for (const auto& s : _effectDB) {
+        if (s < 0 || s >= strings) return false;
+    }
+    for (const auto& e : _elements) {
+        if ((uint64_t)e.firstLayer + e.layerCount > _layers.size()) return false;
+    }
+    for (const auto& l : _layers) {
+        if (l.name >= strings || (uint64_t)l.firstEffect + l.effectCount > _effects.size()) return false;
+    }
+    for (const auto& e : _effects) {
+        if (e.name < 0 || e.name >= strings || e.settings >= strings) return false;
+    }
+    return true;
+}
+
+std::string SequenceCache::GetString(int32_t index) const
+{
+    if (index < 0 || index + 1 >= (int32_t)_stringOffsets.size()) return "";
+    return std::string(_strings.data() + _stringOffsets[index], _stringOffsets[index + 1] - _stringOffsets[index]);
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class wxXmlDocument;
+class wxXmlNode;
+
+// Binary snapshot of a sequence file kept in the render cache folder.
+//
+// It holds the EffectDB and the ElementEffects tables with all their strings interned, plus
+// the rest of the sequence xml with those sections reduced to empty shells. Reopening a sequence
+// which has not changed since the snapshot was taken then only has to parse a small xml document
+// and a few flat tables. The snapshot is keyed on a hash of the xsq file and the xLights version
+// so the xsq always remains the authoritative copy.
+class SequenceCache
+{
+public:
+    enum class LayerType : uint8_t
+    {
+        EFFECT_LAYER,
+        SUBMODEL_LAYER,
+        STRAND_LAYER,
+        NODE_LAYER
+    };
+
+    struct CachedElement
+    {
+        uint32_t firstLayer;
+        uint32_t layerCount;
+    };
+
+    struct CachedLayer
+    {
+        LayerType type;
+        int32_t index;        // strand index for strand and node layers
+        int32_t layer;        // layer number ... for node layers the node number
+        int32_t name;         // string index or -1 if not present
+        uint32_t firstEffect;
+        uint32_t effectCount;
+    };
+
+    struct CachedEffect
+    {
+        double startTime;
+        double endTime;
+        int32_t id;
+        int32_t name;         // effect name or timing label
+        int32_t ref;          // effect db index or -1 if the settings are held inline
+        int32_t settings;     // string index of inline settings or -1
+        int32_t palette;      // colour palette index or -1
+        uint8_t isProtected;
+    };
+
+    static void SetEnabled(bool enabled) { _enabled = enabled; }
+    static bool IsEnabled() { return _enabled; }
+
+    static std::string GetCacheFile(const std::string& folder, const std::string& sequenceName);
+    static bool HashFile(const std::string& filename, uint64_t& hash, uint64_t& size);
+
+    // Snapshots a fully loaded (uncompressed) sequence document. The document is left as it was found.
+    // Empty if the document cannot be snapshotted.
+    static std::vector<uint8_t> Build(wxXmlDocument& doc);
+    static bool Write(const std::string& cacheFile, uint64_t hash, uint64_t size, const std::vector<uint8_t>& snapshot);
+
+    // Hashes the sequence file and writes the snapshot on a background thread so the UI never waits on the disk.
+    // Call SequenceFileChanging before rewriting a sequence file so a snapshot still pending for the old contents is
+    // dropped rather than written with the hash of the new ones.
+    static void WriteInBackground(const std::string& cacheFile, const std::string& sequenceFile, std::vector<uint8_t>&& snapshot);
+    static void SequenceFileChanging();
+
+    // Returns nullptr if there is no snapshot or it does not match the hash and size of the sequence file
+    static SequenceCache* Read(const std::string& cacheFile, uint64_t hash, uint64_t size);
+
+    const std::string& GetXml() const { return _xml; }
+    std::string GetString(int32_t index) const;
+    size_t GetEffectDBSize() const { return _effectDB.size(); }
+    std::string GetEffectDBString(size_t index) const { return GetString(_effectDB[index]); }
+
+    // elements are in the same order as the Element nodes of the ElementEffects shell
+    size_t GetElementCount() const { return _elements.size(); }
+    const CachedElement& GetElement(size_t index) const { return _elements[index]; }
+    const CachedLayer& GetLayer(size_t index) const { return _layers[index]; }
+    const CachedEffect& GetEffect(size_t index) const { return _effects[index]; }
+
+private:
+    static bool _enabled;
+    static std::atomic<uint64_t> _generation;
+    static std::mutex _writeLock;
+
+    std::string _xml;
+    std::vector<uint32_t> _stringOffsets;
+    std::vector<char> _strings;
+    std::vector<int32_t> _effectDB;
+    std::vector<CachedElement> _elements;
+    std::vector<CachedLayer> _layers;
+    std::vector<CachedEffect> _effects;
+
+    bool IsValid() const;
+};
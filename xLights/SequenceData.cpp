@@ -9,6 +9,7 @@
  **************************************************************/
 
 #include <wx/wx.h>
+#include <wx/stdpaths.h>
 
 
 #include <log4cpp/Category.hh>
@@ -17,6 +18,7 @@
 #include "../common/xlBaseApp.h"
 #include "SequenceData.h"
 #include "UtilFunctions.h"
+#include "MemoryAccounting.h"
 
 const unsigned char SequenceData::FrameData::_constzero = 0;
 
@@ -29,6 +31,7 @@ static const size_t MAX_BLOCK_SIZE = 1024 * 1024 * 1024;
 #ifdef USE_MMAP_BLOCKS
 std::list<std::unique_ptr<SequenceData::DataBlock>> SequenceData::HUGE_BLOCK_CACHE;
 #include <thread>
+#include <unistd.h>
 // OSX/Linux allows 2MB huge pages (or Superpages as they call them on OSX)
 static const size_t LARGE_PAGE_SIZE = 2 * 1024 * 1024;
 static bool firstSeq = true;
@@ -42,6 +45,9 @@ static size_t _hugePageAllocSize = DEFAULT_HUGE_ALLOC_SIZE;
 static bool _hugePagesFailed;
 #endif
 
+size_t SequenceData::_diskBackingThreshold = 0;
+std::string SequenceData::_diskBackingFolder;
+
 SequenceData::SequenceData() : _invalidFrame()
 {
 #ifdef USE_MMAP_BLOCKS
@@ -130,6 +136,8 @@ void SequenceData::Cleanup()
 #endif
 
     _dataBlocks.clear();
+    MemoryAccounting::Remove(MemoryAccounting::SEQUENCE_DATA, _accountedBytes);
+    _accountedBytes = 0;
     _invalidFrame._numChannels = 0;
     free(_invalidFrame._data);
     _invalidFrame._data = nullptr;
@@ -259,6 +267,37 @@ unsigned char* SequenceData::AllocBlock(size_t requested, size_t& szAllocated, B
     return data;
 }
 
+unsigned char* SequenceData::AllocSparseBlock(size_t requested, size_t& szAllocated, BlockType& blockType)
+{
+    // Sparse data relies on untouched pages never being backed by memory so we cannot use
+    // the huge page cache (already touched) or huge pages (2MB granularity would fill the gaps)
+    unsigned char* data = nullptr;
+    size_t sz = std::min(requested, MAX_BLOCK_SIZE);
+    blockType = BlockType::NORMAL;
+#ifdef USE_MMAP_BLOCKS
+    data = (unsigned char*)mmap(nullptr, sz,
+        PROT_READ | PROT_WRITE,
+        MAP_ANON | MAP_PRIVATE,
+        -1, 0);
+    if (data == MAP_FAILED) {
+        data = nullptr;
+    }
+#ifdef LINUX
+    if (data) {
+        madvise(data, sz, MADV_NOHUGEPAGE);
+    }
+#endif
+#else
+    data = (unsigned char*)calloc(1, sz);
+#endif
+    if (data == nullptr) {
+        // fall back to the normal allocation which will try smaller blocks
+        return AllocBlock(requested, szAllocated, blockType);
+    }
+    szAllocated = sz;
+    return data;
+}
+
 unsigned char *SequenceData::checkBlockPtr(unsigned char *block, size_t sizeRemaining) {
     static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
     wxASSERT(block != nullptr); // if this fails then we have a memory allocation error
@@ -273,6 +312,202 @@ unsigned char *SequenceData::checkBlockPtr(unsigned char *block, size_t sizeRema
     return block;
 }
 
+bool SequenceData::WillUseDiskBacking(size_t bytes)
+{
+#ifdef USE_MMAP_BLOCKS
+    // also spill to disk rather than push the other caches out of memory when we are short
+    return (_diskBackingThreshold != 0 && bytes > _diskBackingThreshold) || MemoryAccounting::WouldExceedBudget(bytes);
+#else
+    return false;
+#endif
+}
+
+bool SequenceData::IsDiskBacked() const
+{
+    return !_dataBlocks.empty() && _dataBlocks.front()->type == BlockType::FILE_BACKED;
+}
+
+bool SequenceData::InitFileBacked(size_t totalSize)
+{
+#ifdef USE_MMAP_BLOCKS
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    std::string folder = _diskBackingFolder;
+    if (folder.empty() || !wxDirExists(folder)) {
+        folder = wxStandardPaths::Get().GetTempDir().ToStdString();
+    }
+    std::string fn = folder + "/xLightsSeqData-XXXXXX";
+    int fd = mkstemp(&fn[0]);
+    if (fd < 0) {
+        logger_base.warn("Unable to create sequence data backing file in %s.", (const char*)folder.c_str());
+        return false;
+    }
+    // the mappings keep the file alive, unlinking now makes sure it is cleaned up even if we crash
+    unlink(fn.c_str());
+
+    // each mapping holds a whole number of frames so a frame never straddles two mappings
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t framesPerBlock = std::max((size_t)1, MAX_BLOCK_SIZE / _bytesPerFrame);
+    size_t blockBytes = framesPerBlock * _bytesPerFrame;
+    blockBytes = ((blockBytes + pageSize - 1) / pageSize) * pageSize;
+    size_t numBlocks = (_numFrames + framesPerBlock - 1) / framesPerBlock;
+
+    // extending the file without writing leaves it sparse, disk is only used for pages we touch
+    if (ftruncate(fd, (off_t)(numBlocks * blockBytes)) != 0) {
+        logger_base.warn("Unable to size sequence data backing file to %lu bytes.", (unsigned long)(numBlocks * blockBytes));
+        close(fd);
+        return false;
+    }
+
+    off_t offset = 0;
+    unsigned int frame = 0;
+    for (size_t b = 0; b < numBlocks; ++b) {
+        unsigned char* block = (unsigned char*)mmap(nullptr, blockBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, offset);
+        if (block == MAP_FAILED) {
+            logger_base.warn("Unable to map sequence data backing file block %d.", (int)b);
+            _frames.clear();
+            _dataBlocks.clear();
+            close(fd);
+            return false;
+        }
+        _dataBlocks.push_back(std::make_unique<DataBlock>(blockBytes, block, BlockType::FILE_BACKED));
+        for (size_t f = 0; f < framesPerBlock && frame < _numFrames; ++f, ++frame) {
+            _frames.push_back(FrameData(_numChannels, block, _activeRanges.empty() ? nullptr : &_activeRanges));
+            block += _bytesPerFrame;
+        }
+        offset += blockBytes;
+    }
+    close(fd);
+    logger_base.debug("Sequence data backed by file in %s. Frames=%d, Channels=%d, Memory=%lu.", (const char*)folder.c_str(), _numFrames, _numChannels, (unsigned long)totalSize);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void SequenceData::AdviseFrames(unsigned int frame, unsigned int count, int advice)
+{
+#ifdef USE_MMAP_BLOCKS
+    if (!IsDiskBacked() || frame >= _numFrames) {
+        return;
+    }
+    if (count > _numFrames - frame) {
+        count = _numFrames - frame;
+    }
+    // madvise needs a page aligned start so round each contiguous run of frames out to page boundaries
+    static const uintptr_t pageMask = ~(uintptr_t)(sysconf(_SC_PAGESIZE) - 1);
+    unsigned char* runStart = _frames[frame]._data;
+    unsigned char* runEnd = runStart + _bytesPerFrame;
+    for (unsigned int f = frame + 1; f <= frame + count; ++f) {
+        if (f < frame + count && _frames[f]._data == runEnd) {
+            runEnd += _bytesPerFrame;
+            continue;
+        }
+        unsigned char* start = (unsigned char*)((uintptr_t)runStart & pageMask);
+        madvise(start, runEnd - start, advice);
+        if (f < frame + count) {
+            runStart = _frames[f]._data;
+            runEnd = runStart + _bytesPerFrame;
+        }
+    }
+#endif
+}
+
+void SequenceData::Prefetch(unsigned int frame, unsigned int count)
+{
+#ifdef USE_MMAP_BLOCKS
+    AdviseFrames(frame, count, MADV_WILLNEED);
+#endif
+}
+
+void SequenceData::Flush()
+{
+#ifdef USE_MMAP_BLOCKS
+    for (auto& b : _dataBlocks) {
+        if (b->type == BlockType::FILE_BACKED) {
+            msync(b->data, b->size, MS_ASYNC);
+        }
+    }
+#endif
+}
+
+bool SequenceData::CoversRanges(const std::vector<std::pair<uint32_t, uint32_t>>& ranges) const
+{
+    if (_activeRanges.empty()) {
+        return true;
+    }
+    for (const auto& r : ranges) {
+        if (r.first >= _numChannels) {
+            continue;
+        }
+        uint32_t end = std::min(r.first + r.second, _numChannels);
+        bool covered = false;
+        for (const auto& a : _activeRanges) {
+            if (a.first <= r.first && end <= a.first + a.second) {
+                covered = true;
+                break;
+            }
+        }
+        if (!covered) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SequenceData::ExtendSparseRanges(const std::vector<std::pair<uint32_t, uint32_t>>& ranges)
+{
+    if (_activeRanges.empty()) {
+        return;
+    }
+    // spans are only ever added so channels that were used keep getting cleared and output
+    std::vector<std::pair<uint32_t, uint32_t>> all(_activeRanges);
+    for (const auto& r : ranges) {
+        if (r.first < _numChannels) {
+            all.push_back(std::pair<uint32_t, uint32_t>(r.first, std::min(r.second, _numChannels - r.first)));
+        }
+    }
+    std::sort(all.begin(), all.end());
+    std::vector<std::pair<uint32_t, uint32_t>> merged;
+    for (const auto& r : all) {
+        if (!merged.empty() && r.first <= merged.back().first + merged.back().second) {
+            uint32_t end = std::max(merged.back().first + merged.back().second, r.first + r.second);
+            merged.back().second = end - merged.back().first;
+        } else {
+            merged.push_back(r);
+        }
+    }
+    _activeRanges = merged;
+    _sparseRanges = merged;
+
+    // the new spans get touched from now on so they start costing memory
+    size_t bytes = ResidentBytes();
+    if (bytes > _accountedBytes) {
+        MemoryAccounting::Add(MemoryAccounting::SEQUENCE_DATA, bytes - _accountedBytes);
+        _accountedBytes = bytes;
+        MemoryAccounting::CheckBudget();
+    }
+}
+
+size_t SequenceData::ResidentBytes() const
+{
+    size_t total = 0;
+    for (const auto& it : _dataBlocks) {
+        if (it->type != BlockType::FILE_BACKED) {
+            total += it->size;
+        }
+    }
+    if (_activeRanges.empty() || total == 0) {
+        return total;
+    }
+    // only the pages under the used spans of sparse data are ever backed by memory
+    size_t used = 0;
+    for (const auto& r : _activeRanges) {
+        used += r.second;
+    }
+    return std::min(total, used * (size_t)_numFrames);
+}
+
 void SequenceData::init(unsigned int numChannels, unsigned int numFrames, unsigned int frameTime, bool roundto4)
 {
     static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
@@ -287,29 +522,54 @@ void SequenceData::init(unsigned int numChannels, unsigned int numFrames, unsign
     _frameTime = frameTime;
     _bytesPerFrame = roundTo4(numChannels);
 
+    _activeRanges.clear();
+    if (!_sparseRanges.empty()) {
+        size_t used = 0;
+        for (const auto& r : _sparseRanges) {
+            if (r.first < _numChannels) {
+                uint32_t count = std::min(r.second, _numChannels - r.first);
+                _activeRanges.push_back(std::pair<uint32_t, uint32_t>(r.first, count));
+                used += count;
+            }
+        }
+        // not worth giving up huge pages unless a good chunk of the channel space is unused
+        if (used > ((size_t)_numChannels * 3) / 4) {
+            _activeRanges.clear();
+        } else {
+            logger_base.debug("Sequence data is sparse. Used channels=%lu, Channels=%d, Ranges=%d.", (unsigned long)used, _numChannels, (int)_activeRanges.size());
+        }
+    }
+    const std::vector<std::pair<uint32_t, uint32_t>>* ranges = _activeRanges.empty() ? nullptr : &_activeRanges;
+
     if (numFrames > 0 && numChannels > 0) {
         _frames.reserve(numFrames);
         size_t sizeRemaining = (size_t)_bytesPerFrame * (size_t)_numFrames;
-        size_t blockSize = 0;
-        
-        BlockType type = BlockType::NORMAL;
-        unsigned char* block = checkBlockPtr(AllocBlock(sizeRemaining, blockSize, type), sizeRemaining);
-        _dataBlocks.push_back(std::make_unique<DataBlock>(blockSize, block, type));
-        
-        for (unsigned int frame = 0; frame < numFrames; ++frame) {
-            if (blockSize < _bytesPerFrame) {
-                block = checkBlockPtr(AllocBlock(sizeRemaining, blockSize, type), sizeRemaining);
-                _dataBlocks.push_back(std::make_unique<DataBlock>(blockSize, block, type));
+        if (!WillUseDiskBacking(sizeRemaining) || !InitFileBacked(sizeRemaining)) {
+            size_t blockSize = 0;
+            auto alloc = ranges == nullptr ? &SequenceData::AllocBlock : &SequenceData::AllocSparseBlock;
+
+            BlockType type = BlockType::NORMAL;
+            unsigned char* block = checkBlockPtr(alloc(sizeRemaining, blockSize, type), sizeRemaining);
+            _dataBlocks.push_back(std::make_unique<DataBlock>(blockSize, block, type));
+
+            for (unsigned int frame = 0; frame < numFrames; ++frame) {
+                if (blockSize < _bytesPerFrame) {
+                    block = checkBlockPtr(alloc(sizeRemaining, blockSize, type), sizeRemaining);
+                    _dataBlocks.push_back(std::make_unique<DataBlock>(blockSize, block, type));
+                }
+                _frames.push_back(FrameData(_numChannels, block, ranges));
+                block += _bytesPerFrame;
+                sizeRemaining -= _bytesPerFrame;
+                blockSize -= _bytesPerFrame;
             }
-            _frames.push_back(FrameData(_numChannels, block));
-            block += _bytesPerFrame;
-            sizeRemaining -= _bytesPerFrame;
-            blockSize -= _bytesPerFrame;
         }
     }
     else {
         logger_base.debug("Sequence memory released.");
     }
+    _accountedBytes = ResidentBytes();
+    MemoryAccounting::Add(MemoryAccounting::SEQUENCE_DATA, _accountedBytes);
+    MemoryAccounting::CheckBudget();
     _invalidFrame._data = (unsigned char*)calloc(1, _bytesPerFrame);
     _invalidFrame._numChannels = _numChannels;
 }
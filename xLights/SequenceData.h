@@ -13,6 +13,8 @@
 #include <wx/wx.h>
 #include <memory>
 #include <mutex>
+#include <vector>
+#include <list>
 
 #ifdef __WXOSX__
 #include <sys/mman.h>
@@ -35,22 +37,53 @@ public:
         unsigned char _zero;
         unsigned int _numChannels;
         unsigned char* _data;
+        const std::vector<std::pair<uint32_t, uint32_t>>* _ranges;
         friend class SequenceData;
         
-        FrameData() : _zero(0), _numChannels(0), _data(nullptr) {}
-        FrameData(unsigned int nc, unsigned char *d) : _zero(0), _numChannels(nc), _data(d) {}
+        FrameData() : _zero(0), _numChannels(0), _data(nullptr), _ranges(nullptr) {}
+        FrameData(unsigned int nc, unsigned char *d, const std::vector<std::pair<uint32_t, uint32_t>>* r = nullptr) : _zero(0), _numChannels(nc), _data(d), _ranges(r) {}
 
     public:
-        FrameData(const FrameData && d) noexcept : _zero(d._zero), _numChannels(d._numChannels), _data(d._data) {}
+        FrameData(const FrameData && d) noexcept : _zero(d._zero), _numChannels(d._numChannels), _data(d._data), _ranges(d._ranges) {}
         
         void Zero() {
-            memset(_data, 0x00, _numChannels);
+            if (_ranges == nullptr) {
+                memset(_data, 0x00, _numChannels);
+            } else {
+                for (const auto& r : *_ranges) {
+                    memset(&_data[r.first], 0x00, r.second);
+                }
+            }
         }
         void Zero(unsigned int start, unsigned int count) {
             if (start < 0) return;
             if (count < 1) return;
             if (start + count > _numChannels) return;
-            memset(&_data[start], 0x00, count);
+            if (_ranges == nullptr) {
+                memset(&_data[start], 0x00, count);
+            } else {
+                // only touch the used spans so the pages for the gaps never get allocated
+                unsigned int end = start + count;
+                for (const auto& r : *_ranges) {
+                    unsigned int s = std::max(start, r.first);
+                    unsigned int e = std::min(end, r.first + r.second);
+                    if (s < e) {
+                        memset(&_data[s], 0x00, e - s);
+                    }
+                }
+            }
+        }
+
+        // calls f(startChannel, data, count) for each span of used channels, or once for the whole frame if the data is not sparse
+        template <typename F>
+        void ForEachUsedRange(F&& f) {
+            if (_ranges == nullptr) {
+                f(0, _data, _numChannels);
+            } else {
+                for (const auto& r : *_ranges) {
+                    f(r.first, &_data[r.first], r.second);
+                }
+            }
         }
         
         unsigned char &operator[](unsigned int channel) {
@@ -66,7 +99,8 @@ public:
 
     enum class BlockType {
         NORMAL,
-        HUGE_PAGE
+        HUGE_PAGE,
+        FILE_BACKED
     };
     class DataBlock {
         DataBlock(const DataBlock&d) = delete;
@@ -83,10 +117,15 @@ public:
 #ifdef USE_MMAP_BLOCKS
     static std::list<std::unique_ptr<DataBlock>> HUGE_BLOCK_CACHE;
 #endif    
+    std::vector<std::pair<uint32_t, uint32_t>> _sparseRanges;
+    std::vector<std::pair<uint32_t, uint32_t>> _activeRanges;
+    static size_t _diskBackingThreshold;
+    static std::string _diskBackingFolder;
     FrameData _invalidFrame;
     std::vector<FrameData> _frames;
     std::list<std::unique_ptr<DataBlock>> _dataBlocks;
     
+    size_t _accountedBytes = 0; // bytes reported to MemoryAccounting
     unsigned int _bytesPerFrame;
     unsigned int _numChannels;
     unsigned int _numFrames;
@@ -98,6 +137,10 @@ public:
     void Cleanup();
     unsigned char *checkBlockPtr(unsigned char *block, size_t sizeRemaining);
     static unsigned char *AllocBlock(size_t requested, size_t &szAllocated, BlockType &bt);
+    static unsigned char *AllocSparseBlock(size_t requested, size_t &szAllocated, BlockType &bt);
+    bool InitFileBacked(size_t totalSize);
+    size_t ResidentBytes() const;
+    void AdviseFrames(unsigned int frame, unsigned int count, int advice);
 public:
     SequenceData();
     virtual ~SequenceData();
@@ -124,6 +167,30 @@ public:
     unsigned int FrameTime() const { return _frameTime;}
     bool IsValidData() const { return !_dataBlocks.empty(); }
 
+    // Channel spans (start, count) that models actually map.  When set before init and the spans
+    // leave enough of the channel space unused, the gaps are never touched so the OS never has to
+    // back them with memory.  Whole frame operations (Zero, ForEachUsedRange) only visit the spans.
+    void SetSparseRanges(const std::vector<std::pair<uint32_t, uint32_t>>& ranges) { _sparseRanges = ranges; }
+    const std::vector<std::pair<uint32_t, uint32_t>>& GetUsedRanges() const { return _activeRanges; }
+    bool IsSparse() const { return !_activeRanges.empty(); }
+    // grows the used spans of already allocated sparse data, no render may be running while this is called
+    bool CoversRanges(const std::vector<std::pair<uint32_t, uint32_t>>& ranges) const;
+    void ExtendSparseRanges(const std::vector<std::pair<uint32_t, uint32_t>>& ranges);
+
+    // Sequences whose frame data exceeds the threshold (in bytes) are stored in a sparse
+    // memory mapped file in the given folder rather than in anonymous memory so the OS
+    // can page them in and out as needed.  A threshold of 0 disables the file backing.
+    static void SetDiskBackingThreshold(size_t bytes) { _diskBackingThreshold = bytes; }
+    static size_t GetDiskBackingThreshold() { return _diskBackingThreshold; }
+    static void SetDiskBackingFolder(const std::string& folder) { _diskBackingFolder = folder; }
+    static bool WillUseDiskBacking(size_t bytes);
+    bool IsDiskBacked() const;
+
+    // hint that the given frames are about to be rendered/played so they should be paged in
+    void Prefetch(unsigned int frame, unsigned int count);
+    // start writing dirty pages back to the backing file so they can be cheaply evicted
+    void Flush();
+
     // encodes contents of SeqData in channel order
     wxString base64_encode();
 };
@@ -128,10 +128,12 @@ wxString xLightsFrame::LoadEffectsFileNoCheck()
             }
         }
 
+        wxStopWatch sw;
         if (!EffectsXml.Load(effectsFile.GetFullPath())) {
             DisplayError("Unable to load RGB effects file ... creating a default one.", this);
             CreateDefaultEffectsXml();
         }
+        logger_base.debug("RGB effects file parsed in %ldms.", sw.Time());
     }
 
     wxXmlNode* root = EffectsXml.GetRoot();
@@ -1375,7 +1377,7 @@ void xLightsFrame::SaveSequence()
             wxString mss = CurrentSeqXmlFile->GetSequenceTiming();
             int ms = wxAtoi(mss);
 
-            _seqData.init(GetMaxNumChannels(), CurrentSeqXmlFile->GetSequenceDurationMS() / ms, ms);
+            InitSequenceData(CurrentSeqXmlFile->GetSequenceDurationMS() / ms, ms);
         }
 
         ProgressBar->Show();
@@ -1438,7 +1440,7 @@ void xLightsFrame::SetSequenceTiming(int timingMS)
     if (_seqData.FrameTime() != timingMS)
     {
         AbortRender();
-        _seqData.init(GetMaxNumChannels(), CurrentSeqXmlFile->GetSequenceDurationMS() / timingMS, timingMS);
+        InitSequenceData(CurrentSeqXmlFile->GetSequenceDurationMS() / timingMS, timingMS);
     }
 }
 
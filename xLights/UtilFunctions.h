@@ -17,6 +17,8 @@
 #include "../xSchedule/wxJSON/jsonval.h"
 #include "../xSchedule/wxJSON/jsonreader.h"
 
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <algorithm>
 #include <map>
@@ -91,6 +93,36 @@ inline int roundTo16(int i) {
     return i + 16 - remainder;
 }
 
+// 64 bit FNV-1a ... cheap and good enough to notice something changed, not to resist tampering
+constexpr uint64_t FNV1A_SEED = 14695981039346656037ULL;
+inline uint64_t FNV1a(uint64_t hash, uint64_t v) {
+    return (hash ^ v) * 1099511628211ULL;
+}
+inline uint64_t FNV1a(uint64_t hash, const std::string& s) {
+    for (char c : s) {
+        hash = FNV1a(hash, (uint8_t)c);
+    }
+    return hash;
+}
+inline uint64_t FNV1aBytes(uint64_t hash, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < len; i++) {
+        hash = FNV1a(hash, p[i]);
+    }
+    return hash;
+}
+// a 64 bit word at a time then any odd bytes at the end one at a time ... much quicker on big buffers
+inline uint64_t FNV1aWords(uint64_t hash, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    size_t words = len / sizeof(uint64_t);
+    for (size_t i = 0; i < words; i++) {
+        uint64_t w;
+        memcpy(&w, p + i * sizeof(uint64_t), sizeof(uint64_t));
+        hash = FNV1a(hash, w);
+    }
+    return FNV1aBytes(hash, p + words * sizeof(uint64_t), len - words * sizeof(uint64_t));
+}
+
 inline double rand01()
 {
     return (double)rand() / (double)RAND_MAX;
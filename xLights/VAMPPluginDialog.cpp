@@ -25,6 +25,11 @@
 #include "vamp-hostsdk/PluginLoader.h"
 #include "UtilFunctions.h"
 #include "xLightsMain.h"
+#include "VampFeatureCache.h"
+
+#include <atomic>
+#include <chrono>
+#include <future>
 
 //(*IdInit(VAMPPluginDialog)
 const long VAMPPluginDialog::ID_TEXTCTRL1 = wxNewId();
@@ -284,9 +289,6 @@ wxString VAMPPluginDialog::ProcessPlugin(xLightsXmlFile* xml_file, xLightsFrame
         if (step == 0) {
             step = block;
         }
-        float *pdata[2];
-        std::string error;
-		media->SetStepBlock(step, block);
 
         for (int x = 0; x < params.size(); x++) {
 
@@ -311,46 +313,34 @@ wxString VAMPPluginDialog::ProcessPlugin(xLightsXmlFile* xml_file, xLightsFrame
                 p->setParameter(params[x].identifier, slider->GetValue());
             }
         }
-        int channels = media->GetChannels();
-        if (channels > p->getMaxChannelCount()) {
-            channels = 1;
-        }
-        p->initialise(channels, step, block);
-        pdata[0] =media->GetFilteredLeftDataPtr(0);
-        pdata[1] = media->GetFilteredRightDataPtr(0);
-        
-        wxProgressDialog progress("Processing Audio", "");
-        long totalLen = media->GetTrackSize();
-        long len = media->GetTrackSize();
-		int percent = 0;
-        long start = 0;
-        while (len) {
-            //int request = block;
-            //if (request > len) request = len;
-
-			pdata[0] = media->GetFilteredLeftDataPtr(start);
-			pdata[1] = media->GetFilteredRightDataPtr(start);
-
-            Vamp::RealTime timestamp = Vamp::RealTime::frame2RealTime(start, media->GetRate());
-            Vamp::Plugin::FeatureSet features = p->process(pdata, timestamp);
-            processFeatures(features[output], starts, ends, labels, convert);
-
-            if (len > (long)step) {
-                len -= step;
-            } else {
-                len = 0;
-            }
-            start += step;
-            
-            int newp = (int)((start * 100) / totalLen);
-            if (newp != percent) {
-                percent = newp;
+
+        // only the unfiltered song is worth remembering
+        VampFeatureCache::Features features;
+        std::string cacheKey = media->IsFiltered() ? "" : VampFeatureCache::GetKey(media, p, media->GetVamp()->GetPluginKey(p), output, step, block);
+        if (cacheKey == "" || !VampFeatureCache::Load(cacheKey, features)) {
+            media->SetStepBlock(step, block);
+
+            // the analysis runs in the background so the UI keeps responding while it works through the track
+            wxProgressDialog progress("Processing Audio", "");
+            std::atomic_int percent(0);
+            std::future<VampFeatureCache::Features> analysis = std::async(std::launch::async, [media, p, output, step, block, &percent]() {
+                return VampFeatureCache::Run(media, p, output, step, block, false, [&percent](int pct) { percent = pct; });
+            });
+            while (analysis.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready) {
                 progress.Update(percent);
             }
+            features = analysis.get();
+            progress.Update(100);
+
+            if (cacheKey != "") {
+                VampFeatureCache::Save(cacheKey, features);
+            }
+        }
+
+        for (auto& it : features.processed) {
+            processFeatures(it, starts, ends, labels, convert);
         }
-        Vamp::Plugin::FeatureSet features = p->getRemainingFeatures();
-        processFeatures(features[output], starts, ends, labels, convert);
-        progress.Update(100);
+        processFeatures(features.remaining, starts, ends, labels, convert);
 
         xml_file->AddNewTimingSection(TimingName->GetValue().ToStdString(), xLightsParent, starts, ends, labels);
         return TimingName->GetValue();
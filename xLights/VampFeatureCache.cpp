@@ -0,0 +1,213 @@
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <wx/wx.h>
+#include <wx/filename.h>
+#include <wx/stdpaths.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#include "VampFeatureCache.h"
+#include "AudioManager.h"
+#include "../xSchedule/md5.h"
+
+#include <log4cpp/Category.hh>
+
+#define VAMP_CACHE_VERSION "xLightsVampCache 1"
+
+std::string VampFeatureCache::GetKey(AudioManager* media, Vamp::Plugin* plugin, const std::string& pluginKey, int output, size_t step, size_t block)
+{
+    std::ostringstream key;
+    key << std::setprecision(9);
+    key << media->Hash() << "|" << media->GetRate() << "|" << pluginKey << "|" << plugin->getPluginVersion()
+        << "|" << output << "|" << step << "|" << block;
+    for (const auto& it : plugin->getParameterDescriptors()) {
+        key << "|" << it.identifier << "=" << plugin->getParameter(it.identifier);
+    }
+    return key.str();
+}
+
+std::string VampFeatureCache::GetFileName(const std::string& key)
+{
+    wxString dir = wxStandardPaths::Get().GetUserLocalDataDir() + wxFileName::GetPathSeparator() + "VampCache";
+    if (!wxDirExists(dir) && !wxFileName::Mkdir(dir, wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL)) {
+        return "";
+    }
+
+    MD5 md5;
+    md5.update((unsigned char*)key.c_str(), key.size());
+    md5.finalize();
+    return (dir + wxFileName::GetPathSeparator() + md5.hexdigest() + ".txt").ToStdString();
+}
+
+static void WriteFeatures(std::ostream& out, char type, const Vamp::Plugin::FeatureList& features)
+{
+    out << type << " " << features.size() << "\n";
+    for (const auto& f : features) {
+        out << f.hasTimestamp << " " << f.timestamp.sec << " " << f.timestamp.nsec << " "
+            << f.hasDuration << " " << f.duration.sec << " " << f.duration.nsec << " " << f.values.size();
+        for (float v : f.values) {
+            out << " " << v;
+        }
+        // the label gets a line of its own
+        std::string label = f.label;
+        std::replace(label.begin(), label.end(), '\n', ' ');
+        std::replace(label.begin(), label.end(), '\r', ' ');
+        out << "\n" << label << "\n";
+    }
+}
+
+static bool ReadFeatures(std::istream& in, char& type, Vamp::Plugin::FeatureList& features)
+{
+    size_t count = 0;
+    if (!(in >> type >> count)) {
+        return false;
+    }
+    features.resize(count);
+    for (auto& f : features) {
+        size_t values = 0;
+        if (!(in >> f.hasTimestamp >> f.timestamp.sec >> f.timestamp.nsec >> f.hasDuration >> f.duration.sec >> f.duration.nsec >> values)) {
+            return false;
+        }
+        f.values.resize(values);
+        for (auto& v : f.values) {
+            if (!(in >> v)) {
+                return false;
+            }
+        }
+        in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        if (!std::getline(in, f.label)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool VampFeatureCache::Load(const std::string& key, Features& features)
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    std::string fn = GetFileName(key);
+    if (fn == "" || !wxFileExists(fn)) {
+        return false;
+    }
+
+    std::ifstream in(fn);
+    std::string version;
+    std::string fileKey;
+    if (!std::getline(in, version) || version != VAMP_CACHE_VERSION || !std::getline(in, fileKey) || fileKey != key) {
+        return false;
+    }
+
+    Features res;
+    char type;
+    Vamp::Plugin::FeatureList list;
+    while (ReadFeatures(in, type, list)) {
+        if (type == 'R') {
+            res.remaining = list;
+            features = res;
+            logger_base.debug("VAMP results loaded from cache %s.", (const char*)fn.c_str());
+            return true;
+        }
+        res.processed.push_back(list);
+    }
+
+    logger_base.warn("VAMP cache file %s is damaged ... ignoring it.", (const char*)fn.c_str());
+    return false;
+}
+
+void VampFeatureCache::Save(const std::string& key, const Features& features)
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    std::string fn = GetFileName(key);
+    if (fn == "") {
+        logger_base.warn("Unable to create the VAMP cache folder.");
+        return;
+    }
+
+    // written aside and renamed so a half written file is never read
+    std::string tmp = fn + ".tmp";
+    {
+        std::ofstream out(tmp);
+        out << std::setprecision(9);
+        out << VAMP_CACHE_VERSION << "\n" << key << "\n";
+        for (const auto& it : features.processed) {
+            WriteFeatures(out, 'P', it);
+        }
+        // always last
+        WriteFeatures(out, 'R', features.remaining);
+        if (!out.good()) {
+            out.close();
+            wxRemoveFile(tmp);
+            logger_base.warn("Unable to write VAMP cache file %s.", (const char*)tmp.c_str());
+            return;
+        }
+    }
+    if (!wxRenameFile(tmp, fn, true)) {
+        wxRemoveFile(tmp);
+        logger_base.warn("Unable to write VAMP cache file %s.", (const char*)fn.c_str());
+    }
+}
+
+VampFeatureCache::Features VampFeatureCache::Run(AudioManager* media, Vamp::Plugin* plugin, int output, size_t step, size_t block, bool raw, std::function<void(int)> progress)
+{
+    Features res;
+
+    if (block == 0) {
+        block = step != 0 ? step : 1024;
+    }
+    if (step == 0) {
+        step = block;
+    }
+
+    int channels = media->GetChannels();
+    if (channels > (int)plugin->getMaxChannelCount()) {
+        channels = 1;
+    }
+    plugin->initialise(channels, step, block);
+
+    float* pdata[2];
+    long totalLen = media->GetTrackSize();
+    long len = totalLen;
+    long start = 0;
+    int percent = 0;
+    while (len) {
+        pdata[0] = raw ? media->GetRawLeftDataPtr(start) : media->GetFilteredLeftDataPtr(start);
+        pdata[1] = raw ? media->GetRawRightDataPtr(start) : media->GetFilteredRightDataPtr(start);
+
+        Vamp::RealTime timestamp = Vamp::RealTime::frame2RealTime(start, media->GetRate());
+        Vamp::Plugin::FeatureSet features = plugin->process(pdata, timestamp);
+        if (!features[output].empty()) {
+            res.processed.push_back(features[output]);
+        }
+
+        if (len > (long)step) {
+            len -= step;
+        } else {
+            len = 0;
+        }
+        start += step;
+
+        int newp = (int)((start * 100) / totalLen);
+        if (newp != percent) {
+            percent = std::min(newp, 100);
+            progress(percent);
+        }
+    }
+
+    Vamp::Plugin::FeatureSet features = plugin->getRemainingFeatures();
+    res.remaining = features[output];
+    return res;
+}
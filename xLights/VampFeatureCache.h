@@ -0,0 +1,48 @@
+#pragma once
+
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "vamp-hostsdk/PluginLoader.h"
+
+class AudioManager;
+
+// The results of running VAMP plugins over songs saved on disk so the same analysis of the same audio is only ever
+// done once ... across sequences which share a song and across sessions.
+//
+// Results are keyed by the hash of the song's unfiltered audio, the plugin's loader key and its version, the output, the step and
+// block sizes and every parameter value. Anything which could change the answer gives a different key.
+class VampFeatureCache
+{
+public:
+    // everything the plugin returned for one output in the order it returned it
+    struct Features
+    {
+        std::vector<Vamp::Plugin::FeatureList> processed; // one per process() call which returned something
+        Vamp::Plugin::FeatureList remaining;              // getRemainingFeatures()
+    };
+
+    // the plugin must already have its parameters set. pluginKey is the loader's library:identifier key for it.
+    static std::string GetKey(AudioManager* media, Vamp::Plugin* plugin, const std::string& pluginKey, int output, size_t step, size_t block);
+
+    static bool Load(const std::string& key, Features& features);
+    static void Save(const std::string& key, const Features& features);
+
+    // runs the plugin over the whole track on the calling thread. raw selects the unfiltered audio rather than the
+    // audio as currently filtered. progress is called with 0-100.
+    static Features Run(AudioManager* media, Vamp::Plugin* plugin, int output, size_t step, size_t block, bool raw, std::function<void(int)> progress);
+
+private:
+    static std::string GetFileName(const std::string& key);
+};
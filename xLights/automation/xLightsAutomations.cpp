@@ -28,6 +28,11 @@
 #include "../outputs/E131Output.h"
 #include "../../xSchedule/wxHTTPServer/wxhttpserver.h"
 #include "../sequencer/MainSequencer.h"
+#include "../sequencer/Effect.h"
+#include "../sequencer/EffectLayer.h"
+#include "../effects/RenderableEffect.h"
+#include "../RenderBenchmark.h"
+#include "../MemoryAccounting.h"
 #include <wx/uri.h>
 
 #include "LuaRunner.h"
@@ -102,6 +107,9 @@ bool xLightsFrame::ProcessAutomation(std::vector<std::string> &paths,
     std::string cmd = paths[0];
     if (cmd == "getVersion") {
         return sendResponse(GetDisplayVersionString(), "version", 200, false);
+    } else if (cmd == "getMemoryUsage") {
+        std::string response = "{\"memory\":" + MemoryAccounting::GetReportJSON() + "}";
+        return sendResponse(response, "", 200, true);
     } else if (cmd == "openSequence" || cmd == "getOpenSequence" || cmd == "loadSequence") {
         wxString fname = "";
         if (paths.size() > 1) {
@@ -276,6 +284,315 @@ bool xLightsFrame::ProcessAutomation(std::vector<std::string> &paths,
             _outputModelManager.AddImmediateWork(OutputModelManager::WORK_MODELS_CHANGE_REQUIRING_RERENDER, "Automation::batchRender");
         }
         return sendResponse("Sequence batch rendered.", "msg", 200, false);
+    } else if (cmd == "benchmarkRender") {
+        // Renders the open sequence and times each stage of producing and playing it back.
+        // The results can be saved and used as the baseline for comparing later builds.
+        static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+        if (CurrentSeqXmlFile == nullptr) {
+            return sendResponse("No sequence open.", "msg", 503, false);
+        }
+        if (!_seqData.IsValidData() || _seqData.NumFrames() == 0) {
+            return sendResponse("Sequence has no data to render.", "msg", 503, false);
+        }
+        int iterations = std::max(1, wxAtoi(params["iterations"]));
+        uint32_t frames = _seqData.NumFrames();
+        uint32_t channels = _seqData.NumChannels();
+
+        RenderBenchmark bench;
+        bench.Set("frames", frames);
+        bench.Set("channels", channels);
+
+        // full render ... best of the iterations as that is the least disturbed by anything else on the machine
+        double best = 0.0;
+        double total = 0.0;
+        for (int i = 0; i < iterations; i++) {
+            RenderStageTimer::Start();
+            wxStopWatch sw;
+            RenderAll();
+            while (mRendering) {
+                wxYield();
+            }
+            double ms = sw.TimeInMicro().ToDouble() / 1000.0;
+            RenderStageTimer::Stop();
+            total += ms;
+            if (i == 0 || ms < best) {
+                best = ms;
+                bench.AddStageTimes("render_stage_");
+            }
+        }
+        bench.Set("render_ms", best);
+        bench.Set("render_mean_ms", total / iterations);
+        bench.Set("render_fps", best > 0.0 ? frames * 1000.0 / best : 0.0);
+
+        // mapping every frame onto the outputs as playback does ... nothing is sent to the lights
+        {
+            wxStopWatch sw;
+            for (uint32_t f = 0; f < frames; f++) {
+                _seqData[f].ForEachUsedRange([this](uint32_t start, unsigned char* data, uint32_t count) {
+                    _outputManager.SetManyChannels(start, data, count);
+                });
+            }
+            double ms = sw.TimeInMicro().ToDouble() / 1000.0;
+            bench.Set("output_ms", ms);
+            bench.Set("output_fps", ms > 0.0 ? frames * 1000.0 / ms : 0.0);
+        }
+
+        // fseq write and read back through a scratch file
+        std::string fseq = wxFileName::GetTempDir().ToStdString() + wxFileName::GetPathSeparator() + "xLightsBenchmark.fseq";
+        {
+            wxStopWatch sw;
+            WriteFalconPiFile(fseq, false);
+            bench.Set("fseq_write_ms", sw.TimeInMicro().ToDouble() / 1000.0);
+        }
+        {
+            wxStopWatch sw;
+            std::unique_ptr<FSEQFile> file(FSEQFile::openFSEQFile(fseq));
+            if (file != nullptr) {
+                std::vector<std::pair<uint32_t, uint32_t>> ranges;
+                ranges.push_back(std::pair<uint32_t, uint32_t>(0, file->getMaxChannel()));
+                file->prepareRead(ranges, 0);
+                std::vector<uint8_t> data(file->getMaxChannel() + 1);
+                for (uint32_t f = 0; f < file->getNumFrames(); f++) {
+                    std::unique_ptr<FSEQFile::FrameData> fd(file->getFrame(f));
+                    if (fd != nullptr) {
+                        fd->readFrame(&data[0], data.size());
+                    }
+                }
+                double ms = sw.TimeInMicro().ToDouble() / 1000.0;
+                bench.Set("fseq_read_ms", ms);
+                bench.Set("fseq_read_fps", ms > 0.0 ? file->getNumFrames() * 1000.0 / ms : 0.0);
+            }
+        }
+        wxRemoveFile(fseq);
+
+        logger_base.info("Render benchmark %s: %s", (const char*)CurrentSeqXmlFile->GetName().c_str(), (const char*)bench.ToJSON().c_str());
+
+        if (params["saveBaseline"] != "") {
+            bench.Save(params["saveBaseline"]);
+        }
+        std::string response = "{\"results\":" + bench.ToJSON();
+        if (params["baseline"] != "") {
+            if (!bench.LoadBaseline(params["baseline"])) {
+                return sendResponse("Unable to read benchmark baseline.", "msg", 503, false);
+            }
+            double tolerance = params["tolerance"] == "" ? 5.0 : wxAtof(params["tolerance"]);
+            int regressions = 0;
+            response += ",\"comparison\":" + bench.CompareJSON(tolerance, regressions);
+        }
+        response += "}";
+        return sendResponse(response, "", 200, true);
+    } else if (cmd == "benchmarkEffects") {
+        // Renders samples of every effect type used in the open sequence on their own on matrices of
+        // various sizes so the cost of each effect can be measured and compared against a baseline.
+        static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+        if (CurrentSeqXmlFile == nullptr) {
+            return sendResponse("No sequence open.", "msg", 503, false);
+        }
+        int frames = params["frames"] == "" ? 100 : std::max(1, wxAtoi(params["frames"]));
+        int samples = params["samples"] == "" ? 3 : std::max(1, wxAtoi(params["samples"]));
+        std::string filter = params["effect"];
+        // the raw frames can be kept so a later run can check its output is within a tolerance of them
+        std::string saveRenders = params["saveRenders"];
+        std::string baselineRenders = params["baselineRenders"];
+        // layer settings such as B_SLIDER_Blur=5,B_SLIDER_Zoom=20 put every frame through the layer blur, rotation and
+        // zoom after the effect renders so that code is timed and checked against the baseline frames too
+        SettingsMap layerSettings;
+        layerSettings.Parse(params["layerSettings"]);
+
+        std::vector<std::pair<int, int>> sizes;
+        wxArrayString sz = wxSplit(params["sizes"] == "" ? "10x10,50x50,100x100,500x500" : params["sizes"], ',');
+        for (const auto& it : sz) {
+            int w = wxAtoi(it.BeforeFirst('x'));
+            int h = wxAtoi(it.AfterFirst('x'));
+            if (w > 0 && h > 0) {
+                sizes.push_back(std::pair<int, int>(w, h));
+            }
+        }
+        if (sizes.empty()) {
+            return sendResponse("No valid buffer sizes.", "msg", 503, false);
+        }
+
+        // the effects in the sequence carry realistic settings, palettes, value curves and timing/audio links
+        std::map<std::string, std::vector<Effect*>> effects;
+        for (size_t i = 0; i < _sequenceElements.GetElementCount(); i++) {
+            Element* el = _sequenceElements.GetElement(i);
+            if (el->GetType() != ElementType::ELEMENT_TYPE_MODEL) {
+                continue;
+            }
+            for (size_t l = 0; l < el->GetEffectLayerCount(); l++) {
+                EffectLayer* layer = el->GetEffectLayer(l);
+                for (int e = 0; e < layer->GetEffectCount(); e++) {
+                    Effect* ef = layer->GetEffect(e);
+                    if (ef->GetEffectIndex() < 0 || ef->IsRenderDisabled() || (filter != "" && ef->GetEffectName() != filter)) {
+                        continue;
+                    }
+                    auto& v = effects[ef->GetEffectName()];
+                    if ((int)v.size() < samples) {
+                        v.push_back(ef);
+                    }
+                }
+            }
+        }
+        std::vector<std::string> fromSequence;
+        for (const auto& it : effects) {
+            fromSequence.push_back(it.first);
+        }
+
+        // effects the sequence does not use are rendered with their default settings on a scratch element so every
+        // effect gets measured ... the scratch element is not part of the sequence
+        int frameMS = CurrentSeqXmlFile->GetFrameMS();
+        unsigned int changeCount = _sequenceElements.GetChangeCount();
+        std::unique_ptr<ModelElement> scratch;
+        std::vector<std::string> defaults;
+        for (const auto& reff : effectManager) {
+            const std::string& name = reff->Name();
+            if (effects.find(name) != effects.end() || (filter != "" && name != filter)) {
+                continue;
+            }
+            if (scratch == nullptr) {
+                scratch = std::make_unique<ModelElement>(&_sequenceElements, "xLightsBenchmarkMatrix", false);
+                scratch->AddEffectLayer();
+            }
+            Effect* ef = scratch->GetEffectLayer(0)->AddEffect(0, name, "", "C_BUTTON_Palette1=#FFFFFF,C_CHECKBOX_Palette1=1", 0, frames * frameMS, 0, false);
+            if (ef != nullptr && ef->GetEffectIndex() >= 0) {
+                effects[name].push_back(ef);
+                defaults.push_back(name);
+            }
+        }
+        if (effects.empty()) {
+            return sendResponse("No effects to benchmark.", "msg", 503, false);
+        }
+
+        RenderBenchmark bench;
+        bench.Set("frames", frames);
+        for (const auto& size : sizes) {
+            wxXmlNode* node = new wxXmlNode(wxXML_ELEMENT_NODE, "model");
+            node->AddAttribute("name", "xLightsBenchmarkMatrix");
+            node->AddAttribute("DisplayAs", "Vert Matrix");
+            node->AddAttribute("StringType", "RGB Nodes");
+            node->AddAttribute("StartSide", "B");
+            node->AddAttribute("Dir", "L");
+            node->AddAttribute("parm1", wxString::Format("%d", size.first));
+            node->AddAttribute("parm2", wxString::Format("%d", size.second));
+            node->AddAttribute("parm3", "1");
+            node->AddAttribute("StartChannel", "1");
+            node->AddAttribute("LayoutGroup", "Unassigned");
+            Model* model = AllModels.CreateModel(node);
+            if (model == nullptr) {
+                delete node;
+                continue;
+            }
+
+            for (const auto& it : effects) {
+                std::string name = it.first + "_" + std::to_string(size.first) + "x" + std::to_string(size.second);
+                uint64_t nanos = 0;
+                uint64_t blurZoomNanos = 0;
+                uint64_t pixels = 0;
+                uint64_t checksum = FNV1A_SEED;
+                wxFile saveFile;
+                if (saveRenders != "" && !saveFile.Create(saveRenders + wxFileName::GetPathSeparator() + name + ".rgba", true)) {
+                    logger_base.warn("Unable to save benchmark render %s.", (const char*)name.c_str());
+                }
+                wxFile baselineFile;
+                std::string baselineName = baselineRenders + wxFileName::GetPathSeparator() + name + ".rgba";
+                bool compare = baselineRenders != "" && FileExists(baselineName) && baselineFile.Open(baselineName);
+                std::vector<xlColor> baselinePx;
+                int maxDiff = 0;
+                for (const auto& ef : it.second) {
+                    PixelBufferClass buffer(this);
+                    buffer.InitBuffer(*model, 1, frameMS);
+                    SettingsMap settings;
+                    ef->CopySettingsMap(settings, true);
+                    for (const auto& ls : layerSettings) {
+                        // stripped of their B_ prefix as CopySettingsMap does
+                        settings[ls.first.size() > 2 && ls.first[1] == '_' ? ls.first.substr(2) : ls.first] = ls.second;
+                    }
+                    buffer.SetLayerSettings(0, settings);
+                    xlColorVector colors;
+                    xlColorCurveVector cc;
+                    ef->CopyPalette(colors, cc);
+                    buffer.SetPalette(0, colors, cc);
+                    int startFrame = ef->GetStartTimeMS() / frameMS;
+                    buffer.SetTimes(0, ef->GetStartTimeMS(), std::max(ef->GetEndTimeMS(), (startFrame + frames) * frameMS));
+
+                    RenderBuffer& rb = buffer.BufferForLayer(0, -1);
+                    bool reset = true;
+                    for (int f = 0; f < frames; f++) {
+                        auto start = std::chrono::steady_clock::now();
+                        RenderEffectFromMap(false, ef, 0, startFrame + f, settings, buffer, reset, false, nullptr);
+                        nanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                        if (!layerSettings.empty()) {
+                            start = std::chrono::steady_clock::now();
+                            buffer.HandleLayerBlurZoom(startFrame + f, 0);
+                            blurZoomNanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                        }
+                        pixels += rb.GetPixelCount();
+                        const xlColor* px = rb.GetPixels();
+                        for (uint32_t p = 0; p < rb.GetPixelCount(); p++) {
+                            checksum = FNV1a(checksum, px[p].GetRGB() | ((uint32_t)px[p].alpha << 24));
+                        }
+                        if (saveFile.IsOpened()) {
+                            saveFile.Write(px, rb.GetPixelCount() * sizeof(xlColor));
+                        }
+                        if (compare) {
+                            size_t bytes = rb.GetPixelCount() * sizeof(xlColor);
+                            baselinePx.resize(rb.GetPixelCount());
+                            if (baselineFile.Read(&baselinePx[0], bytes) != (ssize_t)bytes) {
+                                // a different number of frames or buffer size ... nothing to compare
+                                maxDiff = 256;
+                                compare = false;
+                                continue;
+                            }
+                            for (uint32_t p = 0; p < rb.GetPixelCount(); p++) {
+                                maxDiff = std::max({ maxDiff, std::abs(px[p].red - baselinePx[p].red), std::abs(px[p].green - baselinePx[p].green),
+                                                     std::abs(px[p].blue - baselinePx[p].blue), std::abs(px[p].alpha - baselinePx[p].alpha) });
+                            }
+                        }
+                    }
+                }
+                if (baselineFile.IsOpened()) {
+                    bench.SetRenderDifference(name, maxDiff);
+                }
+                bench.Set(name + "_ns_per_pixel", pixels > 0 ? (double)nanos / pixels : 0.0);
+                bench.Set(name + "_frame_ms", (double)nanos / 1000000.0 / (frames * it.second.size()));
+                if (!layerSettings.empty()) {
+                    bench.Set(name + "_blur_zoom_frame_ms", (double)blurZoomNanos / 1000000.0 / (frames * it.second.size()));
+                }
+                bench.SetChecksum(name, checksum);
+            }
+            delete model;
+            delete node;
+        }
+        scratch.reset();
+        // adding the scratch effects counted as a change ... the sequence itself has not changed
+        if (mSavedChangeCount == changeCount) {
+            mSavedChangeCount = _sequenceElements.GetChangeCount();
+        }
+
+        logger_base.info("Effect benchmark %s: %s", (const char*)CurrentSeqXmlFile->GetName().c_str(), (const char*)bench.ToJSON().c_str());
+
+        if (params["saveBaseline"] != "") {
+            bench.Save(params["saveBaseline"]);
+        }
+        auto names = [](const std::vector<std::string>& v) {
+            std::string res;
+            for (const auto& it : v) {
+                res += (res == "" ? "\"" : ",\"") + it + "\"";
+            }
+            return "[" + res + "]";
+        };
+        std::string response = "{\"results\":" + bench.ToJSON() + ",\"fromsequence\":" + names(fromSequence) + ",\"defaults\":" + names(defaults);
+        if (params["baseline"] != "" && !bench.LoadBaseline(params["baseline"])) {
+            return sendResponse("Unable to read benchmark baseline.", "msg", 503, false);
+        }
+        if (params["baseline"] != "" || baselineRenders != "") {
+            double tolerance = params["tolerance"] == "" ? 5.0 : wxAtof(params["tolerance"]);
+            int pixelTolerance = params["pixelTolerance"] == "" ? 0 : wxAtoi(params["pixelTolerance"]);
+            int regressions = 0;
+            response += ",\"comparison\":" + bench.CompareJSON(tolerance, regressions, pixelTolerance);
+        }
+        response += "}";
+        return sendResponse(response, "", 200, true);
     } else if (cmd == "uploadController") {
         auto ip = params["ip"];
         Controller* c = _outputManager.GetControllerWithIP(ip);
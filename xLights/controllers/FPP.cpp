@@ -29,6 +29,8 @@
 #include <wx/protocol/http.h>
 #include <wx/config.h>
 #include <wx/secretstore.h>
+#include <wx/stdpaths.h>
+#include <wx/textfile.h>
 #include <zstd.h>
 
 #include "../xSchedule/wxJSON/jsonreader.h"
@@ -699,6 +701,9 @@ bool FPP::uploadFile(const std::string &filename, const std::string &file) {
     setupCurl();
     //if we cannot upload it in 5 minutes, we have serious issues
     curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, 1000*5*60);
+    if (uploadSpeedLimit != 0) {
+        curl_easy_setopt(curl, CURLOPT_MAX_SEND_SPEED_LARGE, (curl_off_t)uploadSpeedLimit);
+    }
 
     curlInputBuffer.clear();
     char error[1024];
@@ -901,6 +906,11 @@ bool FPP::PrepareUploadSequence(const FSEQFile &file,
         ::wxRemoveFile(tempFileName);
         tempFileName = "";
     }
+    uploadSource = nullptr;
+    uploadKey = "";
+    remoteSequenceId = "";
+    uploadSequenceId = "";
+    uploadManifest.clear();
 
     wxFileName fn(seq);
     std::string baseName = fn.GetFullName();
@@ -971,7 +981,8 @@ bool FPP::PrepareUploadSequence(const FSEQFile &file,
             if ((type == 0 || type == 3) && currentCompression != 0) {
                 doSeqUpload = true;
             }
-            if (currentMeta["ID"].AsString() != buf) doSeqUpload = true;
+            remoteSequenceId = currentMeta["ID"].AsString();
+            if (remoteSequenceId != buf) doSeqUpload = true;
             if (currentMeta["NumFrames"].AsLong() != file.getNumFrames()) doSeqUpload = true;
             if (currentMeta["StepTime"].AsLong() != file.getStepTime()) doSeqUpload = true;
 
@@ -1064,6 +1075,15 @@ bool FPP::PrepareUploadSequence(const FSEQFile &file,
     if (IsVersionAtLeast(5, 0)) {
         outputFile->enableMinorVersionFeatures(1);
     }
+    if (tempFileName != "" && fppType == FPP_TYPE::FPP) {
+        // everything that goes into the generated file
+        uploadKey = seq + "|" + std::to_string(type) + "|" + std::to_string(clevel) + "|" + (IsVersionAtLeast(5, 0) ? "5" : "4");
+        if (type >= 2) {
+            for (const auto& a : newRanges) {
+                uploadKey += "|" + std::to_string(a.first) + "-" + std::to_string(a.second);
+            }
+        }
+    }
     if (type >= 2 && !newRanges.empty()) {
         for (auto &a : newRanges) {
             ((V2FSEQFile*)outputFile)->m_sparseRanges.push_back(a);
@@ -1074,7 +1094,7 @@ bool FPP::PrepareUploadSequence(const FSEQFile &file,
 }
 
 bool FPP::WillUploadSequence() const {
-    return outputFile != nullptr;
+    return outputFile != nullptr || uploadSource != nullptr;
 }
 
 bool FPP::AddFrameToUpload(uint32_t frame, uint8_t *data) {
@@ -1085,21 +1105,220 @@ bool FPP::AddFrameToUpload(uint32_t frame, uint8_t *data) {
 }
 
 bool FPP::FinalizeUploadSequence() {
-    bool cancelled = false;
+    FinishUploadSequence();
+    bool cancelled = SendUploadSequence();
+    ReleaseUploadSequence();
+    return cancelled;
+}
+
+void FPP::ShareUploadSequence(FPP* source) {
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+    if (source == this || outputFile == nullptr || uploadKey == "" || uploadKey != source->uploadKey) {
+        return;
+    }
+    logger_base.debug("FPPConnect %s will upload the fseq generated for %s.", (const char*)ipAddress.c_str(), (const char*)source->ipAddress.c_str());
+    delete outputFile;
+    outputFile = nullptr;
+    ::wxRemoveFile(tempFileName);
+    tempFileName = "";
+    uploadSource = source;
+}
+
+// Splits a generated fseq into its header (minus the unique id) and its compression blocks ... or 1MB
+// chunks if it is not compressed ... and hashes each of them
+static bool ComputeUploadManifest(const std::string& filename, std::vector<uint64_t>& manifest, std::string& id) {
+    manifest.clear();
+    id = "";
+    wxFile file(filename);
+    if (!file.IsOpened() || file.Length() < 32) {
+        return false;
+    }
+    uint64_t length = file.Length();
+
+    // the header is small ... the channel data is streamed through a fixed buffer as sequences run to hundreds of MB
+    std::vector<uint8_t> data(32);
+    if (file.Read(&data[0], data.size()) != data.size() || data[0] != 'P' || data[1] != 'S' || data[2] != 'E' || data[3] != 'Q') {
+        return false;
+    }
+    size_t offset = data[4] | (data[5] << 8);
+    if (offset > length) {
+        return false;
+    }
+    if (offset > data.size()) {
+        size_t read = data.size();
+        data.resize(offset);
+        if (file.Read(&data[read], offset - read) != offset - read) {
+            return false;
+        }
+    }
+    auto read4 = [&data](size_t o) {
+        return (uint32_t)data[o] | ((uint32_t)data[o + 1] << 8) | ((uint32_t)data[o + 2] << 16) | ((uint32_t)data[o + 3] << 24);
+    };
+
+    std::vector<uint8_t> header(data.begin(), data.begin() + offset);
+    std::vector<size_t> blocks;
+    if (data[7] == 2) {
+        uint64_t uid = 0;
+        memcpy(&uid, &data[24], sizeof(uid));
+        id = std::to_string(uid);
+        if (header.size() >= 32) {
+            memset(&header[24], 0, 8);
+        }
+
+        int compression = data[20] & 0x0F;
+        int maxBlocks = ((data[20] & 0xF0) << 4) | data[21];
+        if (compression != 0) {
+            for (int b = 0; b < maxBlocks && 32 + b * 8 + 8 <= offset; b++) {
+                uint32_t len = read4(32 + b * 8 + 4);
+                if (len != 0) {
+                    blocks.push_back(len);
+                }
+            }
+        }
+    }
+    manifest.push_back(FNV1aBytes(FNV1A_SEED, header.data(), header.size()));
+
+    if (file.Seek(offset) == wxInvalidOffset) {
+        return false;
+    }
+    std::vector<uint8_t> buffer(1024 * 1024);
+    auto hashNext = [&file, &buffer](uint64_t len, uint64_t& h) {
+        h = FNV1A_SEED;
+        while (len > 0) {
+            size_t chunk = std::min((uint64_t)buffer.size(), len);
+            if (file.Read(&buffer[0], chunk) != chunk) {
+                return false;
+            }
+            h = FNV1aBytes(h, buffer.data(), chunk);
+            len -= chunk;
+        }
+        return true;
+    };
+    uint64_t pos = offset;
+    for (uint64_t len : blocks) {
+        len = std::min(len, length - pos);
+        uint64_t h;
+        if (!hashNext(len, h)) {
+            return false;
+        }
+        manifest.push_back(h);
+        pos += len;
+    }
+    while (pos < length) {
+        uint64_t len = std::min((uint64_t)(1024 * 1024), length - pos);
+        uint64_t h;
+        if (!hashNext(len, h)) {
+            return false;
+        }
+        manifest.push_back(h);
+        pos += len;
+    }
+    return true;
+}
+
+// The manifest of the last sequence uploaded to an instance is remembered so an upload where nothing
+// changed can be skipped
+static std::string GetUploadManifestFile(const std::string& ip, const std::string& seq) {
+    wxString name = ip + "_" + seq + ".manifest";
+    for (auto c : std::string("\\/:*?\"<>|")) {
+        name.Replace(wxString(c), "_");
+    }
+    wxString dir = wxStandardPaths::Get().GetTempDir() + wxFileName::GetPathSeparator() + "xLightsFPPUploads";
+    if (!wxDirExists(dir)) {
+        wxMkdir(dir);
+    }
+    return (dir + wxFileName::GetPathSeparator() + name).ToStdString();
+}
+
+static bool ReadUploadManifest(const std::string& filename, std::string& id, std::vector<uint64_t>& manifest) {
+    wxTextFile file(filename);
+    if (!wxFileExists(filename) || !file.Open() || file.GetLineCount() < 1) {
+        return false;
+    }
+    id = file.GetFirstLine().ToStdString();
+    manifest.clear();
+    for (size_t x = 1; x < file.GetLineCount(); x++) {
+        manifest.push_back(std::strtoull(file[x].c_str(), nullptr, 16));
+    }
+    return true;
+}
+
+static void WriteUploadManifest(const std::string& filename, const std::string& id, const std::vector<uint64_t>& manifest) {
+    wxFile file;
+    if (file.Create(filename, true)) {
+        file.Write(id + "\n");
+        for (auto h : manifest) {
+            file.Write(wxString::Format("%016llx\n", (unsigned long long)h));
+        }
+    }
+}
+
+void FPP::FinishUploadSequence() {
     if (outputFile) {
         outputFile->finalize();
 
         delete outputFile;
         outputFile = nullptr;
-        if (tempFileName != "" && (fppType == FPP_TYPE::FPP || fppType == FPP_TYPE::ESPIXELSTICK)) {
-            cancelled = uploadOrCopyFile(baseSeqName, tempFileName, "sequences");
-            ::wxRemoveFile(tempFileName);
-            tempFileName = "";
+        if (tempFileName != "" && fppType == FPP_TYPE::FPP) {
+            ComputeUploadManifest(tempFileName, uploadManifest, uploadSequenceId);
+        }
+    }
+}
+
+bool FPP::SendUploadSequence() {
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+    if (fppType != FPP_TYPE::FPP && fppType != FPP_TYPE::ESPIXELSTICK) {
+        return false;
+    }
+    const FPP* from = uploadSource != nullptr ? uploadSource : this;
+    if (from->tempFileName == "") {
+        return false;
+    }
+
+    std::string manifestFile;
+    if (!from->uploadManifest.empty()) {
+        manifestFile = GetUploadManifestFile(ipAddress, from->baseSeqName);
+        std::string lastId;
+        std::vector<uint64_t> lastManifest;
+        if (ReadUploadManifest(manifestFile, lastId, lastManifest)) {
+            size_t changed = 0;
+            for (size_t x = 0; x < from->uploadManifest.size(); x++) {
+                if (x >= lastManifest.size() || lastManifest[x] != from->uploadManifest[x]) {
+                    changed++;
+                }
+            }
+            if (changed == 0 && lastManifest.size() == from->uploadManifest.size() && lastId == remoteSequenceId) {
+                // the instance still has the sequence we sent last time and only the unique id would change
+                logger_base.debug("FPPConnect %s already has identical data for %s, skipping upload.", (const char*)ipAddress.c_str(), (const char*)from->baseSeqName.c_str());
+                return false;
+            }
+            logger_base.debug("FPPConnect %s: %d of %d blocks of %s changed since the last upload.", (const char*)ipAddress.c_str(), (int)changed, (int)from->uploadManifest.size(), (const char*)from->baseSeqName.c_str());
+        }
+    }
+
+    size_t errors = messages.size();
+    bool cancelled = uploadOrCopyFile(from->baseSeqName, from->tempFileName, "sequences");
+    if (manifestFile != "") {
+        if (!cancelled && errors == messages.size()) {
+            WriteUploadManifest(manifestFile, from->uploadSequenceId, from->uploadManifest);
+        } else {
+            wxRemoveFile(manifestFile);
         }
     }
     return cancelled;
 }
 
+void FPP::ReleaseUploadSequence() {
+    // Falcons upload the temp file themselves once it has been generated
+    if (tempFileName != "" && (fppType == FPP_TYPE::FPP || fppType == FPP_TYPE::ESPIXELSTICK)) {
+        ::wxRemoveFile(tempFileName);
+        tempFileName = "";
+    }
+    uploadSource = nullptr;
+    uploadKey = "";
+    uploadManifest.clear();
+}
+
 bool FPP::UploadPlaylist(const std::string &name) {
     wxJSONValue origJson;
     std::string fn;
@@ -85,6 +85,16 @@ class FPP : public BaseController
     bool WillUploadSequence() const;
     bool AddFrameToUpload(uint32_t frame, uint8_t *data);
     bool FinalizeUploadSequence();
+
+    // Instances which would generate byte for byte identical fseq files can share one encoded file.
+    // The key is empty if the sequence cannot be shared (drives, direct uploads, non FPP devices)
+    const std::string& GetUploadSequenceKey() const { return uploadKey; }
+    void ShareUploadSequence(FPP* source);
+    // FinalizeUploadSequence split into its stages so the uploads of several instances can run concurrently
+    void FinishUploadSequence();
+    bool SendUploadSequence();
+    void ReleaseUploadSequence();
+    uint64_t uploadSpeedLimit = 0; // bytes per second, 0 for unlimited
     std::string GetTempFile() const { return tempFileName; }
     void ClearTempFile() { tempFileName = ""; }
 #endif
@@ -180,6 +190,11 @@ private:
     std::string tempFileName;
     std::string baseSeqName;
     FSEQFile *outputFile = nullptr;
+    FPP *uploadSource = nullptr;
+    std::string uploadKey;
+    std::string remoteSequenceId;          // ID of the sequence currently on the instance
+    std::string uploadSequenceId;          // ID of the generated sequence
+    std::vector<uint64_t> uploadManifest;  // hashes of the header and each block of the generated sequence
 
     void setupCurl();
     CURL *curl = nullptr;
@@ -3,6 +3,9 @@
 #include <wx/string.h>
 //*)
 
+#include <atomic>
+#include <thread>
+
 #include <wx/regex.h>
 #include <wx/volume.h>
 #include <wx/progdlg.h>
@@ -741,6 +744,72 @@ void FPPConnectDialog::LoadSequences()
     CheckListBox_Sequences->SetColumnWidth(0, wxCOL_WIDTH_AUTOSIZE);
 }
 
+// Uploads the generated sequence to several instances at once. The number of concurrent uploads
+// and the total bandwidth they may use are bounded so a large show does not flood the network
+bool FPPConnectDialog::SendSequenceUploads(const std::list<FPP*>& insts, const std::string& name, wxProgressDialog& prgs)
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+    if (insts.empty()) {
+        return false;
+    }
+
+    wxConfigBase* config = wxConfigBase::Get();
+    int concurrent = config->ReadLong("FPPConnectConcurrentUploads", 4);
+    long bandwidth = config->ReadLong("FPPConnectUploadBandwidthKBps", 0);
+    if (concurrent < 1) concurrent = 1;
+    if (concurrent > insts.size()) concurrent = insts.size();
+
+    std::vector<FPP*> todo(insts.begin(), insts.end());
+    std::vector<wxProgressDialog*> progress;
+    for (auto inst : todo) {
+        // progress is reported from here as the uploads are not on the ui thread
+        progress.push_back(inst->progressDialog);
+        inst->progressDialog = nullptr;
+        inst->uploadSpeedLimit = bandwidth > 0 ? (uint64_t)bandwidth * 1024 / concurrent : 0;
+    }
+
+    logger_base.debug("FPPConnect uploading %s to %d instances, %d at a time.", (const char*)name.c_str(), (int)todo.size(), concurrent);
+    wxStopWatch sw;
+    std::atomic_bool cancelled(false);
+    std::atomic_int next(0);
+    std::atomic_int done(0);
+    std::atomic_int running(concurrent);
+    std::vector<std::thread> workers;
+    for (int x = 0; x < concurrent; x++) {
+        workers.emplace_back([&todo, &cancelled, &next, &done, &running]() {
+            int i = next++;
+            while (i < todo.size() && !cancelled) {
+                if (todo[i]->SendUploadSequence()) {
+                    cancelled = true;
+                }
+                done++;
+                i = next++;
+            }
+            running--;
+        });
+    }
+
+    prgs.SetTitle("FPP Upload");
+    while (running > 0) {
+        std::string msg = "Uploading " + name + " to " + std::to_string(todo.size()) + " FPP instances";
+        if (!prgs.Update(done * 1000 / todo.size(), msg)) {
+            // in flight uploads complete, no new ones are started
+            cancelled = true;
+        }
+        wxYield();
+        wxMilliSleep(50);
+    }
+    for (auto& w : workers) {
+        w.join();
+    }
+    for (size_t x = 0; x < todo.size(); x++) {
+        todo[x]->progressDialog = progress[x];
+        todo[x]->uploadSpeedLimit = 0;
+    }
+    logger_base.debug("FPPConnect uploads of %s took %ldms.", (const char*)name.c_str(), sw.Time());
+    return cancelled;
+}
+
 void FPPConnectDialog::OnButton_UploadClick(wxCommandEvent& event)
 {
     static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
@@ -876,6 +945,20 @@ void FPPConnectDialog::OnButton_UploadClick(wxCommandEvent& event)
                     }
                     row++;
                 }
+                // instances that would generate identical files only generate it once
+                std::map<std::string, FPP*> encoders;
+                row = 0;
+                for (const auto& inst : instances) {
+                    if (!cancelled && doUpload[row] && inst->WillUploadSequence() && inst->GetUploadSequenceKey() != "") {
+                        auto it = encoders.find(inst->GetUploadSequenceKey());
+                        if (it == encoders.end()) {
+                            encoders[inst->GetUploadSequenceKey()] = inst;
+                        } else {
+                            inst->ShareUploadSequence(it->second);
+                        }
+                    }
+                    row++;
+                }
                 if (!cancelled && uploadCount) {
                     prgs.SetTitle("Generating FSEQ Files");
                     cancelled |= !prgs.Update(0, "Generating " + wxFileName(fseq).GetFullName());
@@ -921,11 +1004,27 @@ void FPPConnectDialog::OnButton_UploadClick(wxCommandEvent& event)
                         };
                         parallel_for(instances, func);
                     }
+                    std::list<FPP*> toSend;
                     row = 0;
-                    for (const auto &inst : instances) {
+                    for (const auto& inst : instances) {
                         if (!cancelled && doUpload[row]) {
-                            cancelled |= inst->FinalizeUploadSequence();
+                            inst->FinishUploadSequence();
+                            if (inst->fppType != FPP_TYPE::FALCONV4) {
+                                toSend.push_back(inst);
+                            }
+                        }
+                        row++;
+                    }
+                    if (!cancelled) {
+                        cancelled |= SendSequenceUploads(toSend, wxFileName(fseq).GetFullName(), prgs);
+                    }
+                    for (const auto& inst : toSend) {
+                        inst->ReleaseUploadSequence();
+                    }
 
+                    row = 0;
+                    for (const auto &inst : instances) {
+                        if (!cancelled && doUpload[row]) {
                             if (inst->fppType == FPP_TYPE::FALCONV4) {
                                 // a falcon
                                 std::string proxy = "";
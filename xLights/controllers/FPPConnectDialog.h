@@ -93,6 +93,7 @@ class FPPConnectDialog: public wxDialog
         void LoadSequencesFromFolder(wxString dir) const;
         void LoadSequences();
         void PopulateFPPInstanceList(wxProgressDialog *prgs = nullptr);
+        bool SendSequenceUploads(const std::list<FPP*>& insts, const std::string& name, wxProgressDialog& prgs);
         void AddInstanceRow(const FPP &inst);
         wxPanel *AddInstanceHeader(const std::string &h, const std::string &tt = std::string());
 
@@ -100,15 +100,38 @@ void ButterflyEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuf
     const double offset = (ButterflyDirection==1 ? -1 : 1) * double(curState)/200.0;
     const int xc=buffer.BufferWi/2;
     const int yc=buffer.BufferHt/2;
+
+    // the butterfly styles only vary the sine along the diagonals
+    std::vector<float> diagonal;
+    if (Style == 1 || Style == 4 || Style == 5) {
+        float divisor = Style == 5 ? float(buffer.BufferHt * buffer.BufferWi) : float(buffer.BufferHt + buffer.BufferWi);
+        diagonal.resize(buffer.BufferWi + buffer.BufferHt + 1);
+        for (size_t i = 0; i < diagonal.size(); i++) {
+            diagonal[i] = buffer.sin(offset + ((int)i * pi2 / divisor));
+        }
+    }
+
+    // plasma terms which are the same for the whole frame
+    int state = (buffer.curPeriod - buffer.curEffStartPer); // frames 0 to N
+    double Speed_plasma = (Style == 10) ? (101-butterFlySpeed)*3 : (101-butterFlySpeed)*5;
+    const double time = (state+1.0)/Speed_plasma;
+    const double sin_time_2 = buffer.sin(time/2);
+    const double cos_time_3 = buffer.cos(time/3);
+    const double sin_time_5 = buffer.sin(time/5);
+
     int block = buffer.BufferHt * buffer.BufferWi > 100 ? 1 : -1;
-    parallel_for(0, buffer.BufferWi, [&buffer, Style, &xc, &yc, &offset, frame, maxframe, Chunks, colorcnt, Skip, ColorScheme, butterFlySpeed](int x) {
+    parallel_for(0, buffer.BufferWi, [&buffer, Style, &xc, &yc, frame, maxframe, Chunks, colorcnt, Skip, ColorScheme, &diagonal, time, sin_time_2, cos_time_3, sin_time_5](int x) {
         double  fractpart, intpart;
         double h=0.0,hue1,hue2;
         xlColor color;
         HSVValue hsv;
         int y, d, x0, y0;
         double n,x1,y1,f;
-        double rx,ry,cx,cy,v,time,multiplier;
+        double rx,ry,cx,cy,v,multiplier;
+
+        rx = ((float)x/buffer.BufferWi) -0.5;
+        const double sin_rx10_time = buffer.sin(rx*10+time);
+        const double sin_rx_time = buffer.sin(rx+time);
 
         for (y=0; y<buffer.BufferHt; y++)
         {
@@ -116,7 +139,7 @@ void ButterflyEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuf
             {
                 case 1:
                     //  http://mathworld.wolfram.com/ButterflyFunction.html
-                    n = std::abs((x*x - y*y) * buffer.sin (offset + ((x+y)*pi2 / float(buffer.BufferHt+buffer.BufferWi))));
+                    n = std::abs((x*x - y*y) * diagonal[x+y]);
                     d = x*x + y*y;
                     
                     //  This section is to fix the colors on pixels at {0,1} and {1,0}
@@ -124,12 +147,12 @@ void ButterflyEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuf
                     y0=y+1;
                     if((x==0 && y==1))
                     {
-                        n = std::abs((x*x - y0*y0) * buffer.sin (offset + ((x+y0)*pi2 / float(buffer.BufferHt+buffer.BufferWi))));
+                        n = std::abs((x*x - y0*y0) * diagonal[x+y0]);
                         d = x*x + y0*y0;
                     }
                     if((x==1 && y==0))
                     {
-                        n = std::abs((x0*x0 - y*y) * buffer.sin (offset + ((x0+y)*pi2 / float(buffer.BufferHt+buffer.BufferWi))));
+                        n = std::abs((x0*x0 - y*y) * diagonal[x0+y]);
                         d = x0*x0 + y*y;
                     }
                     // end of fix
@@ -154,7 +177,7 @@ void ButterflyEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuf
                     
                 case 4:
                     //  http://mathworld.wolfram.com/ButterflyFunction.html
-                    n = ((x*x - y*y) * buffer.sin (offset + ((x+y)*pi2 / float(buffer.BufferHt+buffer.BufferWi))));
+                    n = ((x*x - y*y) * diagonal[x+y]);
                     d = x*x + y*y;
                     
                     //  This section is to fix the colors on pixels at {0,1} and {1,0}
@@ -162,12 +185,12 @@ void ButterflyEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuf
                     y0=y+1;
                     if((x==0 && y==1))
                     {
-                        n = ((x*x - y0*y0) * buffer.sin (offset + ((x+y0)*pi2 / float(buffer.BufferHt+buffer.BufferWi))));
+                        n = ((x*x - y0*y0) * diagonal[x+y0]);
                         d = x*x + y0*y0;
                     }
                     if((x==1 && y==0))
                     {
-                        n = ((x0*x0 - y*y) * buffer.sin (offset + ((x0+y)*pi2 / float(buffer.BufferHt+buffer.BufferWi))));
+                        n = ((x0*x0 - y*y) * diagonal[x0+y]);
                         d = x0*x0 + y*y;
                     }
                     // end of fix
@@ -180,7 +203,7 @@ void ButterflyEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuf
                     
                 case 5:
                     //  http://mathworld.wolfram.com/ButterflyFunction.html
-                    n = std::abs((x*x - y*y) * buffer.sin (offset + ((x+y)*pi2 / float(buffer.BufferHt*buffer.BufferWi))));
+                    n = std::abs((x*x - y*y) * diagonal[x+y]);
                     d = x*x + y*y;
                     
                     //  This section is to fix the colors on pixels at {0,1} and {1,0}
@@ -188,12 +211,12 @@ void ButterflyEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuf
                     y0=y+1;
                     if((x==0 && y==1))
                     {
-                        n = std::abs((x*x - y0*y0) * buffer.sin (offset + ((x+y0)*pi2 / float(buffer.BufferHt*buffer.BufferWi))));
+                        n = std::abs((x*x - y0*y0) * diagonal[x+y0]);
                         d = x*x + y0*y0;
                     }
                     if((x==1 && y==0))
                     {
-                        n = std::abs((x0*x0 - y*y) * buffer.sin (offset + ((x0+y)*pi2 / float(buffer.BufferHt*buffer.BufferWi))));
+                        n = std::abs((x0*x0 - y*y) * diagonal[x0+y]);
                         d = x0*x0 + y*y;
                     }
                     // end of fix
@@ -226,31 +249,26 @@ void ButterflyEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuf
             {
                 // reference: http://www.bidouille.org/prog/plasma
                 
-                int state = (buffer.curPeriod - buffer.curEffStartPer); // frames 0 to N
-                double Speed_plasma = (Style == 10) ? (101-butterFlySpeed)*3 : (101-butterFlySpeed)*5;
-                time = (state+1.0)/Speed_plasma;
-                
                 v=0;
                 
-                rx = ((float)x/buffer.BufferWi) -0.5;
                 ry = ((float)y/buffer.BufferHt) -0.5;
                 
                 
                 
                 // 1st equation
-                v=buffer.sin(rx*10+time);
+                v=sin_rx10_time;
                 
                 //  second equation
-                v+=buffer.sin(10*(rx*buffer.sin(time/2)+ry*buffer.cos(time/3))+time);
+                v+=buffer.sin(10*(rx*sin_time_2+ry*cos_time_3)+time);
                 
                 //  third equation
-                cx=rx+.5*buffer.sin(time/5);
-                cy=ry+.5*buffer.cos(time/3);
+                cx=rx+.5*sin_time_5;
+                cy=ry+.5*cos_time_3;
                 v+=buffer.sin ( sqrt(100*((cx*cx)+(cy*cy))+1+time));
                 
                 
                 //    vec2 c = v_coords * u_k - u_k/2.0;
-                v += buffer.sin(rx+time);
+                v += sin_rx_time;
                 v += buffer.sin((ry+time)/2.0);
                 v += buffer.sin((rx+ry+time)/2.0);
                 //   c += u_k/2.0 * vec2(sin(u_time/3.0), cos(u_time/2.0));
@@ -108,11 +108,11 @@ void CandleEffect::SetDefaultParameters()
     SetCheckBoxValue(fp->CheckBox_PerNode, false);
 }
 
-void CandleEffect::Update(wxByte& flameprime, wxByte& flame, wxByte& wind, size_t windVariability, size_t flameAgility, size_t windCalmness, size_t windBaseline)
+void CandleEffect::Update(RenderRandom& rng, wxByte& flameprime, wxByte& flame, wxByte& wind, size_t windVariability, size_t flameAgility, size_t windCalmness, size_t windBaseline)
 {
     // We simulate a gust of wind by setting the wind var to a random value
-    if (wxByte(rand01() * 255.0) < windVariability) {
-        wind = wxByte(rand01() * 255.0);
+    if (wxByte(rng.Rand01() * 255.0) < windVariability) {
+        wind = wxByte(rng.Rand01() * 255.0);
     }
 
     // The wind constantly settles towards its baseline value
@@ -127,8 +127,8 @@ void CandleEffect::Update(wxByte& flameprime, wxByte& flame, wxByte& wind, size_
 
     // Depending on the wind strength and the calmness modifier we calculate the odds
     // of the wind knocking down the flame by setting it to random values
-    if (wxByte(rand01() * 255) < (wind >> windCalmness)) {
-        flame = wxByte(rand01() * 255);
+    if (wxByte(rng.Rand01() * 255) < (wind >> windCalmness)) {
+        flame = wxByte(rng.Rand01() * 255);
     }
 
     // Real flames ook like they have inertia so we use this constant-aproach-rate filter
@@ -147,20 +147,20 @@ void CandleEffect::Update(wxByte& flameprime, wxByte& flame, wxByte& wind, size_
     // We don't. It adds to the realism.
 }
 
-void InitialiseState(int node, std::map<int, CandleState*>& states)
+void InitialiseState(RenderBuffer& buffer, int node, std::map<int, CandleState*>& states)
 {
     if (states.find(node) == states.end()) {
         CandleState* state = new CandleState();
         states[node] = state;
     }
 
-    states[node]->flamer = rand01() * 255;
-    states[node]->flameprimer = rand01() * 255;
+    states[node]->flamer = buffer.Rand01() * 255;
+    states[node]->flameprimer = buffer.Rand01() * 255;
 
-    states[node]->flameg = rand01() * states[node]->flamer;
-    states[node]->flameprimeg = rand01() * states[node]->flameprimer;
+    states[node]->flameg = buffer.Rand01() * states[node]->flamer;
+    states[node]->flameprimeg = buffer.Rand01() * states[node]->flameprimer;
 
-    states[node]->wind = rand01() * 255;
+    states[node]->wind = buffer.Rand01() * 255;
 }
 
 // 10 <= HeightPct <= 100
@@ -183,16 +183,20 @@ void CandleEffect::Render(Effect* effect, SettingsMap& SettingsMap, RenderBuffer
             for (size_t x = 0; x < buffer.BufferWi; ++x) {
                 for (size_t y = 0; y < buffer.BufferHt; ++y) {
                     size_t index = y * buffer.BufferWi + x;
-                    InitialiseState(index, states);
+                    InitialiseState(buffer, index, states);
                 }
             }
         } else {
-            InitialiseState(0, states);
+            InitialiseState(buffer, 0, states);
         }
     }
 
     if (perNode) {
-        parallel_for(0, buffer.BufferHt, [&buffer, &states, windVariability, flameAgility, windCalmness, windBaseline, this](int y) {
+        // each row gets its own generator so the result doesnt depend on how the rows are split between threads
+        uint64_t randomBase = buffer.GetRandom().Next();
+        parallel_for(0, buffer.BufferHt, [&buffer, &states, windVariability, flameAgility, windCalmness, windBaseline, randomBase, this](int y) {
+            RenderRandom rng;
+            rng.Seed(FNV1a(randomBase, (uint64_t)y));
             for (size_t x = 0; x < buffer.BufferWi; x++) {
                 size_t index = y * buffer.BufferWi + x;
                 if (index >= states.size()) {
@@ -201,8 +205,8 @@ void CandleEffect::Render(Effect* effect, SettingsMap& SettingsMap, RenderBuffer
                 } else {
                     CandleState* state = states[index];
 
-                    Update(state->flameprimer, state->flamer, state->wind, windVariability, flameAgility, windCalmness, windBaseline);
-                    Update(state->flameprimeg, state->flameg, state->wind, windVariability, flameAgility, windCalmness, windBaseline);
+                    Update(rng, state->flameprimer, state->flamer, state->wind, windVariability, flameAgility, windCalmness, windBaseline);
+                    Update(rng, state->flameprimeg, state->flameg, state->wind, windVariability, flameAgility, windCalmness, windBaseline);
 
                     if (state->flameprimeg > state->flameprimer)
                         state->flameprimeg = state->flameprimer;
@@ -218,8 +222,8 @@ void CandleEffect::Render(Effect* effect, SettingsMap& SettingsMap, RenderBuffer
     } else {
         CandleState* state = states[0];
 
-        Update(state->flameprimer, state->flamer, state->wind, windVariability, flameAgility, windCalmness, windBaseline);
-        Update(state->flameprimeg, state->flameg, state->wind, windVariability, flameAgility, windCalmness, windBaseline);
+        Update(buffer.GetRandom(), state->flameprimer, state->flamer, state->wind, windVariability, flameAgility, windCalmness, windBaseline);
+        Update(buffer.GetRandom(), state->flameprimeg, state->flameg, state->wind, windVariability, flameAgility, windCalmness, windBaseline);
 
         if (state->flameprimeg > state->flameprimer)
             state->flameprimeg = state->flameprimer;
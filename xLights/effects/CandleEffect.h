@@ -24,6 +24,8 @@
 #define CANDLE_WINDCALMNESS_MIN 0
 #define CANDLE_WINDCALMNESS_MAX 10
 
+class RenderRandom;
+
 class CandleEffect : public RenderableEffect
 {
     public:
@@ -34,5 +36,5 @@ class CandleEffect : public RenderableEffect
         virtual std::list<std::string> CheckEffectSettings(const SettingsMap& settings, AudioManager* media, Model* model, Effect* eff, bool renderCache) override;
 protected:
         virtual xlEffectPanel *CreatePanel(wxWindow *parent) override;
-        void Update(wxByte& flameprime, wxByte& flame, wxByte& wind, size_t windVariability, size_t flameAgility, size_t windCalmness, size_t windBaseline);
+        void Update(RenderRandom& rng, wxByte& flameprime, wxByte& flame, wxByte& wind, size_t windVariability, size_t flameAgility, size_t windCalmness, size_t windBaseline);
 };
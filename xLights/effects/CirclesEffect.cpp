@@ -203,11 +203,11 @@ void CirclesEffect::Render(Effect* effect, SettingsMap& SettingsMap, RenderBuffe
             float spd;
             if (ii >= cache->numBalls || buffer.needToInit)
             {
-                start_x = rand() % (buffer.BufferWi);
-                start_y = rand() % (buffer.BufferHt);
+                start_x = buffer.Rand() % (buffer.BufferWi);
+                start_y = buffer.Rand() % (buffer.BufferHt);
                 colorIdx = ii % colorCnt;
-                angle = rand() % 2 ? rand() % 90 : -rand() % 90;
-                spd = rand() % 3 + 1;
+                angle = buffer.Rand() % 2 ? buffer.Rand() % 90 : -buffer.Rand() % 90;
+                spd = buffer.Rand() % 3 + 1;
             }
             else
             {
@@ -220,8 +220,8 @@ void CirclesEffect::Render(Effect* effect, SettingsMap& SettingsMap, RenderBuffe
             effectObjects[ii].Reset((float)start_x, (float)start_y, spd, angle, (float)radius, colorIdx);
             if (bubbles) //keep bubbles going mostly up
             {
-                // This looks odd ... rand() is 0-1 so % 45 is going to be rand()
-                angle = 90 + rand() % 45 - 22.5f; //+/- 22.5 degrees from 90 degrees
+                // This looks odd ... buffer.Rand() is 0-1 so % 45 is going to be buffer.Rand()
+                angle = 90 + buffer.Rand() % 45 - 22.5f; //+/- 22.5 degrees from 90 degrees
                 angle *= 2.0f * (float)M_PI / 180.0f;
                 effectObjects[ii]._dx = spd * cos(angle);
                 effectObjects[ii]._dy = spd * sin(angle);
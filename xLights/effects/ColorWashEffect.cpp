@@ -151,6 +151,13 @@ void ColorWashEffect::RemoveDefaults(const std::string &version, Effect *effect)
     RenderableEffect::RemoveDefaults(version, effect);
 }
 
+bool ColorWashEffect::IsStatic(Effect* effect, const SettingsMap& settings, const RenderBuffer& buffer) const
+{
+    // with one plain colour there is nothing to wash through
+    return buffer.palette.Size() == 1 && !buffer.palette.GetColorCurve(0).IsActive() &&
+           !settings.GetBool(CHECKBOX_ColorWash_Shimmer) && !HasActiveValueCurves(settings);
+}
+
 void ColorWashEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffer &buffer) {
 
     float oset = buffer.GetEffectTimeIntervalPosition();
@@ -214,7 +221,20 @@ void ColorWashEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuf
         orig = xlBLACK;
     }
     std::unique_lock<std::recursive_mutex> lock(effect->GetBackgroundDisplayList().lock);
-    if (VertFade || HorizFade) {
+    if (IsStatic(effect, SettingsMap, buffer)) {
+        // later frames may reuse this one without rendering so draw the background for the whole effect now
+        if (buffer.needToInit) {
+            buffer.needToInit = false;
+            if (VertFade || HorizFade) {
+                effect->GetBackgroundDisplayList().resize(6 * 2);
+                buffer.SetDisplayListVRect(effect, 0, 0.0, 0.0, 1.0, 0.5, xlBLACK, orig);
+                buffer.SetDisplayListVRect(effect, 6, 0.0, 0.5, 1.0, 1.0, orig, xlBLACK);
+            } else {
+                effect->GetBackgroundDisplayList().resize(6);
+                buffer.SetDisplayListHRect(effect, 0, 0.0, 0.0, 1.0, 1.0, orig, orig);
+            }
+        }
+    } else if (VertFade || HorizFade) {
         effect->GetBackgroundDisplayList().resize((buffer.curEffEndPer - buffer.curEffStartPer + 1) * 6 * 2);
         int total = buffer.curEffEndPer - buffer.curEffStartPer + 1;
         double x1 = double(buffer.curPeriod - buffer.curEffStartPer) / double(total);
@@ -25,6 +25,7 @@ public:
     virtual bool needToAdjustSettings(const std::string& version) override;
     virtual void adjustSettings(const std::string& version, Effect* effect, bool removeDefaults = true) override;
     virtual bool CanRenderPartialTimeInterval() const override { return true; }
+    virtual bool IsStatic(Effect* effect, const SettingsMap& settings, const RenderBuffer& buffer) const override;
 
 protected:
     virtual void RemoveDefaults(const std::string& version, Effect* effect) override;
@@ -542,14 +542,23 @@ uint32_t map(uint32_t value, uint32_t in_low, uint32_t in_high, uint32_t out_low
     return ((float)value / ((float)in_high - (float)in_low + 1)) * ((float)out_high - (float)out_low + 1) + (float)out_low;
 }
 
+// the random numbers come from the buffer being rendered on this thread so renders are repeatable
+static thread_local RenderRandom* s_fxRandom = nullptr;
+
+static RenderRandom& fxRandom()
+{
+    static thread_local RenderRandom fallback;
+    return s_fxRandom != nullptr ? *s_fxRandom : fallback;
+}
+
 void random16_set_seed(int seed)
 {
-    srand(seed);
+    fxRandom().Seed(seed);
 }
 
 uint16_t random16(uint16_t limit = 0xFFFF)
 {
-    return (uint16_t)(rand01() * limit);
+    return (uint16_t)(fxRandom().Rand01() * limit);
 }
 
 uint32_t WS2812FX::millis() const
@@ -560,27 +569,27 @@ uint32_t WS2812FX::millis() const
 
 uint16_t random16(uint16_t low, uint16_t high)
 {
-    return (uint16_t)(rand01() * (high - low + 1)) + low;
+    return (uint16_t)(fxRandom().Rand01() * (high - low + 1)) + low;
 }
 
 uint32_t random(uint32_t limit = 0xFFFF)
 {
-    return (uint32_t)(rand01() * limit);
+    return (uint32_t)(fxRandom().Rand01() * limit);
 }
 
 uint32_t random(uint32_t low, uint32_t high)
 {
-    return (rand01() * (float)(high - low + 1)) + low;
+    return (fxRandom().Rand01() * (float)(high - low + 1)) + low;
 }
 
 uint8_t WS2812FX::random8(uint8_t limit)
 {
-    return (uint8_t)(rand01() * (float)limit);
+    return (uint8_t)(fxRandom().Rand01() * (float)limit);
 }
 
 uint8_t WS2812FX::random8(uint8_t low, uint8_t high)
 {
-    return (uint8_t)(rand01() * (float)(high - low + 1)) + low;
+    return (uint8_t)(fxRandom().Rand01() * (float)(high - low + 1)) + low;
 }
 
 /// scale a 16-bit unsigned value by a 16-bit value,
@@ -1576,6 +1585,7 @@ void WS2812FX::SetBuffer(RenderBuffer* buffer)
 {
     _buffer = buffer;
     _length = buffer->BufferWi;
+    s_fxRandom = &buffer->GetRandom();
 }
 
 void WS2812FX::setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b, uint8_t w)
@@ -5217,7 +5227,7 @@ uint16_t WS2812FX::mode_phased_noise(void) {
 uint16_t WS2812FX::mode_twinkleup(void) {                 // A very short twinkle routine with fade-in and dual controls. By Andrew Tuline.
   
 #ifdef XLIGHTS_FX
-    auto oldSeed = rand();
+    RenderRandom oldRandom = fxRandom();
 #endif
   random16_set_seed(535); // The randomizer needs to be re-set each time through the loop in order for the same 'random' numbers to be the same each time through.
 
@@ -5229,7 +5239,7 @@ uint16_t WS2812FX::mode_twinkleup(void) {                 // A very short twinkl
   }
 
 #ifdef XLIGHTS_FX
-  random16_set_seed(oldSeed);
+  fxRandom() = oldRandom;
 #endif
 
   return FRAMETIME;
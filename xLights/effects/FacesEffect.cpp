@@ -14,6 +14,7 @@
 #include "FacesPanel.h"
 #include "../models/Model.h"
 #include "../models/SubModel.h"
+#include "../models/FaceStateDefinition.h"
 #include "../models/ModelGroup.h"
 #include "../sequencer/SequenceElements.h"
 #include "../sequencer/Effect.h"
@@ -30,16 +31,21 @@
 
 #include <log4cpp/Category.hh>
 
+// random blink times from the buffer so renders are repeatable
+static int BlinkRand(RenderBuffer& buffer, int min, int max)
+{
+    return min + buffer.Rand() % (max - min + 1);
+}
+
 class FacesRenderCache : public EffectRenderCache {
     std::map<std::string, RenderBuffer*> _imageCache;
 
 public:
     int blinkEndTime;
     int nextBlinkTime;
-    std::map<std::string, int> nodeNameCache;
 
-    FacesRenderCache() :
-        blinkEndTime(0), nextBlinkTime(intRand(0, 5000)) {
+    FacesRenderCache(RenderBuffer& buffer) :
+        blinkEndTime(0), nextBlinkTime(BlinkRand(buffer, 0, 5000)) {
     }
     virtual ~FacesRenderCache() {
         for (auto it : _imageCache) {
@@ -47,9 +53,6 @@ public:
         }
         _imageCache.clear();
     }
-    void Clear() {
-        nodeNameCache.clear();
-    }
     RenderBuffer* GetImage(std::string key) {
         if (_imageCache.find(key) != _imageCache.end()) {
             return _imageCache[key];
@@ -658,7 +661,7 @@ void FacesEffect::drawoutline(RenderBuffer& buffer, int Phoneme, bool outline, c
 
     FacesRenderCache* cache = (FacesRenderCache*)buffer.infoCache[id];
     if (cache == nullptr) {
-        cache = new FacesRenderCache();
+        cache = new FacesRenderCache(buffer);
         buffer.infoCache[id] = cache;
     }
 
@@ -677,7 +680,7 @@ void FacesEffect::drawoutline(RenderBuffer& buffer, int Phoneme, bool outline, c
         if (Phoneme == 9 || Phoneme == 10) {
             if ((buffer.curPeriod * buffer.frameTimeInMs) >= cache->nextBlinkTime) {
                 //roughly every 5 seconds we'll blink
-                cache->nextBlinkTime += intRand(4500, 5500);
+                cache->nextBlinkTime += BlinkRand(buffer, 4500, 5500);
                 cache->blinkEndTime = buffer.curPeriod * buffer.frameTimeInMs + 101; //100ms blink
                 eye = "Closed";
             } else if ((buffer.curPeriod * buffer.frameTimeInMs) < cache->blinkEndTime) {
@@ -878,14 +881,13 @@ void FacesEffect::RenderFaces(RenderBuffer& buffer,
 
     FacesRenderCache* cache = (FacesRenderCache*)buffer.infoCache[id];
     if (cache == nullptr) {
-        cache = new FacesRenderCache();
+        cache = new FacesRenderCache(buffer);
         buffer.infoCache[id] = cache;
     }
 
     if (buffer.needToInit) {
         buffer.needToInit = false;
         elements->AddRenderDependency(trackName, buffer.cur_model);
-        cache->Clear();
     }
     std::string eyes = eyesIn;
 
@@ -912,15 +914,6 @@ void FacesEffect::RenderFaces(RenderBuffer& buffer,
         return;
     }
 
-    if (cache->nodeNameCache.empty()) {
-        for (size_t x = 0; x < model_info->GetNodeCount(); x++) {
-            cache->nodeNameCache[model_info->GetNodeName(x, true)] = x;
-            if (model_info->GetNodeName(x, true) != wxString::Format("Node %d", (int)x + 1)) {
-                cache->nodeNameCache[wxString::Format("Node %d", (int)x + 1)] = x;
-            }
-        }
-    }
-
     std::string definition = faceDef;
     if ((definition == "Default" || definition == "") && !model_info->faceInfo.empty() && model_info->faceInfo.begin()->first != "") {
         definition = model_info->faceInfo.begin()->first;
@@ -954,10 +947,8 @@ void FacesEffect::RenderFaces(RenderBuffer& buffer,
         }
     }
 
-    std::string modelType = found ? model_info->faceInfo[definition]["Type"] : definition;
-    if (modelType == "") {
-        modelType = definition;
-    }
+    std::shared_ptr<const FaceStateDefinition> def = found ? model_info->GetFaceDefinition(definition) : nullptr;
+    std::string modelType = def != nullptr ? def->GetType() : definition;
 
     int type = 3;
 
@@ -986,7 +977,7 @@ void FacesEffect::RenderFaces(RenderBuffer& buffer,
             if ("Auto" == eyes) {
                 if ((buffer.curPeriod * buffer.frameTimeInMs) >= cache->nextBlinkTime) {
                     //roughly every 5 seconds we'll blink
-                    cache->nextBlinkTime += intRand(4500, 5500);
+                    cache->nextBlinkTime += BlinkRand(buffer, 4500, 5500);
                     cache->blinkEndTime = buffer.curPeriod * buffer.frameTimeInMs + 101; //100ms blink
                     eyes = "Closed";
                 } else if ((buffer.curPeriod * buffer.frameTimeInMs) < cache->blinkEndTime) {
@@ -1029,7 +1020,7 @@ void FacesEffect::RenderFaces(RenderBuffer& buffer,
                 if ((buffer.curPeriod * buffer.frameTimeInMs) >= cache->nextBlinkTime) {
                     if ((startms + 150) >= (buffer.curPeriod * buffer.frameTimeInMs)) {
                         //don't want to blink RIGHT at the start of the rest, delay a little bie
-                        int tmp = (buffer.curPeriod * buffer.frameTimeInMs) + intRand(150, 549);
+                        int tmp = (buffer.curPeriod * buffer.frameTimeInMs) + BlinkRand(buffer, 150, 549);
 
                         //also don't want it right at the end
                         if ((tmp + 130) > endms) {
@@ -1039,7 +1030,7 @@ void FacesEffect::RenderFaces(RenderBuffer& buffer,
                         }
                     } else {
                         //roughly every 5 seconds we'll blink
-                        cache->nextBlinkTime += intRand(4500, 5500);
+                        cache->nextBlinkTime += BlinkRand(buffer, 4500, 5500);
                         cache->blinkEndTime = buffer.curPeriod * buffer.frameTimeInMs + 101; //100ms blink
                         eyes = "Closed";
                     }
@@ -1054,7 +1045,7 @@ void FacesEffect::RenderFaces(RenderBuffer& buffer,
         if ("Auto" == eyes) {
             if ((buffer.curPeriod * buffer.frameTimeInMs) >= cache->nextBlinkTime) {
                 //roughly every 5 seconds we'll blink
-                cache->nextBlinkTime += intRand(4500, 5500);
+                cache->nextBlinkTime += BlinkRand(buffer, 4500, 5500);
                 cache->blinkEndTime = buffer.curPeriod * buffer.frameTimeInMs + 101; //100ms blink
                 eyes = "Closed";
             } else if ((buffer.curPeriod * buffer.frameTimeInMs) < cache->blinkEndTime) {
@@ -1069,136 +1060,60 @@ void FacesEffect::RenderFaces(RenderBuffer& buffer,
     xlColor color;
     buffer.palette.GetColor(0, color); //use first color for mouth; user must make sure it matches model node type
 
-    bool customColor = found ? model_info->faceInfo[definition]["CustomColors"] == "1" : false;
+    bool customColor = def != nullptr && def->HasCustomColors();
 
     wxString pp = phoneme;
     std::string p = pp.BeforeFirst('-');
     bool shimmer = pp.Lower().EndsWith("-shimmer");
 
-    std::vector<std::string> todo;
-    std::vector<xlColor> colors;
-    if (p != "(off)") {
-        todo.push_back("Mouth-" + p);
-        colorOffset = 1;
+    struct FacePart
+    {
+        int id;
+        xlColor color;
+        bool mouth;
+        bool outline;
+    };
+    std::vector<FacePart> todo;
+    auto addPart = [&](const std::string& name, const xlColor& paletteColor, bool front) {
+        FacePart part;
+        part.id = def != nullptr ? def->GetPartId(name) : -1;
+        part.color = paletteColor;
         if (customColor) {
-            std::string cname = model_info->faceInfo[definition]["Mouth-" + p + "-Color"];
-            if (cname == "") {
-                colors.push_back(xlWHITE);
-                colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
-            } else {
-                colors.push_back(xlColor(cname));
-                colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
-            }
-        } else {
-            colors.push_back(color);
-            colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
+            part.color = part.id != -1 ? def->GetPart(part.id).color : xlWHITE;
         }
+        part.color.alpha = ((int)alpha * part.color.alpha) / 255;
+        part.mouth = StartsWith(name, "Mouth-");
+        part.outline = name == "FaceOutline";
+        todo.insert(front ? todo.begin() : todo.end(), part);
+    };
+
+    if (p != "(off)") {
+        addPart("Mouth-" + p, color, false);
+        colorOffset = 1;
     }
     if (buffer.palette.Size() > colorOffset) {
         buffer.palette.GetColor(colorOffset, color); //use second color for eyes; user must make sure it matches model node type
     }
     if (eyes == "Open" || eyes == "Auto") {
-        todo.push_back("Eyes-Open");
-        if (customColor) {
-            std::string cname = model_info->faceInfo[definition]["Eyes-Open-Color"];
-            if (cname == "") {
-                colors.push_back(xlWHITE);
-                colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
-            } else {
-                colors.push_back(xlColor(cname));
-                colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
-            }
-        } else {
-            colors.push_back(color);
-            colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
+        addPart("Eyes-Open", color, false);
+        if (buffer.palette.Size() > colorOffset + 3) {
+            buffer.palette.GetColor(colorOffset + 3, color); //use fifth colour
         }
-
-        todo.push_back("Eyes-Open2");
-        if (customColor) {
-            std::string cname = model_info->faceInfo[definition]["Eyes-Open2-Color"];
-            if (cname == "") {
-                colors.push_back(xlWHITE);
-                colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
-            } else {
-                colors.push_back(xlColor(cname));
-                colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
-            }
-        } else {
-            if (buffer.palette.Size() > colorOffset + 3) {
-                buffer.palette.GetColor(colorOffset + 3, color); //use fifth colour
-            }
-            colors.push_back(color);
-            colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
-        }
-
-        todo.push_back("Eyes-Open3");
-        if (customColor) {
-            std::string cname = model_info->faceInfo[definition]["Eyes-Open3-Color"];
-            if (cname == "") {
-                colors.push_back(xlWHITE);
-                colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
-            } else {
-                colors.push_back(xlColor(cname));
-                colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
-            }
-        } else {
-            if (buffer.palette.Size() > colorOffset + 4) {
-                buffer.palette.GetColor(colorOffset + 4, color); //use sixth colour
-            }
-            colors.push_back(color);
-            colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
+        addPart("Eyes-Open2", color, false);
+        if (buffer.palette.Size() > colorOffset + 4) {
+            buffer.palette.GetColor(colorOffset + 4, color); //use sixth colour
         }
+        addPart("Eyes-Open3", color, false);
     } else if (eyes == "Closed") {
-        todo.push_back("Eyes-Closed");
-        if (customColor) {
-            std::string cname = model_info->faceInfo[definition]["Eyes-Closed-Color"];
-            if (cname == "") {
-                colors.push_back(xlWHITE);
-                colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
-            } else {
-                colors.push_back(xlColor(cname));
-                colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
-            }
-        } else {
-            colors.push_back(color);
-            colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
-        }
-
-        todo.push_back("Eyes-Closed2");
-        if (customColor) {
-            std::string cname = model_info->faceInfo[definition]["Eyes-Closed2-Color"];
-            if (cname == "") {
-                colors.push_back(xlWHITE);
-                colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
-            } else {
-                colors.push_back(xlColor(cname));
-                colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
-            }
-        } else {
-            if (buffer.palette.Size() > colorOffset + 3) {
-                buffer.palette.GetColor(colorOffset + 3, color); //use fifth colour
-            }
-            colors.push_back(color);
-            colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
+        addPart("Eyes-Closed", color, false);
+        if (buffer.palette.Size() > colorOffset + 3) {
+            buffer.palette.GetColor(colorOffset + 3, color); //use fifth colour
         }
-
-        todo.push_back("Eyes-Closed3");
-        if (customColor) {
-            std::string cname = model_info->faceInfo[definition]["Eyes-Closed3-Color"];
-            if (cname == "") {
-                colors.push_back(xlWHITE);
-                colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
-            } else {
-                colors.push_back(xlColor(cname));
-                colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
-            }
-        } else {
-            if (buffer.palette.Size() > colorOffset + 4) {
-                buffer.palette.GetColor(colorOffset + 4, color); //use sixth colour
-            }
-            colors.push_back(color);
-            colors.back().alpha = ((int)alpha * colors.back().alpha) / 255;
+        addPart("Eyes-Closed2", color, false);
+        if (buffer.palette.Size() > colorOffset + 4) {
+            buffer.palette.GetColor(colorOffset + 4, color); //use sixth colour
         }
+        addPart("Eyes-Closed3", color, false);
     } else if (eyes == "(off)") {
         //no eyes
     }
@@ -1206,39 +1121,12 @@ void FacesEffect::RenderFaces(RenderBuffer& buffer,
         buffer.palette.GetColor((1 + colorOffset), color); //use third color for outline; user must make sure it matches model node type
     }
     if (face_outline) {
-        todo.insert(todo.begin(), "FaceOutline");
-        if (customColor) {
-            std::string cname = model_info->faceInfo[definition]["FaceOutline-Color"];
-            if (cname == "") {
-                colors.insert(colors.begin(), xlWHITE);
-                colors.front().alpha = ((int)alpha * colors.front().alpha) / 255;
-            } else {
-                colors.insert(colors.begin(), xlColor(cname));
-                colors.front().alpha = ((int)alpha * colors.front().alpha) / 255;
-            }
-        } else {
-            colors.insert(colors.begin(), color);
-            colors.front().alpha = ((int)alpha * colors.front().alpha) / 255;
-        }
+        addPart("FaceOutline", color, true);
 
         if (buffer.palette.Size() > (2 + colorOffset)) {
             buffer.palette.GetColor((2 + colorOffset), color); //use forth color for outline 2; user must make sure it matches model node type
         }
-
-        todo.insert(todo.begin(), "FaceOutline2");
-        if (customColor) {
-            std::string const cname = model_info->faceInfo[definition]["FaceOutline2-Color"];
-            if (cname == "") {
-                colors.insert(colors.begin(), xlWHITE);
-                colors.front().alpha = ((int)alpha * colors.front().alpha) / 255;
-            } else {
-                colors.insert(colors.begin(), xlColor(cname));
-                colors.front().alpha = ((int)alpha * colors.front().alpha) / 255;
-            }
-        } else {
-            colors.insert(colors.begin(), color);
-            colors.front().alpha = ((int)alpha * colors.front().alpha) / 255;
-        }
+        addPart("FaceOutline2", color, true);
     }
 
     if (type == 2) {
@@ -1256,21 +1144,21 @@ void FacesEffect::RenderFaces(RenderBuffer& buffer,
         }
         std::string key = "Mouth-" + p + "-Eyes";
         std::string picture = "";
-        if (model_info->faceInfo[definition].find(key + e) != model_info->faceInfo[definition].end()) {
-            picture = model_info->faceInfo[definition][key + e];
-        }
-        if (picture == "" && e == "Closed") {
-            if (model_info->faceInfo[definition].find(key + "Open") != model_info->faceInfo[definition].end()) {
-                picture = model_info->faceInfo[definition][key + "Open"];
+        std::string placement = "";
+        if (def != nullptr) {
+            picture = def->GetValue(key + e);
+            if (picture == "" && e == "Closed") {
+                picture = def->GetValue(key + "Open");
             }
+            placement = def->GetValue("ImagePlacement");
         }
         std::string dirstr = "none"; /*RENDER_PICTURE_NONE*/
         std::string stf = "Scale To Fit";
-        if (model_info->faceInfo[definition]["ImagePlacement"] == "Centered") {
+        if (placement == "Centered") {
             stf = "No Scaling";
-        } else if (model_info->faceInfo[definition]["ImagePlacement"] == "Scale Keep Aspect Ratio" ||
-                   model_info->faceInfo[definition]["ImagePlacement"] == "Scale Keep Aspect Ratio Crop") {
-            stf = model_info->faceInfo[definition]["ImagePlacement"];
+        } else if (placement == "Scale Keep Aspect Ratio" ||
+                   placement == "Scale Keep Aspect Ratio Crop") {
+            stf = placement;
         }
         RenderBuffer* crb = cache->GetImage(MakeKey(buffer.BufferWi, buffer.BufferHt, dirstr, picture, stf));
         if (crb == nullptr) {
@@ -1296,78 +1184,31 @@ void FacesEffect::RenderFaces(RenderBuffer& buffer,
             }
         }
     }
-    for (size_t t = 0; t < todo.size(); t++) {
-        if (shimmer && StartsWith(todo[t], "Mouth-")) {
+    for (const auto& part : todo) {
+        if (shimmer && part.mouth) {
             if ((buffer.curPeriod - buffer.curEffStartPer) % 3 == 0)
                 continue;
         }
-        std::string channels = model_info->faceInfo[definition][todo[t]];
-        wxStringTokenizer wtkz(channels, ",");
-        while (wtkz.HasMoreTokens()) {
-            wxString valstr = wtkz.GetNextToken();
-
-            if (type == 0) {
-                auto it2 = cache->nodeNameCache.find(valstr.ToStdString());
-                if (it2 != cache->nodeNameCache.end()) {
-                    int n = it2->second;
-                    buffer.SetNodePixel(n, colors[t], true);
-                }
-            } else if (type == 1) {
-                int start, end;
-                if (valstr.Contains("-")) {
-                    int idx = valstr.Index('-');
-                    start = wxAtoi(valstr.Left(idx));
-                    end = wxAtoi(valstr.Right(valstr.size() - idx - 1));
-                    if (end < start) {
-                        std::swap(start, end);
-                    }
-                } else {
-                    start = end = wxAtoi(valstr);
-                }
-                if (start > end) {
-                    start = end;
-                }
-                start--;
-                end--;
-                for (int n = start; n <= end; n++) {
-                    buffer.SetNodePixel(n, colors[t], true);
+        if (part.id != -1) {
+            for (const auto& span : def->GetPart(part.id).spans) {
+                for (int n = span.first; n <= span.second; n++) {
+                    buffer.SetNodePixel(n, part.color, true);
                 }
             }
         }
 
-        if (todo[t] == "FaceOutline" && outlineState != "") {
-            auto sts = model_info->stateInfo[outlineState];
-            if (sts["CustomColors"] == "1") {
-                if (sts["Type"] == "NodeRange") {
-                    for (size_t i = 1; i <= 40; i++) {
-                        auto r = sts[wxString::Format("s%d", (int)i)];
-                        auto c = sts[wxString::Format("s%d-Color", (int)i)];
-                        if (r != "") {
-                            xlColor colour = xlColor(c);
-                            colour.alpha = ((int)alpha * colour.alpha) / 255;
-                            wtkz = wxStringTokenizer(r, ",");
-                            while (wtkz.HasMoreTokens()) {
-                                wxString valstr = wtkz.GetNextToken();
-
-                                int start, end;
-                                if (valstr.Contains("-")) {
-                                    int idx = valstr.Index('-');
-                                    start = wxAtoi(valstr.Left(idx));
-                                    end = wxAtoi(valstr.Right(valstr.size() - idx - 1));
-                                    if (end < start) {
-                                        std::swap(start, end);
-                                    }
-                                } else {
-                                    start = end = wxAtoi(valstr);
-                                }
-                                if (start > end) {
-                                    start = end;
-                                }
-                                start--;
-                                end--;
-                                for (int n = start; n <= end; n++) {
-                                    buffer.SetNodePixel(n, colour, true);
-                                }
+        if (part.outline && outlineState != "") {
+            std::shared_ptr<const FaceStateDefinition> sts = model_info->GetStateDefinition(outlineState);
+            if (sts != nullptr && sts->HasCustomColors() && sts->GetValue("Type") == "NodeRange") {
+                for (size_t i = 1; i <= 40; i++) {
+                    int id = sts->GetPartId(wxString::Format("s%d", (int)i).ToStdString());
+                    if (id != -1 && sts->GetPart(id).value != "") {
+                        const FaceStateDefinition::Part& state = sts->GetPart(id);
+                        xlColor colour = state.hasColor ? state.color : xlBLACK;
+                        colour.alpha = ((int)alpha * colour.alpha) / 255;
+                        for (const auto& span : state.spans) {
+                            for (int n = span.first; n <= span.second; n++) {
+                                buffer.SetNodePixel(n, colour, true);
                             }
                         }
                     }
@@ -33,6 +33,8 @@
 #define FIREWORKSYLOCATION_MIN -1
 #define FIREWORKSYLOCATION_MAX 100
 
+class RenderRandom;
+
 class FireworksEffect : public RenderableEffect
 {
     public:
@@ -47,7 +49,7 @@ class FireworksEffect : public RenderableEffect
 protected:
         virtual xlEffectPanel *CreatePanel(wxWindow *parent) override;
         void SetPanelTimingTracks() const;
-        static std::pair<int, int> GetFireworkLocation(int width, int height, int overridex = -1, int overridey = -1);
+        static std::pair<int, int> GetFireworkLocation(RenderRandom& rng, int width, int height, int overridex = -1, int overridey = -1);
         virtual bool needToAdjustSettings(const std::string &version) override;
         virtual void adjustSettings(const std::string &version, Effect *effect, bool removeDefaults = true) override;
 };
@@ -211,14 +211,17 @@ void GalaxyEffect::Render(Effect* effect, SettingsMap& SettingsMap, RenderBuffer
             if (half_width > current_distance) {
                 current_width = std::sqrt(half_width * half_width - current_distance * current_distance);
                 double inside_radius = std::max(0.0, current_radius - current_width);
+                // the angle is the same all the way across the arm
+                double sin_angle = buffer.sin(ToRadians(adj_angle));
+                double cos_angle = buffer.cos(ToRadians(adj_angle));
                 for (double r = inside_radius;; r += 0.5) {
                     if (r > current_radius)
                         r = current_radius;
-                    double x1 = buffer.sin(ToRadians(adj_angle)) * r + (double)pos_x;
-                    double y1 = buffer.cos(ToRadians(adj_angle)) * r + (double)pos_y;
+                    double x1 = sin_angle * r + (double)pos_x;
+                    double y1 = cos_angle * r + (double)pos_y;
                     double outside_radius = current_radius + (current_radius - r);
-                    double x2 = buffer.sin(ToRadians(adj_angle)) * outside_radius + (double)pos_x;
-                    double y2 = buffer.cos(ToRadians(adj_angle)) * outside_radius + (double)pos_y;
+                    double x2 = sin_angle * outside_radius + (double)pos_x;
+                    double y2 = cos_angle * outside_radius + (double)pos_y;
                     double head_fade_pct = 1.0 - (current_distance / half_width);
                     head_fade_pct = std::max(0.0, head_fade_pct);
                     head_fade_pct = std::min(1.0, head_fade_pct);
@@ -273,14 +276,17 @@ void GalaxyEffect::Render(Effect* effect, SettingsMap& SettingsMap, RenderBuffer
         double current_width = width2 * pct + width1 * (1.0 - pct);
         half_width = current_width / 2.0;
         double inside_radius = current_radius - half_width;
+        // the angle is the same all the way across the arm
+        double sin_angle = buffer.sin(ToRadians(adj_angle));
+        double cos_angle = buffer.cos(ToRadians(adj_angle));
         for (double r = inside_radius;; r += 0.5) {
             if (r > current_radius)
                 r = current_radius;
-            double x1 = buffer.sin(ToRadians(adj_angle)) * r + (double)pos_x;
-            double y1 = buffer.cos(ToRadians(adj_angle)) * r + (double)pos_y;
+            double x1 = sin_angle * r + (double)pos_x;
+            double y1 = cos_angle * r + (double)pos_y;
             double outside_radius = current_radius + (current_radius - r);
-            double x2 = buffer.sin(ToRadians(adj_angle)) * outside_radius + (double)pos_x;
-            double y2 = buffer.cos(ToRadians(adj_angle)) * outside_radius + (double)pos_y;
+            double x2 = sin_angle * outside_radius + (double)pos_x;
+            double y2 = cos_angle * outside_radius + (double)pos_y;
             double color_pct2 = (r - inside_radius) / (current_radius - inside_radius);
             if (blend_edges) {
                 if (hsv.value > 0.0) {
@@ -346,14 +352,17 @@ void GalaxyEffect::Render(Effect* effect, SettingsMap& SettingsMap, RenderBuffer
             if (half_width > current_distance) {
                 current_width = std::sqrt(half_width * half_width - current_distance * current_distance);
                 double inside_radius = std::max(0.0, current_radius - current_width);
+                // the angle is the same all the way across the arm
+                double sin_angle = buffer.sin(ToRadians(adj_angle));
+                double cos_angle = buffer.cos(ToRadians(adj_angle));
                 for (double r = inside_radius;; r += 0.5) {
                     if (r > current_radius)
                         r = current_radius;
-                    double x1 = buffer.sin(ToRadians(adj_angle)) * r + (double)pos_x;
-                    double y1 = buffer.cos(ToRadians(adj_angle)) * r + (double)pos_y;
+                    double x1 = sin_angle * r + (double)pos_x;
+                    double y1 = cos_angle * r + (double)pos_y;
                     double outside_radius = current_radius + (current_radius - r);
-                    double x2 = buffer.sin(ToRadians(adj_angle)) * outside_radius + (double)pos_x;
-                    double y2 = buffer.cos(ToRadians(adj_angle)) * outside_radius + (double)pos_y;
+                    double x2 = sin_angle * outside_radius + (double)pos_x;
+                    double y2 = cos_angle * outside_radius + (double)pos_y;
                     double head_fade_pct = 1.0 - (current_distance / half_width);
                     head_fade_pct = std::max(0.0, head_fade_pct);
                     head_fade_pct = std::min(1.0, head_fade_pct);
@@ -60,6 +60,9 @@ class LifeRenderCache : public EffectRenderCache {
 public:
     LifeRenderCache() : LastLifeCount(0), LastLifeType(0), LastLifeState(0) {};
     virtual ~LifeRenderCache() {};
+    // the cells live in the buffer pixels
+    virtual EffectRenderCache* Checkpoint() const override { return new LifeRenderCache(*this); }
+    virtual size_t GetCheckpointSize() const override { return sizeof(*this); }
     int LastLifeCount;
     int LastLifeType;
     int LastLifeState;
@@ -105,9 +108,9 @@ void LifeEffect::Render(Effect* effect, SettingsMap& SettingsMap, RenderBuffer&
         cache->LastLifeType = Type;
         buffer.ClearTempBuf();
         for (i = 0; i < Count; i++) {
-            x = rand() % BufferWi;
-            y = rand() % BufferHt;
-            buffer.GetMultiColorBlend(rand01(), false, color);
+            x = buffer.Rand() % BufferWi;
+            y = buffer.Rand() % BufferHt;
+            buffer.GetMultiColorBlend(buffer.Rand01(), false, color);
             buffer.SetTempPixel(x, y, color);
         }
     }
@@ -137,7 +140,7 @@ void LifeEffect::Render(Effect* effect, SettingsMap& SettingsMap, RenderBuffer&
                 if (isLive && cnt >= 2 && cnt <= 3) {
                     buffer.SetPixel(x, y, color);
                 } else if (!isLive && cnt == 3) {
-                    buffer.GetMultiColorBlend(rand01(), false, color);
+                    buffer.GetMultiColorBlend(buffer.Rand01(), false, color);
                     buffer.SetPixel(x, y, color);
                 }
                 break;
@@ -146,7 +149,7 @@ void LifeEffect::Render(Effect* effect, SettingsMap& SettingsMap, RenderBuffer&
                 if (isLive && (cnt == 2 || cnt == 3 || cnt == 6)) {
                     buffer.SetPixel(x, y, color);
                 } else if (!isLive && (cnt == 3 || cnt == 5)) {
-                    buffer.GetMultiColorBlend(rand01(), false, color);
+                    buffer.GetMultiColorBlend(buffer.Rand01(), false, color);
                     buffer.SetPixel(x, y, color);
                 }
                 break;
@@ -155,7 +158,7 @@ void LifeEffect::Render(Effect* effect, SettingsMap& SettingsMap, RenderBuffer&
                 if (isLive && (cnt == 1 || cnt == 3 || cnt == 5 || cnt == 8)) {
                     buffer.SetPixel(x, y, color);
                 } else if (!isLive && (cnt == 3 || cnt == 5 || cnt == 7)) {
-                    buffer.GetMultiColorBlend(rand01(), false, color);
+                    buffer.GetMultiColorBlend(buffer.Rand01(), false, color);
                     buffer.SetPixel(x, y, color);
                 }
                 break;
@@ -164,7 +167,7 @@ void LifeEffect::Render(Effect* effect, SettingsMap& SettingsMap, RenderBuffer&
                 if (isLive && (cnt == 2 || cnt == 3 || cnt >= 5)) {
                     buffer.SetPixel(x, y, color);
                 } else if (!isLive && (cnt == 3 || cnt == 7 || cnt == 8)) {
-                    buffer.GetMultiColorBlend(rand01(), false, color);
+                    buffer.GetMultiColorBlend(buffer.Rand01(), false, color);
                     buffer.SetPixel(x, y, color);
                 }
                 break;
@@ -173,7 +176,7 @@ void LifeEffect::Render(Effect* effect, SettingsMap& SettingsMap, RenderBuffer&
                 if (isLive && (cnt >= 5)) {
                     buffer.SetPixel(x, y, color);
                 } else if (!isLive && (cnt == 2 || cnt >= 5)) {
-                    buffer.GetMultiColorBlend(rand01(), false, color);
+                    buffer.GetMultiColorBlend(buffer.Rand01(), false, color);
                     buffer.SetPixel(x, y, color);
                 }
                 break;
@@ -118,17 +118,17 @@ void LightningEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuf
 
     int xoffset = curState * botX / 10.0;
     for(int i = 0; i <= segment; i++) {
-        int j = rand() + 1;
+        int j = buffer.Rand();
         int x2 = 0;
         int y2 = 0;
         if(DIRECTION==UP || DIRECTION==DOWN) {
             if(i % 2 == 0) { // Every even segment will alternate direction
-                if (rand() % 2 == 0) // target x is to the left
+                if (buffer.Rand() % 2 == 0) // target x is to the left
                     x2 = xc + topX - (j % Number_Segments);
                 else // but randomely we reverse direction, also make it a larger jag
                     x2 = xc + topX + (2 * (j % Number_Segments));
             } else { // odd segments will
-                if (rand() % 2 == 0) // move to the right
+                if (buffer.Rand() % 2 == 0) // move to the right
                     x2 = xc + topX + (j % Number_Segments);
                 else // but sometimes move 3 units to left.
                     x2 = xc + topX - (3 * (j % Number_Segments));
@@ -148,11 +148,11 @@ void LightningEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuf
             if (i > (segment / 2)) {
                 int x3 = 0;
                 if (i % 2 == 1) {
-                    if (rand()%2==1)
+                    if (buffer.Rand()%2==1)
                         x3 = xc + topX - (j % Number_Segments);
                     else  x3 = xc + topX + (2 * (j % Number_Segments));
                 } else {
-                    if (rand() % 2 == 1)
+                    if (buffer.Rand() % 2 == 1)
                         x3 = xc + topX + (j % Number_Segments);
                     else
                         x3 = xc + topX - (3 * (j % Number_Segments));
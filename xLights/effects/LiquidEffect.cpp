@@ -28,8 +28,14 @@
 
 #include <log4cpp/Category.hh>
 
+#include <atomic>
+#include <memory>
+
 //#define LE_INTERPOLATE
 
+// below this drawing the particles in parallel costs more than it saves
+#define LIQUID_PARALLEL_DRAW_PARTICLES 5000
+
 LiquidEffect::LiquidEffect(int id) : RenderableEffect(id, "Liquid", liquid_16, liquid_24, liquid_32, liquid_48, liquid_64)
 {
 }
@@ -292,7 +298,11 @@ void LiquidEffect::Draw(RenderBuffer& buffer, b2ParticleSystem* ps, const xlColo
     free(count);
 #else
     int32 particleCount = ps->GetParticleCount();
-    if (particleCount > 0)
+    if (particleCount >= LIQUID_PARALLEL_DRAW_PARTICLES && !buffer.dmx_buffer)
+    {
+        DrawParallel(buffer, ps, color, mixColors);
+    }
+    else if (particleCount > 0)
     {
         const b2Vec2* positionBuffer = ps->GetPositionBuffer();
         const b2ParticleColor* colorBuffer = ps->GetColorBuffer();
@@ -334,6 +344,68 @@ void LiquidEffect::Draw(RenderBuffer& buffer, b2ParticleSystem* ps, const xlColo
     }
 }
 
+// Draws the same pixels as drawing the particles in order. Each pixel records the highest numbered particle
+// which lands on it and the pixels are then coloured from those particles.
+void LiquidEffect::DrawParallel(RenderBuffer& buffer, b2ParticleSystem* ps, const xlColor& color, bool mixColors)
+{
+    int32 particleCount = ps->GetParticleCount();
+    const b2Vec2* positionBuffer = ps->GetPositionBuffer();
+    const b2ParticleColor* colorBuffer = ps->GetColorBuffer();
+    bool useParticleColor = mixColors && colorBuffer != nullptr;
+    int width = buffer.BufferWi;
+    int height = buffer.BufferHt;
+
+    // particles which have left the buffer are only flagged here ... the world removes them on the next step
+    for (int i = 0; i < particleCount; ++i)
+    {
+        int x = positionBuffer[i].x;
+        int y = positionBuffer[i].y;
+        if (y < -1 || x < -1 || x > width + 1)
+        {
+            ps->DestroyParticle(i);
+        }
+    }
+
+    std::unique_ptr<std::atomic<int32>[]> owner(new std::atomic<int32>[(size_t)width * height]);
+    for (size_t i = 0; i < (size_t)width * height; ++i)
+    {
+        owner[i].store(-1, std::memory_order_relaxed);
+    }
+
+    parallel_for(0, particleCount, [positionBuffer, width, height, &owner](int i) {
+        int x = positionBuffer[i].x;
+        int y = positionBuffer[i].y;
+        if (x < 0 || y < 0 || x >= width || y >= height)
+        {
+            return;
+        }
+        std::atomic<int32>& o = owner[(size_t)y * width + x];
+        int32 current = o.load(std::memory_order_relaxed);
+        while (current < i && !o.compare_exchange_weak(current, i, std::memory_order_relaxed))
+        {
+        }
+    }, 2000);
+
+    parallel_for(0, height, [&buffer, &owner, colorBuffer, useParticleColor, &color, width](int y) {
+        for (int x = 0; x < width; ++x)
+        {
+            int32 i = owner[(size_t)y * width + x].load(std::memory_order_relaxed);
+            if (i >= 0)
+            {
+                if (useParticleColor)
+                {
+                    auto c = colorBuffer[i].GetColor();
+                    buffer.SetPixel(x, y, xlColor(c.r * 255, c.g * 255, c.b * 255));
+                }
+                else
+                {
+                    buffer.SetPixel(x, y, color);
+                }
+            }
+        }
+    }, 32);
+}
+
 xlColor LiquidEffect::GetDespeckleColor(RenderBuffer& buffer, size_t x, size_t y, int despeckle) const
 {
     int red = 0;
@@ -384,7 +456,7 @@ xlColor LiquidEffect::GetDespeckleColor(RenderBuffer& buffer, size_t x, size_t y
     return xlColor(red / count, green / count, blue / count);
 }
 
-void LiquidEffect::CreateParticles(b2ParticleSystem* ps, int x, int y, int direction, int velocity, int flow, bool flowMusic, int lifetime, int width, int height, const xlColor& c, const std::string& particleType, bool mixcolors, float audioLevel, int sourceSize)
+void LiquidEffect::CreateParticles(RenderRandom& rng, b2ParticleSystem* ps, int x, int y, int direction, int velocity, int flow, bool flowMusic, int lifetime, int width, int height, const xlColor& c, const std::string& particleType, bool mixcolors, float audioLevel, int sourceSize)
 {
     static const float pi2 = 6.283185307f;
     float posx = (float)x * (float)width / 100.0;
@@ -393,7 +465,7 @@ void LiquidEffect::CreateParticles(b2ParticleSystem* ps, int x, int y, int direc
     float velx = (float)velocity * 10.0 * RenderBuffer::cos(pi2 * (float)direction / 360.0);
     float vely = (float)velocity * 10.0 * RenderBuffer::sin(pi2 * (float)direction / 360.0);
 
-    float velVariation = rand01() * 0.1;
+    float velVariation = rng.Rand01() * 0.1;
     velVariation -= velVariation / 2.0;
 
     velx -= velx * velVariation;
@@ -457,10 +529,10 @@ void LiquidEffect::CreateParticles(b2ParticleSystem* ps, int x, int y, int direc
         if (sourceSize == 0)
         {
             // Randomly pick a position within the emitter's radius.
-            const float32 angle = rand01() * 2.0f * b2_pi;
+            const float32 angle = rng.Rand01() * 2.0f * b2_pi;
 
             // Distance from the center of the circle.
-            const float32 distance = rand01();
+            const float32 distance = rng.Rand01();
             b2Vec2 positionOnUnitCircle(RenderBuffer::sin(angle), RenderBuffer::cos(angle));
 
             // Initial position.
@@ -471,7 +543,7 @@ void LiquidEffect::CreateParticles(b2ParticleSystem* ps, int x, int y, int direc
         else
         {
             // Distance from the center of the circle.
-            const float32 distance = rand01() * ((float)sourceSize - (float)sourceSize / 2.0);
+            const float32 distance = rng.Rand01() * ((float)sourceSize - (float)sourceSize / 2.0);
 
             float offx = distance * RenderBuffer::cos(pi2 * ((float)direction + 90.0) / 360.0);
             float offy = distance * RenderBuffer::sin(pi2 * ((float)direction + 90.0) / 360.0);
@@ -487,7 +559,7 @@ void LiquidEffect::CreateParticles(b2ParticleSystem* ps, int x, int y, int direc
         // give it a lifetime
         if (lifetime > 0)
         {
-            float randomlt = lt + (lt * 0.2 * rand01()) - (lt *.01);
+            float randomlt = lt + (lt * 0.2 * rng.Rand01()) - (lt *.01);
             pd.lifetime = randomlt;
         }
         ps->CreateParticle(pd);
@@ -545,16 +617,16 @@ void LiquidEffect::Step(b2World* world, RenderBuffer &buffer, bool enabled[], in
                 switch (i)
                 {
                 case 0:
-                    CreateParticles(ps, x1, y1, direction1, velocity1, flow1, flowMusic1, lifetime, buffer.BufferWi, buffer.BufferHt, color, particleType, mixcolors, audioLevel, sourceSize1);
+                    CreateParticles(buffer.GetRandom(), ps, x1, y1, direction1, velocity1, flow1, flowMusic1, lifetime, buffer.BufferWi, buffer.BufferHt, color, particleType, mixcolors, audioLevel, sourceSize1);
                     break;
                 case 1:
-                    CreateParticles(ps, x2, y2, direction2, velocity2, flow2, flowMusic2, lifetime, buffer.BufferWi, buffer.BufferHt, color, particleType, mixcolors, audioLevel, sourceSize2);
+                    CreateParticles(buffer.GetRandom(), ps, x2, y2, direction2, velocity2, flow2, flowMusic2, lifetime, buffer.BufferWi, buffer.BufferHt, color, particleType, mixcolors, audioLevel, sourceSize2);
                     break;
                 case 2:
-                    CreateParticles(ps, x3, y3, direction3, velocity3, flow3, flowMusic3, lifetime, buffer.BufferWi, buffer.BufferHt, color, particleType, mixcolors, audioLevel, sourceSize3);
+                    CreateParticles(buffer.GetRandom(), ps, x3, y3, direction3, velocity3, flow3, flowMusic3, lifetime, buffer.BufferWi, buffer.BufferHt, color, particleType, mixcolors, audioLevel, sourceSize3);
                     break;
                 case 3:
-                    CreateParticles(ps, x4, y4, direction4, velocity4, flow4, flowMusic4, lifetime, buffer.BufferWi, buffer.BufferHt, color, particleType, mixcolors, audioLevel, sourceSize4);
+                    CreateParticles(buffer.GetRandom(), ps, x4, y4, direction4, velocity4, flow4, flowMusic4, lifetime, buffer.BufferWi, buffer.BufferHt, color, particleType, mixcolors, audioLevel, sourceSize4);
                     break;
                 }
                 j++;
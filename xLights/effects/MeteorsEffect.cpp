@@ -119,6 +119,10 @@ class MeteorsRenderCache : public EffectRenderCache {
 public:
     MeteorsRenderCache() {};
     virtual ~MeteorsRenderCache() {};
+    virtual EffectRenderCache* Checkpoint() const override { return new MeteorsRenderCache(*this); }
+    virtual size_t GetCheckpointSize() const override {
+        return sizeof(*this) + meteors.size() * sizeof(MeteorClass) + meteorsRadial.size() * sizeof(MeteorRadialClass);
+    }
 
     int effectState;
     MeteorList meteors;
@@ -264,7 +268,7 @@ void MeteorsEffect::RenderMeteorsHorizontal(RenderBuffer &buffer, int ColorSchem
     // create new meteors
 
     for (int i = 0; i < buffer.BufferHt; i++) {
-        if (rand() % 200 < Count) {
+        if (buffer.Rand() % 200 < Count) {
             m.x=buffer.BufferWi - 1;
             m.y=i;
 
@@ -273,7 +277,7 @@ void MeteorsEffect::RenderMeteorsHorizontal(RenderBuffer &buffer, int ColorSchem
                     buffer.SetRangeColor(hsv0,hsv1,m.hsv);
                     break;
                 case 2:
-                    buffer.palette.GetHSV(rand()%colorcnt, m.hsv);
+                    buffer.palette.GetHSV(buffer.Rand()%colorcnt, m.hsv);
                     break;
             }
             cache->meteors.push_back(m);
@@ -282,13 +286,17 @@ void MeteorsEffect::RenderMeteorsHorizontal(RenderBuffer &buffer, int ColorSchem
 
     // render meteors
 
-    std::function<void(MeteorClass &, int)> f = [&buffer, MeteorsEffect, TailLength, mspeed, SwirlIntensity, ColorScheme] (MeteorClass &meteor, int n) {
+    // each meteor gets its own generator so the result doesnt depend on how they are split between threads
+    uint64_t randomBase = buffer.GetRandom().Next();
+    std::function<void(MeteorClass &, int)> f = [&buffer, MeteorsEffect, TailLength, mspeed, SwirlIntensity, ColorScheme, randomBase] (MeteorClass &meteor, int n) {
+        RenderRandom rng;
+        rng.Seed(FNV1a(randomBase, (uint64_t)n));
         int x,y,dy;
         HSVValue hsv;
         for (int ph = 0; ph <= TailLength; ph++) {
             switch (ColorScheme) {
                 case 0:
-                    hsv.hue=double(rand() % 1000) / 1000.0;
+                    hsv.hue=double(rng.Rand() % 1000) / 1000.0;
                     hsv.saturation=1.0;
                     hsv.value=1.0;
                     break;
@@ -365,7 +373,7 @@ void MeteorsEffect::RenderMeteorsVertical(RenderBuffer &buffer, int ColorScheme,
     // create new meteors
 
     for (int i = 0; i < buffer.BufferWi; i++) {
-        if (rand() % 200 < Count) {
+        if (buffer.Rand() % 200 < Count) {
             m.x=i;
             m.y=buffer.BufferHt - 1;
 
@@ -374,7 +382,7 @@ void MeteorsEffect::RenderMeteorsVertical(RenderBuffer &buffer, int ColorScheme,
                     buffer.SetRangeColor(hsv0,hsv1,m.hsv);
                     break;
                 case 2:
-                    buffer.palette.GetHSV(rand()%colorcnt, m.hsv);
+                    buffer.palette.GetHSV(buffer.Rand()%colorcnt, m.hsv);
                     break;
             }
             cache->meteors.push_back(m);
@@ -383,13 +391,17 @@ void MeteorsEffect::RenderMeteorsVertical(RenderBuffer &buffer, int ColorScheme,
 
     // render meteors
 
-    std::function<void(MeteorClass &, int)> f = [&buffer, MeteorsEffect, TailLength, mspeed, SwirlIntensity, ColorScheme] (MeteorClass &meteor, int n) {
+    // each meteor gets its own generator so the result doesnt depend on how they are split between threads
+    uint64_t randomBase = buffer.GetRandom().Next();
+    std::function<void(MeteorClass &, int)> f = [&buffer, MeteorsEffect, TailLength, mspeed, SwirlIntensity, ColorScheme, randomBase] (MeteorClass &meteor, int n) {
+        RenderRandom rng;
+        rng.Seed(FNV1a(randomBase, (uint64_t)n));
         int x,y,dx;
         HSVValue hsv;
         for (int ph = 0; ph <= TailLength; ph++) {
             switch (ColorScheme) {
                 case 0:
-                    hsv.hue=double(rand() % 1000) / 1000.0;
+                    hsv.hue=double(rng.Rand() % 1000) / 1000.0;
                     hsv.saturation=1.0;
                     hsv.value=1.0;
                     break;
@@ -449,18 +461,18 @@ void MeteorsEffect::RenderIcicleDrip(RenderBuffer &buffer, int ColorScheme, int
 
     MeteorClass m;
     for (int i = 0; i < buffer.BufferWi; i++) {
-        if (rand() % 200 < Count) {
+        if (buffer.Rand() % 200 < Count) {
             m.x=i;
             m.y=buffer.BufferHt - 1;
             //            m.h = TailLength;
-            m.h = (rand() % (2 * buffer.BufferHt))/3; //somewhat variable length -DJ
+            m.h = (buffer.Rand() % (2 * buffer.BufferHt))/3; //somewhat variable length -DJ
 
             switch (ColorScheme) {
                 case 1:
                     buffer.SetRangeColor(hsv0,hsv1,m.hsv);
                     break;
                 case 2:
-                    buffer.palette.GetHSV(rand()%colorcnt, m.hsv);
+                    buffer.palette.GetHSV(buffer.Rand()%colorcnt, m.hsv);
                     break;
             }
             cache->meteors.push_back(m);
@@ -557,13 +569,13 @@ void MeteorsEffect::RenderMeteorsImplode(RenderBuffer &buffer, int ColorScheme,
 
     m.cnt=1;
     for (int i = 0; i < MinDimension; i++) {
-        if (rand() % 200 < Count) {
+        if (buffer.Rand() % 200 < Count) {
             if (buffer.BufferHt == 1) {
-                angle=double(rand() % 2) * M_PI;
+                angle=double(buffer.Rand() % 2) * M_PI;
             } else if (buffer.BufferWi == 1) {
-                angle=double(rand() % 2) * M_PI - (M_PI/2.0);
+                angle=double(buffer.Rand() % 2) * M_PI - (M_PI/2.0);
             } else {
-                angle=rand01()*2.0*M_PI;
+                angle=buffer.Rand01()*2.0*M_PI;
             }
             m.dx=buffer.cos(angle);
             m.dy=buffer.sin(angle);
@@ -577,7 +589,7 @@ void MeteorsEffect::RenderMeteorsImplode(RenderBuffer &buffer, int ColorScheme,
                     buffer.SetRangeColor(hsv0,hsv1,m.hsv);
                     break;
                 case 2:
-                    buffer.palette.GetHSV(rand()%colorcnt, m.hsv);
+                    buffer.palette.GetHSV(buffer.Rand()%colorcnt, m.hsv);
                     break;
             }
             cache->meteorsRadial.push_back(m);
@@ -586,7 +598,11 @@ void MeteorsEffect::RenderMeteorsImplode(RenderBuffer &buffer, int ColorScheme,
 
     // render meteors
 
-    std::function<void(MeteorRadialClass&, int)> f = [&buffer, fadeWithDistance, centerX, centerY, maxdiag, TailLength, ColorScheme, mspeed](MeteorRadialClass& meteor, int n) {
+    // each meteor gets its own generator so the result doesnt depend on how they are split between threads
+    uint64_t randomBase = buffer.GetRandom().Next();
+    std::function<void(MeteorRadialClass&, int)> f = [&buffer, fadeWithDistance, centerX, centerY, maxdiag, TailLength, ColorScheme, mspeed, randomBase](MeteorRadialClass& meteor, int n) {
+        RenderRandom rng;
+        rng.Seed(FNV1a(randomBase, (uint64_t)n));
         int x,y;
         HSVValue hsv;
         float hdistance = 1.0f;
@@ -599,7 +615,7 @@ void MeteorsEffect::RenderMeteorsImplode(RenderBuffer &buffer, int ColorScheme,
         for (int ph = 0; ph <= TailLength; ph++) {
             switch (ColorScheme) {
                 case 0:
-                    hsv.hue=double(rand() % 1000) / 1000.0;
+                    hsv.hue=double(rng.Rand() % 1000) / 1000.0;
                     hsv.saturation=1.0;
                     hsv.value=1.0;
                     break;
@@ -694,13 +710,13 @@ void MeteorsEffect::RenderMeteorsExplode(RenderBuffer &buffer, int ColorScheme,
     m.y=buffer.BufferHt/2+trueyoffset;
     m.cnt=1;
     for (int i = 0; i < MinDimension; i++) {
-        if (rand() % 200 < Count) {
+        if (buffer.Rand() % 200 < Count) {
             if (buffer.BufferHt == 1) {
-                angle=double(rand() % 2) * M_PI;
+                angle=double(buffer.Rand() % 2) * M_PI;
             } else if (buffer.BufferWi == 1) {
-                angle=double(rand() % 2) * M_PI - (M_PI/2.0);
+                angle=double(buffer.Rand() % 2) * M_PI - (M_PI/2.0);
             } else {
-                angle=rand01()*2.0*M_PI;
+                angle=buffer.Rand01()*2.0*M_PI;
             }
             m.dx=buffer.cos(angle);
             m.dy=buffer.sin(angle);
@@ -710,7 +726,7 @@ void MeteorsEffect::RenderMeteorsExplode(RenderBuffer &buffer, int ColorScheme,
                     buffer.SetRangeColor(hsv0,hsv1,m.hsv);
                     break;
                 case 2:
-                    buffer.palette.GetHSV(rand()%colorcnt, m.hsv);
+                    buffer.palette.GetHSV(buffer.Rand()%colorcnt, m.hsv);
                     break;
             }
             cache->meteorsRadial.push_back(m);
@@ -719,7 +735,11 @@ void MeteorsEffect::RenderMeteorsExplode(RenderBuffer &buffer, int ColorScheme,
 
     // render meteors
 
-    std::function<void(MeteorRadialClass&, int)> f = [&buffer, fadeWithDistance, centerX, centerY, maxdiag, TailLength, ColorScheme, mspeed](MeteorRadialClass& meteor, int n) {
+    // each meteor gets its own generator so the result doesnt depend on how they are split between threads
+    uint64_t randomBase = buffer.GetRandom().Next();
+    std::function<void(MeteorRadialClass&, int)> f = [&buffer, fadeWithDistance, centerX, centerY, maxdiag, TailLength, ColorScheme, mspeed, randomBase](MeteorRadialClass& meteor, int n) {
+        RenderRandom rng;
+        rng.Seed(FNV1a(randomBase, (uint64_t)n));
         int x,y;
         HSVValue hsv;
 
@@ -734,7 +754,7 @@ void MeteorsEffect::RenderMeteorsExplode(RenderBuffer &buffer, int ColorScheme,
             //if (ph >= it->cnt) continue;
             switch (ColorScheme) {
                 case 0:
-                    hsv.hue=double(rand() % 1000) / 1000.0;
+                    hsv.hue=double(rng.Rand() % 1000) / 1000.0;
                     hsv.saturation=1.0;
                     hsv.value=1.0;
                     break;
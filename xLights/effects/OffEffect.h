@@ -22,6 +22,7 @@ class OffEffect : public RenderableEffect
         virtual wxString GetEffectString() override;
         virtual void SetDefaultParameters() override;
         virtual bool CanRenderPartialTimeInterval() const override { return true; }
+        virtual bool IsStatic(Effect* effect, const SettingsMap& settings, const RenderBuffer& buffer) const override { return true; }
         virtual std::list<std::string> CheckEffectSettings(const SettingsMap& settings, AudioManager* media, Model* model, Effect* eff, bool renderCache) override;
 
     protected:
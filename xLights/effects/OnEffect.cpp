@@ -181,6 +181,15 @@ void OnEffect::RemoveDefaults(const std::string &version, Effect *effect) {
     RenderableEffect::RemoveDefaults(version, effect);
 }
 
+bool OnEffect::IsStatic(Effect* effect, const SettingsMap& settings, const RenderBuffer& buffer) const
+{
+    // ramps, shimmer and transparency curves change it over time ... cycles also redraws the background every frame
+    return settings.GetInt(TEXTCTRL_Eff_On_Start, 100) == settings.GetInt(TEXTCTRL_Eff_On_End, 100) &&
+           settings.GetInt(CHECKBOX_On_Shimmer, 0) == 0 &&
+           settings.GetDouble(TEXTCTRL_On_Cycles, 1.0) == 1.0 &&
+           !HasActiveValueCurves(settings);
+}
+
 void OnEffect::Render(Effect *eff, SettingsMap &SettingsMap, RenderBuffer &buffer) {
     
     int start = SettingsMap.GetInt(TEXTCTRL_Eff_On_Start, 100);
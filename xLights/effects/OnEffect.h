@@ -31,6 +31,7 @@ class OnEffect : public RenderableEffect
         virtual void SetDefaultParameters() override;
         virtual wxString GetEffectString() override;
         virtual bool CanRenderPartialTimeInterval() const override { return true; }
+        virtual bool IsStatic(Effect* effect, const SettingsMap& settings, const RenderBuffer& buffer) const override;
 
     protected:
         virtual void RemoveDefaults(const std::string &version, Effect *effect) override;
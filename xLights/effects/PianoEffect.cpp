@@ -20,6 +20,7 @@
 #include "../UtilClasses.h"
 #include "../xLightsXmlFile.h"
 #include "../UtilFunctions.h"
+#include "../NoteTimeline.h"
 #include "models/Model.h"
 
 #include <log4cpp/Category.hh>
@@ -45,8 +46,8 @@ std::list<std::string> PianoEffect::CheckEffectSettings(const SettingsMap& setti
     }
     else
     {
-        std::map<int, std::list<float>> timings = LoadTimingTrack(settings.Get("E_CHOICE_Piano_MIDITrack_APPLYLAST", ""), 50);
-        if (timings.size() == 0)
+        std::shared_ptr<const NoteTimeline> timeline = LoadTimingTrack(settings.Get("E_CHOICE_Piano_MIDITrack_APPLYLAST", ""));
+        if (timeline == nullptr || timeline->IsEmpty())
         {
             res.push_back(wxString::Format("    ERR: Piano effect timing track '%s' has no notes. Model '%s', Start %s", settings.Get("E_CHOICE_Piano_MIDITrack_APPLYLAST", ""), model->GetName(), FORMATTIME(eff->GetStartTimeMS())).ToStdString());
         }
@@ -168,7 +169,7 @@ public:
 	PianoCache() { };
 	virtual ~PianoCache() { };
 
-	std::map<int, std::list<float>> _timings;
+	std::shared_ptr<const NoteTimeline> _timeline;
 	std::string _MIDItrack;
 };
 
@@ -181,7 +182,7 @@ void PianoEffect::RenderPiano(RenderBuffer &buffer, SequenceElements *elements,
 		buffer.infoCache[id] = cache;
 	}
 
-	std::map<int, std::list<float>>& _timings = cache->_timings;
+	std::shared_ptr<const NoteTimeline>& _timeline = cache->_timeline;
 	std::string& _MIDITrack = cache->_MIDItrack;
 
 	if (buffer.needToInit)
@@ -190,12 +191,8 @@ void PianoEffect::RenderPiano(RenderBuffer &buffer, SequenceElements *elements,
         SetPanelTimingTracks();
 
         buffer.needToInit = false;
-        if (_MIDITrack != MIDITrack)
-        {
-            _timings.clear();
-            _timings = LoadTimingTrack(MIDITrack, buffer.frameTimeInMs);
-            elements->AddRenderDependency(MIDITrack, buffer.cur_model);
-        }
+        // shared with every other effect using the track and only rebuilt if the notes have changed
+        _timeline = LoadTimingTrack(MIDITrack);
 
 		_MIDITrack = MIDITrack;
     
@@ -218,19 +215,15 @@ void PianoEffect::RenderPiano(RenderBuffer &buffer, SequenceElements *elements,
 		em = startmidi + buffer.BufferWi - 1;
 	}
 
-    std::list<float> def;
-	std::list<float>* pdata = nullptr;
-
-	int time = buffer.curPeriod * buffer.frameTimeInMs;
-	if (_timings.find(time) != _timings.end())
-	{
-		pdata = &_timings[time];
-	}
-
-    if (pdata == nullptr)
+    std::list<float> notes;
+    if (_timeline != nullptr)
     {
-        pdata = &def;
+        for (int n : _timeline->GetNotesAt(buffer.curPeriod * buffer.frameTimeInMs))
+        {
+            notes.push_back(n);
+        }
     }
+    std::list<float>* pdata = &notes;
 
 	ReduceChannels(pdata, startmidi, em, sharps);
 
@@ -610,159 +603,23 @@ std::vector<float> PianoEffect::Parse(wxString& l)
 	return res;
 }
 
-std::list<std::string> PianoEffect::ExtractNotes(const std::string& label)
-{
-    std::string n = label;
-    std::transform(n.begin(), n.end(), n.begin(), ::toupper);
-
-    std::list<std::string> res;
-
-    std::string s = "";
-    for (const auto& it : n)
-    {
-        if (it == ':' || it == ' ' || it == ';' || it == ',')
-        {
-            if (s != "")
-            {
-                res.push_back(s);
-                s = "";
-            }
-        }
-        else
-        {
-            if ((it >= 'A' && it <= 'G') ||
-                (it == '#') ||
-                (it >= '0' && it <= '9'))
-            {
-                s += it;
-            }
-        }
-    }
-
-    if (s != "")
-    {
-        res.push_back(s);
-    }
-
-    return res;
-}
-
-int PianoEffect::ConvertNote(const std::string& note)
-{
-    std::string n = note;
-    int nletter;
-    std::transform(n.begin(), n.end(), n.begin(), ::toupper);
-
-    switch (n[0])
-    {
-    case 'A':
-        nletter = 9;
-        break;
-    case 'B':
-        nletter = 11;
-        break;
-    case 'C':
-        nletter = 0;
-        break;
-    case 'D':
-        nletter = 2;
-        break;
-    case 'E':
-        nletter = 4;
-        break;
-    case 'F':
-        nletter = 5;
-        break;
-    case 'G':
-        nletter = 7;
-        break;
-    default:
-        {
-            int number = wxAtoi(n);
-            if (number < 0) number = 0;
-            if (number > 127) number = 127;
-            return number;
-        }
-    }
-
-    n = n.substr(1);
-    int sharp = 0;
-    if (n.find('#') != std::string::npos)
-    {
-        sharp = 1;
-    }
-    else if (n.find('B') != std::string::npos)
-    {
-        sharp = -1;
-    }
-
-    int octave = 4;
-
-    if (n != "")
-    {
-        if (n[0] == '#')
-        {
-            n = n.substr(1);
-        }
-        else if (n[0] == 'B')
-        {
-            n = n.substr(1);
-        }
-    }
-
-    if (n != "")
-    {
-        octave = wxAtoi(n);
-    }
-
-    int number = 12 + (octave * 12) + nletter + sharp;
-    if (number < 0) number = 0;
-    if (number > 127) number = 127;
-    return number;
-}
-
-std::map<int, std::list<float>> PianoEffect::LoadTimingTrack(const std::string& track, int intervalMS)
+std::shared_ptr<const NoteTimeline> PianoEffect::LoadTimingTrack(const std::string& track)
 {
     static log4cpp::Category &logger_pianodata = log4cpp::Category::getInstance(std::string("log_pianodata"));
-    std::map<int, std::list<float>> res;
-
-    logger_pianodata.debug("Loading timings from timing track " + track);
 
     if (mSequenceElements == nullptr)
     {
         logger_pianodata.debug("No timing tracks found.");
-        return res;
+        return nullptr;
     }
 
-    // Load the names of the timing tracks
     EffectLayer* el = GetTiming(track);
 
     if (el == nullptr)
     {
-        logger_pianodata.debug("Timing track not found.");
-        return res;
-    }
-
-    for (int j = 0; j < el->GetEffectCount(); ++j)
-    {
-        std::list<float> notes;
-        int starttime = el->GetEffect(j)->GetStartTimeMS();
-        int endtime = el->GetEffect(j)->GetEndTimeMS();
-        std::string label = el->GetEffect(j)->GetEffectName();
-        std::list<std::string> notelabels = ExtractNotes(label);
-        for (const auto& s : notelabels)
-        {
-            float n = (float)ConvertNote(s);
-            if (n >= 0)
-            {
-                notes.push_back(n);
-            }
-        }
-        for (int i = starttime; i < endtime; i += intervalMS)
-        {
-            res[i] = notes;
-        }
+        logger_pianodata.debug("Timing track " + track + " not found.");
+        return nullptr;
     }
 
-    return res;
+    return NoteTimeline::Get(el, track);
 }
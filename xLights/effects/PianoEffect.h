@@ -13,7 +13,9 @@
 #include "RenderableEffect.h"
 
 #include <list>
+#include <memory>
 class PianoPanel;
+class NoteTimeline;
 
 #define PIANO_SCALE_MIN 0
 #define PIANO_SCALE_MAX 100
@@ -50,7 +52,5 @@ class PianoEffect : public RenderableEffect
 		void DrawBarsPiano(RenderBuffer &buffer, std::list<float>* pdata, bool sharps, int start, int end, int scale, int xoffset);
 		bool IsSharp(float f);
 		bool KeyDown(std::list<float>* pdata, int ch);
-        std::map<int, std::list<float>> LoadTimingTrack(const std::string& track, int intervalMS);
-        std::list<std::string> ExtractNotes(const std::string& label);
-        int ConvertNote(const std::string& note);
+        std::shared_ptr<const NoteTimeline> LoadTimingTrack(const std::string& track);
 };
@@ -467,6 +467,22 @@ bool PicturesEffect::IsPictureFile(std::string filename)
     return false;
 }
 
+bool PicturesEffect::IsStatic(Effect* effect, const SettingsMap& settings, const RenderBuffer& buffer) const
+{
+    if (GetPicturesDirection(settings.Get("CHOICE_Pictures_Direction", "none")) != RENDER_PICTURE_NONE ||
+        settings.GetBool("CHECKBOX_Pictures_Shimmer", false) || HasActiveValueCurves(settings)) {
+        return false;
+    }
+    if (settings.Get("CHOICE_Scaling", "No Scaling") == "No Scaling" &&
+        settings.GetInt("SLIDER_Pictures_StartScale", 100) != settings.GetInt("SLIDER_Pictures_EndScale", 100)) {
+        return false;
+    }
+
+    // gifs may be animated and *-1.jpg files are the first frame of a movie
+    wxFileName fn(settings.Get("FILEPICKER_Pictures_Filename", ""));
+    return fn.GetExt().Lower() != "gif" && !fn.GetName().EndsWith("-1");
+}
+
 void PicturesEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffer &buffer) {
     Render(buffer,
            SettingsMap["CHOICE_Pictures_Direction"],
@@ -930,7 +946,7 @@ void PicturesEffect::Render(RenderBuffer& buffer,
         xlColor color;
         for (int x = 0; x < BufferWi; x++) {
             for (int y = 0; y < BufferHt; y++) {
-                if (rand01() > 0.5) {
+                if (buffer.Rand01() > 0.5) {
                     buffer.GetPixel(x, y, color);
                     if (color != xlBLACK) {
                         buffer.ProcessPixel(x, y, c, false);
@@ -41,6 +41,7 @@ class PicturesEffect : public RenderableEffect
         virtual bool CleanupFileLocations(xLightsFrame* frame, SettingsMap &SettingsMap) override;
         static bool IsPictureFile(std::string filename);
         virtual bool SupportsRenderCache(const SettingsMap& settings) const override { return true; }
+        virtual bool IsStatic(Effect* effect, const SettingsMap& settings, const RenderBuffer& buffer) const override;
 
     protected:
         virtual xlEffectPanel *CreatePanel(wxWindow *parent) override;
@@ -172,18 +172,28 @@ void PinwheelEffect::Render(Effect* effect, SettingsMap& SettingsMap, RenderBuff
 
         // Draw actual pinwheel arms
         if (max_radius != 0) {
+            // nothing outside the arms is drawn
+            int cx = xc_adj + buffer.BufferWi / 2;
+            int cy = yc_adj + buffer.BufferHt / 2;
+            int xstart = std::max(0, cx - max_radius);
+            int xend = std::min(buffer.BufferWi, cx + max_radius + 1);
+            int ystart = std::max(0, cy - max_radius);
+            int yend = std::min(buffer.BufferHt, cy + max_radius + 1);
+            std::shared_ptr<const PolarTable> polar = RenderBuffer::GetPolarTable(std::max(std::abs(xstart - cx), std::abs(xend - 1 - cx)),
+                                                                                  std::max(std::abs(ystart - cy), std::abs(yend - 1 - cy)));
+
             //for (int x = 0; x < buffer.BufferWi; x++) {
-            parallel_for(0, buffer.BufferWi, [&buffer, tmax, xc_adj, yc_adj, max_radius, &colorarray, &colorIsSpacial,
-                                              &colorsAsHSV, &colorsAsColor, pinwheel_twist, pinwheel_rotation, pinwheel_arms, poffset,
-                                              degrees_per_arm, pos, pw3dType](int x) {
-                int x1 = x - xc_adj - (buffer.BufferWi / 2);
+            parallel_for(xstart, xend, [&buffer, tmax, xc_adj, yc_adj, max_radius, &colorarray, &colorIsSpacial,
+                                        &colorsAsHSV, &colorsAsColor, pinwheel_twist, pinwheel_rotation, pinwheel_arms, poffset,
+                                        degrees_per_arm, pos, pw3dType, cx, cy, ystart, yend, &polar](int x) {
+                int x1 = x - cx;
                 HSVValue hsv;
-                for (int y = 0; y < buffer.BufferHt; y++) {
-                    int y1 = y - yc_adj - (buffer.BufferHt / 2);
-                    double r = std::hypot(x1, y1);
+                for (int y = ystart; y < yend; y++) {
+                    int y1 = y - cy;
+                    double r = polar ? polar->Radius(x1, y1) : std::hypot(x1, y1);
                     if (r <= max_radius) {
                         double degrees_twist = (r / max_radius) * pinwheel_twist;
-                        double theta = (std::atan2(x1, y1) * 180 / 3.14159) + degrees_twist;
+                        double theta = ((polar ? polar->Angle(x1, y1) : std::atan2(x1, y1)) * 180 / 3.14159) + degrees_twist;
                         if (pinwheel_rotation == 1) { // do we have CW rotation
                             theta = pos + theta + (tmax / 2) + poffset;
                         } else {
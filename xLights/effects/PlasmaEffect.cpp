@@ -98,6 +98,23 @@ void PlasmaEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffer
     const double sin_time_2 = buffer.sin(time / 2);
     static const double pi3 = pi / 3.0;
 
+    // the terms which only depend on the row are the same for every column
+    struct PlasmaRow {
+        double ry;
+        double ry2;
+        double cy2;
+        double sin_ry_time;
+    };
+    std::vector<PlasmaRow> rows(buffer.BufferHt);
+    for (int y = 0; y < buffer.BufferHt; y++) {
+        PlasmaRow& row = rows[y];
+        row.ry = ((float)y / (buffer.BufferHt - 1));
+        row.ry2 = row.ry * row.ry;
+        double cy = row.ry + .5 * cos_time_3;
+        row.cy2 = cy * cy;
+        row.sin_ry_time = buffer.sin((row.ry + time) / 2.0);
+    }
+
     int block = buffer.BufferHt * buffer.BufferWi > 100 ? 1 : -1;
     parallel_for(0, buffer.BufferWi, [&] (int x) {
         double rx = ((float)x / (buffer.BufferWi - 1)); // rx is now in the range 0.0 to 1.0
@@ -113,22 +130,22 @@ void PlasmaEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffer
         {
             // reference: http://www.bidouille.org/prog/plasma
 
-            double ry = ((float)y/(buffer.BufferHt-1)) ;
+            const PlasmaRow& row = rows[y];
+            double ry = row.ry;
             double v = v1;
 
             //  second equation
             v+=buffer.sin (10*(rx*sin_time_2+ry*cos_time_3)+time);
 
             //  third equation
-            double cy=ry+.5*cos_time_3;
-            v+=buffer.sin ( sqrt((Style*50)*((cx2)+(cy*cy))+time));
+            v+=buffer.sin ( sqrt((Style*50)*((cx2)+(row.cy2))+time));
 
             //    vec2 c = v_coords * u_k - u_k/2.0;
             v += sin_rx_time;
-            v += buffer.sin ((ry+time)/2.0);
+            v += row.sin_ry_time;
             v += buffer.sin ((rx+ry+time)/2.0);
             //   c += u_k/2.0 * vec2(buffer.sin (u_time/3.0), buffer.cos (u_time/2.0));
-            v += buffer.sin (sqrt(rx2+ry*ry)+time);
+            v += buffer.sin (sqrt(rx2+row.ry2)+time);
             v = v/2.0;
             // vec3 col = vec3(1, buffer.sin (PI*v), buffer.cos (PI*v));
             //   gl_FragColor = vec4(col*.5 + .5, 1);
@@ -336,6 +336,16 @@ bool RenderableEffect::SupportsRenderCache(const SettingsMap& settings) const
     return false;
 }
 
+bool RenderableEffect::HasActiveValueCurves(const SettingsMap& settings)
+{
+    for (const auto& it : settings) {
+        if (StartsWith(it.first, "VALUECURVE_") && Contains(it.second, "Active=TRUE")) {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool RenderableEffect::needToAdjustSettings(const std::string &version) {
     return IsVersionOlder("2019.61", version);
 }
@@ -68,6 +68,9 @@ class RenderableEffect
         //Methods for rendering the effect
         virtual bool CanRenderOnBackgroundThread(Effect *effect, const SettingsMap &settings, RenderBuffer &buffer) { return true; }
         virtual bool SupportsRenderCache(const SettingsMap& settings) const;
+        // True if with these settings and palette the effect draws exactly the same thing every frame. The render
+        // then keeps the layer buffer from the frame before rather than calling Render again.
+        virtual bool IsStatic(Effect* effect, const SettingsMap& settings, const RenderBuffer& buffer) const { return false; }
         virtual void Render(Effect *effect, SettingsMap &settings, RenderBuffer &buffer) = 0;
         virtual void RenameTimingTrack(std::string oldname, std::string newname, Effect *effect) { }
         virtual std::list<std::string> CheckEffectSettings(const SettingsMap& settings, AudioManager* media, Model* model, Effect* eff, bool renderCache) { std::list<std::string> res; return res; };
@@ -96,6 +99,7 @@ class RenderableEffect
 
         double GetValueCurveDouble(const std::string & name, double def, SettingsMap &SettingsMap, float offset, double min, double max, long startMS, long endMS, int divisor = 1);
         int GetValueCurveInt(const std::string &name, int def, SettingsMap &SettingsMap, float offset, int min, int max, long startMS, long endMS, int divisor = 1);
+        static bool HasActiveValueCurves(const SettingsMap& settings);
         EffectLayer* GetTiming(const std::string& timingtrack) const;
         Effect* GetCurrentTiming(const RenderBuffer& buffer, const std::string& timingtrack) const;
         std::string GetTimingTracks(const int maxLayers = 0, const int absoluteLayers = 0) const;
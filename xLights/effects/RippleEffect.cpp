@@ -270,6 +270,23 @@ void RippleEffect::Drawsquare(RenderBuffer& buffer, int Movement, int x1, int x2
     }
 }
 
+// cos and sin of every whole degree ... circles are drawn a degree at a time for every ring of every frame
+struct DegreeTable
+{
+    double cos[360];
+    double sin[360];
+
+    DegreeTable()
+    {
+        for (int degrees = 0; degrees < 360; degrees++) {
+            double radian = degrees * (M_PI / 180.0);
+            cos[degrees] = std::cos(radian);
+            sin[degrees] = std::sin(radian);
+        }
+    }
+};
+static const DegreeTable degreeTable;
+
 void RippleEffect::Drawcircle(RenderBuffer& buffer, int Movement, int xc, int yc, double radius, HSVValue& hsv, int Ripple_Thickness, int CheckBox_Ripple3D)
 {
     xlColor color(hsv);
@@ -290,10 +307,9 @@ void RippleEffect::Drawcircle(RenderBuffer& buffer, int Movement, int xc, int yc
         }
 
         if (radius >= 0.0) {
-            for (double degrees = 0.0; degrees < 360.0; degrees += 1.0) {
-                double radian = degrees * (M_PI / 180.0);
-                int x = radius * cos(radian) + xc;
-                int y = radius * sin(radian) + yc;
+            for (int degrees = 0; degrees < 360; degrees++) {
+                int x = radius * degreeTable.cos[degrees] + xc;
+                int y = radius * degreeTable.sin[degrees] + yc;
                 buffer.SetPixel(x, y, color); // Turn pixel
             }
         }
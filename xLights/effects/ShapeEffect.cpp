@@ -231,12 +231,12 @@ public:
     int _sinceLastTriggered;
     wxFontInfo _font;
 
-    void AddShape(wxPoint centre, float size, xlColor color, int oset, int shape, int angle, int speed, bool randomMovement, bool holdColour, int colourIndex)
+    void AddShape(RenderRandom& rng, wxPoint centre, float size, xlColor color, int oset, int shape, int angle, int speed, bool randomMovement, bool holdColour, int colourIndex)
     {
         if (randomMovement)
         {
-            speed = rand01() * (SHAPE_VELOCITY_MAX - SHAPE_VELOCITY_MIN) - SHAPE_VELOCITY_MIN;
-            angle = rand01() * (SHAPE_DIRECTION_MAX - SHAPE_DIRECTION_MIN) - SHAPE_VELOCITY_MIN;
+            speed = rng.Rand01() * (SHAPE_VELOCITY_MAX - SHAPE_VELOCITY_MIN) - SHAPE_VELOCITY_MIN;
+            angle = rng.Rand01() * (SHAPE_DIRECTION_MAX - SHAPE_DIRECTION_MIN) - SHAPE_VELOCITY_MIN;
         }
         _shapes.push_back(new ShapeData(centre, size, oset, color, shape, angle, speed, holdColour, colourIndex));
     }
@@ -266,7 +266,7 @@ public:
     }
 };
 
-int ShapeEffect::DecodeShape(const std::string& shape)
+int ShapeEffect::DecodeShape(const std::string& shape, RenderRandom& rng)
 {
     if (shape == "Circle")
     {
@@ -330,7 +330,7 @@ int ShapeEffect::DecodeShape(const std::string& shape)
         return RENDER_SHAPE_EMOJI;
     }
 
-    return rand01() * 14; // exclude emoji
+    return rng.Rand01() * 14; // exclude emoji
 }
 
 static int mapSkinTone(const std::string &v) {
@@ -374,7 +374,7 @@ void ShapeEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffer
 
     int rotation = GetValueCurveInt("Shape_Rotation", 0, SettingsMap, oset, SHAPE_ROTATION_MIN, SHAPE_ROTATION_MAX, buffer.GetStartTimeMS(), buffer.GetEndTimeMS());
 
-    int Object_To_Draw = DecodeShape(Object_To_DrawStr);
+    int Object_To_Draw = DecodeShape(Object_To_DrawStr, buffer.GetRandom());
 
     float f = 0.0;
     bool useMusic = SettingsMap.GetBool("CHECKBOX_Shape_UseMusic", false);
@@ -435,7 +435,7 @@ void ShapeEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffer
             for (int i = _shapes.size(); i < count; ++i) {
                 wxPoint pt;
                 if (randomLocation) {
-                    pt = wxPoint(rand01() * buffer.BufferWi, rand01() * buffer.BufferHt);
+                    pt = wxPoint(buffer.Rand01() * buffer.BufferWi, buffer.Rand01() * buffer.BufferHt);
                 } else {
                     pt = wxPoint(xc, yc);
                 }
@@ -449,10 +449,10 @@ void ShapeEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffer
                 int os = 0;
                 if (startRandomly)
                 {
-                    os = rand01() * lifetimeFrames;
+                    os = buffer.Rand01() * lifetimeFrames;
                 }
 
-                cache->AddShape(pt, startSize + os * growthPerFrame, buffer.palette.GetColor(_lastColorIdx), os, Object_To_Draw, direction, velocity, randomMovement, holdColour, _lastColorIdx);
+                cache->AddShape(buffer.GetRandom(), pt, startSize + os * growthPerFrame, buffer.palette.GetColor(_lastColorIdx), os, Object_To_Draw, direction, velocity, randomMovement, holdColour, _lastColorIdx);
             }
             cache->SortShapes();
         }
@@ -494,7 +494,7 @@ void ShapeEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffer
                         wxPoint pt;
                         if (randomLocation)
                         {
-                            pt = wxPoint(rand01() * buffer.BufferWi, rand01() * buffer.BufferHt);
+                            pt = wxPoint(buffer.Rand01() * buffer.BufferWi, buffer.Rand01() * buffer.BufferHt);
                         }
                         else
                         {
@@ -508,7 +508,7 @@ void ShapeEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffer
                             _lastColorIdx = 0;
                         }
 
-                        cache->AddShape(pt, startSize, buffer.palette.GetColor(_lastColorIdx), 0, Object_To_Draw, direction, velocity, randomMovement, holdColour, _lastColorIdx);
+                        cache->AddShape(buffer.GetRandom(), pt, startSize, buffer.palette.GetColor(_lastColorIdx), 0, Object_To_Draw, direction, velocity, randomMovement, holdColour, _lastColorIdx);
                         break;
                     }
                 }
@@ -526,7 +526,7 @@ void ShapeEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffer
                 wxPoint pt;
                 if (randomLocation)
                 {
-                    pt = wxPoint(rand01() * buffer.BufferWi, rand01() * buffer.BufferHt);
+                    pt = wxPoint(buffer.Rand01() * buffer.BufferWi, buffer.Rand01() * buffer.BufferHt);
                 }
                 else
                 {
@@ -540,7 +540,7 @@ void ShapeEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffer
                     _lastColorIdx = 0;
                 }
 
-                cache->AddShape(pt, startSize, buffer.palette.GetColor(_lastColorIdx), 0, Object_To_Draw, direction, velocity, randomMovement, holdColour, _lastColorIdx);
+                cache->AddShape(buffer.GetRandom(), pt, startSize, buffer.palette.GetColor(_lastColorIdx), 0, Object_To_Draw, direction, velocity, randomMovement, holdColour, _lastColorIdx);
             }
 
             // if music is over the trigger level for REPEATTRIGGER frames then we will trigger another firework
@@ -563,7 +563,7 @@ void ShapeEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffer
             wxPoint pt;
             if (randomLocation)
             {
-                pt = wxPoint(rand01() * buffer.BufferWi, rand01() * buffer.BufferHt);
+                pt = wxPoint(buffer.Rand01() * buffer.BufferWi, buffer.Rand01() * buffer.BufferHt);
             }
             else
             {
@@ -577,7 +577,7 @@ void ShapeEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffer
                 _lastColorIdx = 0;
             }
 
-            cache->AddShape(pt, startSize, buffer.palette.GetColor(_lastColorIdx), 0, Object_To_Draw, direction, velocity, randomMovement, holdColour, _lastColorIdx);
+            cache->AddShape(buffer.GetRandom(), pt, startSize, buffer.palette.GetColor(_lastColorIdx), 0, Object_To_Draw, direction, velocity, randomMovement, holdColour, _lastColorIdx);
         }
     }
 
@@ -58,6 +58,8 @@ constexpr char NATIVE_EMOJI_FONT[] = "Apple Color Emoji";
 constexpr char NATIVE_EMOJI_FONT[] = "Noto Color Emoji";
 #endif
 
+class RenderRandom;
+
 class ShapeEffect : public RenderableEffect
 {
     public:
@@ -77,7 +79,7 @@ protected:
         virtual xlEffectPanel *CreatePanel(wxWindow *parent) override;
     private:
 
-    static int DecodeShape(const std::string& shape);
+    static int DecodeShape(const std::string& shape, RenderRandom& rng);
         void SetPanelTimingTracks() const;
         void Drawcircle(RenderBuffer &buffer, int xc, int yc, double radius, xlColor color, int thickness) const;
         void Drawheart(RenderBuffer &buffer, int xc, int yc, double radius, xlColor color, int thickness, double rotation) const;
@@ -112,17 +112,27 @@ void ShockwaveEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuf
     radius2 = radius_center + half_width;
     radius1 = std::max(0.0, radius1);
 
-    for (int x = 0; x < buffer.BufferWi; x++)
+    // only the ring can be drawn
+    int outer = (int)std::ceil(radius2);
+    int xstart = std::max(0, xc_adj - outer);
+    int xend = std::min(buffer.BufferWi, xc_adj + outer + 1);
+    int ystart = std::max(0, yc_adj - outer);
+    int yend = std::min(buffer.BufferHt, yc_adj + outer + 1);
+    std::shared_ptr<const PolarTable> polar = RenderBuffer::GetPolarTable(std::max(std::abs(xstart - xc_adj), std::abs(xend - 1 - xc_adj)),
+                                                                          std::max(std::abs(ystart - yc_adj), std::abs(yend - 1 - yc_adj)));
+    bool spatial = buffer.palette.IsSpatial(color_index);
+
+    for (int x = xstart; x < xend; x++)
     {
         int x1 = x - xc_adj;
-        for (int y = 0; y < buffer.BufferHt; y++)
+        for (int y = ystart; y < yend; y++)
         {
             int y1 = y - yc_adj;
-            double r = std::hypot(x1, y1);
+            double r = polar ? polar->Radius(x1, y1) : std::hypot(x1, y1);
             if( r >= radius1 && r <= radius2 ) {
-                if (buffer.palette.IsSpatial(color_index))
+                if (spatial)
                 {
-                    double theta = (((std::atan2(x1, y1) * 180.0 / PI)) + 180.0) / 360.0;
+                    double theta = ((((polar ? polar->Angle(x1, y1) : std::atan2(x1, y1)) * 180.0 / PI)) + 180.0) / 360.0;
                     buffer.palette.GetSpatialColor(color_index, radius1, 0, r, 0, theta, radius2, color);
                     hsv = color.asHSV();
                 }
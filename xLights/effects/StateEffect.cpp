@@ -13,6 +13,7 @@
 #include "StateEffect.h"
 #include "StatePanel.h"
 #include "../models/Model.h"
+#include "../models/FaceStateDefinition.h"
 #include "../sequencer/SequenceElements.h"
 #include "../sequencer/Effect.h"
 #include "../RenderBuffer.h"
@@ -265,22 +266,14 @@ void StateEffect::RenderState(RenderBuffer &buffer,
         }
     }
 
-    if (definition == "")
+    if (definition == "" || !found)
     {
         return;
     }
 
-    std::string modelType = found ? model_info->stateInfo[definition]["Type"] : definition;
-    if (modelType == "") {
-        modelType = definition;
-    }
-
-    int type = 1;
-
-    if ("SingleNode" == modelType) {
-        type = 0;
-    } else if ("NodeRange" == modelType) {
-        type = 1;
+    std::shared_ptr<const FaceStateDefinition> def = model_info->GetStateDefinition(definition);
+    if (def == nullptr) {
+        return;
     }
 
     std::string tstates = Phoneme;
@@ -335,13 +328,8 @@ void StateEffect::RenderState(RenderBuffer &buffer,
             wxString token = tkz.GetNextToken();
             if (token == "*" || token == "<ALL>")
             {
-                for (auto it2 : model_info->stateInfo[definition])
-                {
-                    if (EndsWith(it2.first, "-Name") && it2.second != "")
-                    {
-                        sstates.push_back(Lower(it2.second));
-                    }
-                }
+                const std::vector<std::string>& all = def->GetAllStateNames();
+                sstates.insert(sstates.end(), all.begin(), all.end());
             }
             else
             {
@@ -488,13 +476,8 @@ void StateEffect::RenderState(RenderBuffer &buffer,
             wxString token = tkz.GetNextToken();
             if (token == "*" || token == "<ALL>")
             {
-                for (auto it2 : model_info->stateInfo[definition])
-                {
-                    if (EndsWith(it2.first, "-Name") && it2.second != "")
-                    {
-                        sstates.push_back(Lower(it2.second));
-                    }
-                }
+                const std::vector<std::string>& all = def->GetAllStateNames();
+                sstates.insert(sstates.end(), all.begin(), all.end());
             }
             else
             {
@@ -510,83 +493,36 @@ void StateEffect::RenderState(RenderBuffer &buffer,
         }
     }
 
-    bool customColor = found ? model_info->stateInfo[definition]["CustomColors"] == "1" : false;
+    bool customColor = def->HasCustomColors();
 
     // process each token
     for (size_t i = 0; i < sstates.size(); i++)
     {
-        for (const auto& it : model_info->stateInfo[definition])
+        for (int id : def->GetStatesNamed(sstates[i]))
         {
-            if (it.second == sstates[i] && EndsWith(it.first, "-Name"))
-            {
-                // get the channels
-                std::string statename = BeforeFirst(it.first, '-');// FindState(model_info->stateInfo[definition], sstates[i]);
-                std::string channels = model_info->stateInfo[definition][statename];
+            const FaceStateDefinition::Part& state = def->GetPart(id);
 
-                if (statename != "" && channels != "")
-                {
-                    xlColor color;
-                    if (colourmode == "Graduate")
-                    {
-                        buffer.GetMultiColorBlend(buffer.GetEffectTimeIntervalPosition(), false, color);
-                    }
-                    else if (colourmode == "Cycle")
-                    {
-                        buffer.palette.GetColor((intervalnumber - 1) % buffer.GetColorCount(), color);
-                    }
-                    else
-                    {
-                        // allocate
-                        int statenum = wxAtoi(statename.substr(1));
-                        buffer.palette.GetColor((statenum - 1) % buffer.GetColorCount(), color);
-                    }
-                    if (customColor) {
-                        std::string cname = model_info->stateInfo[definition][statename + "-Color"];
-                        if (cname == "") {
-                            color = xlWHITE;
-                        }
-                        else {
-                            color = xlColor(cname);
-                        }
-                    }
+            xlColor color;
+            if (colourmode == "Graduate")
+            {
+                buffer.GetMultiColorBlend(buffer.GetEffectTimeIntervalPosition(), false, color);
+            }
+            else if (colourmode == "Cycle")
+            {
+                buffer.palette.GetColor((intervalnumber - 1) % buffer.GetColorCount(), color);
+            }
+            else
+            {
+                // allocate
+                buffer.palette.GetColor((state.number - 1) % buffer.GetColorCount(), color);
+            }
+            if (customColor) {
+                color = state.color;
+            }
 
-                    wxStringTokenizer wtkz(channels, ",");
-                    while (wtkz.HasMoreTokens())
-                    {
-                        wxString valstr = wtkz.GetNextToken();
-
-                        if (type == 0) {
-                            for (size_t n = 0; n < model_info->GetNodeCount(); n++) {
-                                wxString nn = model_info->GetNodeName(n, true);
-                                if (nn == valstr) {
-                                    buffer.SetNodePixel(n, color, true);
-                                }
-                            }
-                        }
-                        else if (type == 1) {
-                            int start, end;
-                            if (valstr.Contains("-")) {
-                                int idx = valstr.Index('-');
-                                start = wxAtoi(valstr.Left(idx));
-                                end = wxAtoi(valstr.Right(valstr.size() - idx - 1));
-                                if (end < start)
-                                {
-                                    std::swap(start, end);
-                                }
-                            }
-                            else {
-                                start = end = wxAtoi(valstr);
-                            }
-                            if (start > end) {
-                                start = end;
-                            }
-                            start--;
-                            end--;
-                            for (int n = start; n <= end; n++) {
-                                buffer.SetNodePixel(n, color, true);
-                            }
-                        }
-                    }
+            for (const auto& span : state.spans) {
+                for (int n = span.first; n <= span.second; n++) {
+                    buffer.SetNodePixel(n, color, true);
                 }
             }
         }
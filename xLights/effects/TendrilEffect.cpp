@@ -109,7 +109,17 @@ ATendril::~ATendril()
 	}
 }
 
-ATendril::ATendril(float friction, int size, float dampening, float tension, float spring, const wxPoint& start, size_t maxx, size_t maxy)
+ATendril::ATendril(const ATendril& tendril) :
+    _friction(tendril._friction), _size(tendril._size), _dampening(tendril._dampening), _tension(tendril._tension),
+    _spring(tendril._spring), _thickness(tendril._thickness), _width(tendril._width), _height(tendril._height)
+{
+    for (const auto& it : tendril._nodes)
+    {
+        _nodes.push_back(new TendrilNode(*it));
+    }
+}
+
+ATendril::ATendril(RenderRandom& rng, float friction, int size, float dampening, float tension, float spring, const wxPoint& start, size_t maxx, size_t maxy)
 {
     _width = maxx;
     _height = maxy;
@@ -136,11 +146,11 @@ ATendril::ATendril(float friction, int size, float dampening, float tension, flo
 	_friction = 0.5f;
 	if (friction >= 0)
 	{
-		_friction = friction + ((float)rand())/(float)RAND_MAX * 0.01f - 0.005f;
+		_friction = friction + (float)rng.Rand01() * 0.01f - 0.005f;
 	}
 	else
 	{
-		_friction = _friction + ((float)rand())/(float)RAND_MAX * 0.01f - 0.005f;
+		_friction = _friction + (float)rng.Rand01() * 0.01f - 0.005f;
 	}
 
     _nodes.clear();
@@ -259,7 +269,25 @@ Tendril::~Tendril()
 	}
 }
 
-Tendril::Tendril(float friction, int trails, int size, float dampening, float tension, float springbase, float springincr, const wxPoint& start, size_t maxx, size_t maxy)
+Tendril::Tendril(const Tendril& tendril) : _width(tendril._width), _height(tendril._height)
+{
+    for (const auto& it : tendril._tendrils)
+    {
+        _tendrils.push_back(new ATendril(*it));
+    }
+}
+
+size_t Tendril::GetSize() const
+{
+    size_t size = sizeof(Tendril);
+    for (const auto& it : _tendrils)
+    {
+        size += it->GetSize();
+    }
+    return size;
+}
+
+Tendril::Tendril(RenderRandom& rng, float friction, int trails, int size, float dampening, float tension, float springbase, float springincr, const wxPoint& start, size_t maxx, size_t maxy)
 {
     _width = maxx;
     _height = maxy;
@@ -283,7 +311,7 @@ Tendril::Tendril(float friction, int trails, int size, float dampening, float te
 	for (int i = 0; i < t; i++)
 	{
 		float aspring = sb + si * ((float)i / (float)t);
-		ATendril* at = new ATendril(friction, size, dampening, tension, aspring, start, maxx, maxy);
+		ATendril* at = new ATendril(rng, friction, size, dampening, tension, aspring, start, maxx, maxy);
 		if (at != nullptr)
 		{
 			_tendrils.push_back(at);
@@ -291,7 +319,7 @@ Tendril::Tendril(float friction, int trails, int size, float dampening, float te
 	}
 }
 
-void Tendril::UpdateRandomMove(int tunemovement)
+void Tendril::UpdateRandomMove(RenderRandom& rng, int tunemovement)
 {
     if (tunemovement < 1)
     {
@@ -340,12 +368,12 @@ void Tendril::UpdateRandomMove(int tunemovement)
 			int x = 0;
 			if (xmove > 0)
 			{
-				x = (rand() % xmove) + realminmovex;
+				x = (rng.Rand() % xmove) + realminmovex;
 			}
 			int y = 0;
 			if (ymove > 0)
 			{
-				y = (rand() % ymove) + realminmovey;
+				y = (rng.Rand() % ymove) + realminmovey;
 			}
 
 			current->x = current->x + x;
@@ -476,6 +504,20 @@ public:
 			_tendril = nullptr;
 		}
 	};
+    virtual EffectRenderCache* Checkpoint() const override {
+        TendrilRenderCache* cache = new TendrilRenderCache();
+        cache->_mv1 = _mv1;
+        cache->_mv2 = _mv2;
+        cache->_mv3 = _mv3;
+        cache->_mv4 = _mv4;
+        if (_tendril != nullptr) {
+            cache->_tendril = new Tendril(*_tendril);
+        }
+        return cache;
+    }
+    virtual size_t GetCheckpointSize() const override {
+        return sizeof(*this) + (_tendril == nullptr ? 0 : _tendril->GetSize());
+    }
 
     int _mv1;
     int _mv2;
@@ -601,7 +643,7 @@ void TendrilEffect::Render(RenderBuffer &buffer, const std::string& movement,
         {
         case 1:
             // random
-            _tendril = new Tendril(friction, trails, length, dampening, tension, -1, -1, startmiddle, buffer.BufferWi, buffer.BufferHt);
+            _tendril = new Tendril(buffer.GetRandom(), friction, trails, length, dampening, tension, -1, -1, startmiddle, buffer.BufferWi, buffer.BufferHt);
             break;
         case 2:
             // corners
@@ -613,7 +655,7 @@ void TendrilEffect::Render(RenderBuffer &buffer, const std::string& movement,
             {
                 _mv4 = 1;
             }
-            _tendril = new Tendril(friction, trails, length, dampening, tension, -1, -1, startbottomleft, buffer.BufferWi, buffer.BufferHt);
+            _tendril = new Tendril(buffer.GetRandom(), friction, trails, length, dampening, tension, -1, -1, startbottomleft, buffer.BufferWi, buffer.BufferHt);
             break;
         case 3:
             // circles
@@ -624,7 +666,7 @@ void TendrilEffect::Render(RenderBuffer &buffer, const std::string& movement,
             {
                 _mv3 = 1;
             }
-            _tendril = new Tendril(friction, trails, length, dampening, tension, -1, -1, startmiddle, buffer.BufferWi, buffer.BufferHt);
+            _tendril = new Tendril(buffer.GetRandom(), friction, trails, length, dampening, tension, -1, -1, startmiddle, buffer.BufferWi, buffer.BufferHt);
             break;
         case 4:
             // horizontal zig zag
@@ -635,14 +677,14 @@ void TendrilEffect::Render(RenderBuffer &buffer, const std::string& movement,
                 _mv2 = 1;
             }
             _mv3 = 1; // direction
-            _tendril = new Tendril(friction, trails, length, dampening, tension, -1, -1, startmiddlebottom, buffer.BufferWi, buffer.BufferHt);
+            _tendril = new Tendril(buffer.GetRandom(), friction, trails, length, dampening, tension, -1, -1, startmiddlebottom, buffer.BufferWi, buffer.BufferHt);
             break;
         case 5:
             // vertical zig zag
             _mv1 = 0 + truexoffset; // current x
             _mv2 = (double)tunemovement * 1.5;
             _mv3 = 1; // direction
-            _tendril = new Tendril(friction, trails, length, dampening, tension, -1, -1, startmiddleleft, buffer.BufferWi, buffer.BufferHt);
+            _tendril = new Tendril(buffer.GetRandom(), friction, trails, length, dampening, tension, -1, -1, startmiddleleft, buffer.BufferWi, buffer.BufferHt);
             break;
         case 6:
             // line movement based on music
@@ -652,7 +694,7 @@ void TendrilEffect::Render(RenderBuffer &buffer, const std::string& movement,
             {
                 _mv3 = 1;
             }
-            _tendril = new Tendril(friction, trails, length, dampening, tension, -1, -1, startbottomleft, buffer.BufferWi, buffer.BufferHt);
+            _tendril = new Tendril(buffer.GetRandom(), friction, trails, length, dampening, tension, -1, -1, startbottomleft, buffer.BufferWi, buffer.BufferHt);
             break;
         case 7:
             // circle movement based on music
@@ -663,7 +705,7 @@ void TendrilEffect::Render(RenderBuffer &buffer, const std::string& movement,
             {
                 _mv3 = 1;
             }
-            _tendril = new Tendril(friction, trails, length, dampening, tension, -1, -1, startmiddle, buffer.BufferWi, buffer.BufferHt);
+            _tendril = new Tendril(buffer.GetRandom(), friction, trails, length, dampening, tension, -1, -1, startmiddle, buffer.BufferWi, buffer.BufferHt);
             break;
         case 9:
             // horizontal zig zag return
@@ -674,17 +716,17 @@ void TendrilEffect::Render(RenderBuffer &buffer, const std::string& movement,
                 _mv2 = 1;
             }
             _mv3 = 1; // direction
-            _tendril = new Tendril(friction, trails, length, dampening, tension, -1, -1, startmiddlebottom, buffer.BufferWi, buffer.BufferHt);
+            _tendril = new Tendril(buffer.GetRandom(), friction, trails, length, dampening, tension, -1, -1, startmiddlebottom, buffer.BufferWi, buffer.BufferHt);
             break;
         case 8:
             // vertical zig zag return
             _mv1 = 0; // current x
             _mv2 = (double)tunemovement * 1.5;
             _mv3 = 1; // direction
-            _tendril = new Tendril(friction, trails, length, dampening, tension, -1, -1, startmiddleleft, buffer.BufferWi, buffer.BufferHt);
+            _tendril = new Tendril(buffer.GetRandom(), friction, trails, length, dampening, tension, -1, -1, startmiddleleft, buffer.BufferWi, buffer.BufferHt);
             break;
         case 10:
-            _tendril = new Tendril(friction, trails, length, dampening, tension, -1, -1, wxPoint(manualx * buffer.BufferWi / 100, manualy * buffer.BufferHt / 100), buffer.BufferWi, buffer.BufferHt);
+            _tendril = new Tendril(buffer.GetRandom(), friction, trails, length, dampening, tension, -1, -1, wxPoint(manualx * buffer.BufferWi / 100, manualy * buffer.BufferHt / 100), buffer.BufferWi, buffer.BufferHt);
             break;
         }
     }
@@ -710,7 +752,7 @@ void TendrilEffect::Render(RenderBuffer &buffer, const std::string& movement,
             // random
             if (_tendril != nullptr)
             {
-                _tendril->UpdateRandomMove(tunemovement);
+                _tendril->UpdateRandomMove(buffer.GetRandom(), tunemovement);
             }
             break;
         case 2:
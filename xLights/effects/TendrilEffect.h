@@ -18,6 +18,7 @@
 #include <wx/colour.h>
 #include <wx/dcmemory.h>
 class wxString;
+class RenderRandom;
 
 #define TENDRIL_MOVEMENT_MIN 0
 #define TENDRIL_MOVEMENT_MAX 20
@@ -65,10 +66,12 @@ class ATendril
 	public:
 
 	~ATendril();
-	ATendril(float friction, int size, float dampening, float tension, float spring, const wxPoint& start, size_t maxx, size_t maxy);
+	ATendril(const ATendril& tendril);
+	ATendril(RenderRandom& rng, float friction, int size, float dampening, float tension, float spring, const wxPoint& start, size_t maxx, size_t maxy);
 	void Update(wxPoint* target);
 	void Draw(PathDrawingContext* gc, xlColor colour, int thickness);
 	wxPoint* LastLocation();
+	size_t GetSize() const { return sizeof(ATendril) + _nodes.size() * sizeof(TendrilNode); }
 };
 
 class Tendril
@@ -80,11 +83,13 @@ class Tendril
 	public:
 
 	~Tendril();
-	Tendril(float friction, int trails, int size, float dampening, float tension, float springbase, float springincr, const wxPoint& start, size_t maxx, size_t maxy);
-	void UpdateRandomMove(int tunemovement);
+	Tendril(const Tendril& tendril);
+	Tendril(RenderRandom& rng, float friction, int trails, int size, float dampening, float tension, float springbase, float springincr, const wxPoint& start, size_t maxx, size_t maxy);
+	void UpdateRandomMove(RenderRandom& rng, int tunemovement);
     void Update(wxPoint* target);
     void Update(int x, int y);
     void Draw(PathDrawingContext* gc, xlColor colour, int thickness);
+    size_t GetSize() const;
 };
 
 class TendrilEffect : public RenderableEffect
@@ -13,6 +13,9 @@
 #include <mutex>
 #include <array>
 #include <unordered_map>
+#include <list>
+#include <map>
+#include <memory>
 
 #include "TextPanel.h"
 #include <wx/checkbox.h>
@@ -28,6 +31,7 @@
 #include "../xLightsMain.h"
 #include "../ExternalHooks.h"
 #include "../xLightsXmlFile.h"
+#include "../MemoryAccounting.h"
 
 #include "../../include/text-16.xpm"
 #include "../../include/text-24.xpm"
@@ -667,19 +671,21 @@ wxSize GetMultiLineTextExtent(TextDrawingContext *dc,
 class CachedTextInfo {
 public:
     CachedTextInfo() {}
-    CachedTextInfo(const std::string &txt, const std::string font, const std::vector<xlColor> &c, const wxRect &r)
-    : text(txt), rect(r), color(c), fontString(font) {}
+    CachedTextInfo(const std::string &txt, const std::string font, const std::vector<xlColor> &c, const wxRect &r, const wxSize &sz)
+    : text(txt), rect(r), size(sz), color(c), fontString(font) {}
     ~CachedTextInfo() {}
     
     bool operator==(const CachedTextInfo &i) const {
         return (text == i.text)
             && (fontString == i.fontString)
             && (rect == i.rect)
+            && (size == i.size)
             && (color == i.color);
     }
     
     std::string text;
     wxRect rect;
+    wxSize size; // size of the drawing context the image was rendered into
     std::vector<xlColor> color;
     std::string fontString;
 };
@@ -693,42 +699,162 @@ struct CachedTextInfoHasher {
             h1 ^= a.GetRGB() << 3;
         }
         h1 ^= (std::abs(t.rect.x) << 8) + (std::abs(t.rect.y) << 16);
+        h1 ^= ((size_t)t.size.x << 24) + ((size_t)t.size.y << 40);
         return h1;
     }
 };
 
+// Rendered text lines and text extents shared by all text effects.
+//
+// Lyric and countdown heavy sequences have many text effects showing the same words in the same font
+// on the same sized buffers. Rasterising a line needs one of the pooled drawing contexts and is by far
+// the slowest part of the text effect, so once any effect has drawn a line every other effect just
+// copies the pixels. Images are handed out as shared pointers so an effect can keep using one after it
+// has been evicted here.
+class SharedTextCache {
+public:
+    static SharedTextCache& Instance() {
+        static SharedTextCache cache;
+        return cache;
+    }
+
+    std::shared_ptr<wxImage> GetImage(const CachedTextInfo &inf) {
+        std::unique_lock<std::mutex> lock(_lock);
+        auto it = _images.find(inf);
+        if (it == _images.end()) {
+            return nullptr;
+        }
+        _lru.splice(_lru.begin(), _lru, it->second.second);
+        return it->second.first;
+    }
+    void PutImage(const CachedTextInfo &inf, std::shared_ptr<wxImage> img) {
+        size_t bytes = ImageBytes(*img);
+        if (bytes > MAX_IMAGE_BYTES / 8) {
+            return;
+        }
+        {
+            std::unique_lock<std::mutex> lock(_lock);
+            if (_images.find(inf) != _images.end()) {
+                return;
+            }
+            _lru.push_front(inf);
+            _images[inf] = std::make_pair(img, _lru.begin());
+            _imageBytes += bytes;
+            MemoryAccounting::Add(MemoryAccounting::EFFECT_CACHES, bytes);
+            EvictTo(MAX_IMAGE_BYTES);
+        }
+        MemoryAccounting::CheckBudget();
+    }
+
+    bool GetExtent(const std::string &font, const wxString &msg, wxSize &sz) {
+        std::unique_lock<std::mutex> lock(_lock);
+        auto it = _extents.find(std::make_pair(font, msg));
+        if (it == _extents.end()) {
+            return false;
+        }
+        sz = it->second;
+        return true;
+    }
+    void PutExtent(const std::string &font, const wxString &msg, const wxSize &sz) {
+        std::unique_lock<std::mutex> lock(_lock);
+        if (_extents.size() >= MAX_EXTENTS) {
+            _extents.clear();
+        }
+        _extents[std::make_pair(font, msg)] = sz;
+    }
+
+private:
+    static const size_t MAX_IMAGE_BYTES = 64 * 1024 * 1024;
+    static const size_t MAX_EXTENTS = 50000;
+
+    SharedTextCache() {
+        // text is cheap to draw again so give it up before anything else
+        _reclaimerId = MemoryAccounting::RegisterReclaimer(MemoryAccounting::EFFECT_CACHES, MemoryAccounting::COST_REDRAW,
+                                                           [this](size_t bytesWanted) { return Reclaim(bytesWanted); });
+    }
+    ~SharedTextCache() {
+        MemoryAccounting::UnregisterReclaimer(_reclaimerId);
+        MemoryAccounting::Remove(MemoryAccounting::EFFECT_CACHES, _imageBytes);
+    }
+
+    static size_t ImageBytes(const wxImage &img) {
+        return (size_t)img.GetWidth() * img.GetHeight() * (img.HasAlpha() ? 4 : 3);
+    }
+    // must hold _lock
+    size_t EvictTo(size_t maxBytes) {
+        size_t freed = 0;
+        while (_imageBytes > maxBytes && !_lru.empty()) {
+            auto old = _images.find(_lru.back());
+            size_t bytes = ImageBytes(*old->second.first);
+            _imageBytes -= bytes;
+            freed += bytes;
+            _images.erase(old);
+            _lru.pop_back();
+        }
+        MemoryAccounting::Remove(MemoryAccounting::EFFECT_CACHES, freed);
+        return freed;
+    }
+    size_t Reclaim(size_t bytesWanted) {
+        std::unique_lock<std::mutex> lock(_lock, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            return 0;
+        }
+        return EvictTo(_imageBytes > bytesWanted ? _imageBytes - bytesWanted : 0);
+    }
+
+    int _reclaimerId = 0;
+
+    std::mutex _lock;
+    std::list<CachedTextInfo> _lru;
+    std::unordered_map<CachedTextInfo, std::pair<std::shared_ptr<wxImage>, std::list<CachedTextInfo>::iterator>, CachedTextInfoHasher> _images;
+    size_t _imageBytes = 0;
+    std::map<std::pair<std::string, wxString>, wxSize> _extents;
+};
+
 class TextRenderCache : public EffectRenderCache {
 public:
     TextRenderCache() : timer_countdown(0), synced_textsize(wxSize(0,0)) {};
-    virtual ~TextRenderCache() {
-        for (const auto& it : textCache) {
-            delete it.second;
-        }
-    };
+    virtual ~TextRenderCache() {};
     int timer_countdown;
     wxSize synced_textsize;
     
     wxImage *GetImage(const CachedTextInfo &inf) {
-        return textCache[inf];
+        auto it = textCache.find(inf);
+        if (it != textCache.end()) {
+            return it->second.get();
+        }
+        std::shared_ptr<wxImage> img = SharedTextCache::Instance().GetImage(inf);
+        if (img == nullptr) {
+            return nullptr;
+        }
+        textCache[inf] = img;
+        return img.get();
     }
     void PutImage(const CachedTextInfo &inf, wxImage *img) {
-        textCache[inf] = img;
+        std::shared_ptr<wxImage> i(img);
+        textCache[inf] = i;
+        SharedTextCache::Instance().PutImage(inf, i);
     }
     
     wxSize GetMultiLineTextExtent(const std::string &font, const wxString &msg) {
         std::pair<std::string, wxString> key(font, msg);
         auto i = textExtentCache.find(key);
         if (i == textExtentCache.end()) {
-            return wxSize(-1, -1);
+            wxSize sz(-1, -1);
+            if (SharedTextCache::Instance().GetExtent(font, msg, sz)) {
+                textExtentCache[key] = sz;
+            }
+            return sz;
         }
         return i->second;
     }
     void PutMultiLineTextExtent(const std::string &font, const wxString &msg, const wxSize &sz) {
         std::pair<std::string, wxString> key(font, msg);
         textExtentCache[key] = sz;
+        SharedTextCache::Instance().PutExtent(font, msg, sz);
     }
     
-    std::unordered_map<CachedTextInfo, wxImage*, CachedTextInfoHasher> textCache;
+    std::unordered_map<CachedTextInfo, std::shared_ptr<wxImage>, CachedTextInfoHasher> textCache;
     std::map<std::pair<std::string, wxString>, wxSize> textExtentCache;
 };
 
@@ -1102,7 +1228,7 @@ wxImage *TextEffect::RenderTextLine(RenderBuffer &buffer,
         if (colors.size() == 0) {
             colors.push_back(xlWHITE);
         }
-        CachedTextInfo inf(msg.ToStdString(), fontString, colors, rect);
+        CachedTextInfo inf(msg.ToStdString(), fontString, colors, rect, wxSize(buffer.BufferWi, buffer.BufferHt));
         wxImage *img = GetCache(buffer,id)->GetImage(inf);
         if (img == nullptr) {
             dc->Clear();
@@ -14,6 +14,7 @@
 #include "../sequencer/Effect.h"
 #include "../RenderBuffer.h"
 #include "../UtilClasses.h"
+#include "../UtilFunctions.h"
 
 #include "../../include/twinkle-16.xpm"
 #include "../../include/twinkle-24.xpm"
@@ -24,13 +25,8 @@
 
 #include "../Parallel.h"
 
-#include <random>
 #include <cmath>
 
-static std::random_device rd;
-static std::default_random_engine eng{ rd() };
-static std::uniform_int_distribution<> dist(0, INT_MAX);
-
 TwinkleEffect::TwinkleEffect(int id) : RenderableEffect(id, "Twinkle", twinkle_16, twinkle_24, twinkle_32, twinkle_48, twinkle_64)
 {
     //ctor
@@ -188,12 +184,12 @@ int TwinkleEffect::DrawEffectBackground(const Effect *e, int x1, int y1, int x2,
 static void place_twinkles(int lights_to_place, int &curIndex, std::vector<StrobeClass>& strobe, RenderBuffer& buffer,
                            int max_modulo, size_t colorcnt) {
     while (lights_to_place > 0 && (curIndex < strobe.size())) {
-        int idx = dist(eng) % (strobe.size() - curIndex) + curIndex;
+        int idx = buffer.Rand() % (strobe.size() - curIndex) + curIndex;
         if (idx != curIndex) {
             std::swap(strobe[idx], strobe[curIndex]);
         }
-        strobe[curIndex].duration = dist(eng) % max_modulo;
-        strobe[curIndex].colorindex = dist(eng) % colorcnt;
+        strobe[curIndex].duration = buffer.Rand() % max_modulo;
+        strobe[curIndex].colorindex = buffer.Rand() % colorcnt;
         strobe[curIndex].strobing = true;
         curIndex++;
         lights_to_place--;
@@ -295,7 +291,7 @@ void TwinkleEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffe
             }
             //randomize the locations
             for (int s = 0; s < strobe.size(); ++s) {
-                int r = dist(eng) % strobe.size();
+                int r = buffer.Rand() % strobe.size();
                 if (r != s) {
                     std::swap(strobe[r], strobe[s]);
                 }
@@ -308,13 +304,13 @@ void TwinkleEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffe
                     if (i % step == 1 || step == 1) {
                         int s = strobe.size();
                         strobe.resize(s + 1);
-                        strobe[s].duration = dist(eng) % max_modulo;
+                        strobe[s].duration = buffer.Rand() % max_modulo;
 
                         strobe[s].x = i;
                         strobe[s].y = 0;
                         strobe[s].isByNode = true;
 
-                        strobe[s].colorindex = dist(eng) % colorcnt;
+                        strobe[s].colorindex = buffer.Rand() % colorcnt;
                         cache->curNumStrobe++;
                     }
                 }
@@ -325,13 +321,13 @@ void TwinkleEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffe
                         if (i % step == 1 || step == 1) {
                             int s = strobe.size();
                             strobe.resize(s + 1);
-                            strobe[s].duration = dist(eng) % max_modulo;
+                            strobe[s].duration = buffer.Rand() % max_modulo;
 
                             strobe[s].x = x;
                             strobe[s].y = y;
                             strobe[s].isByNode = false;
 
-                            strobe[s].colorindex = dist(eng) % colorcnt;
+                            strobe[s].colorindex = buffer.Rand() % colorcnt;
                             cache->curNumStrobe++;
                         }
                     }
@@ -361,7 +357,9 @@ void TwinkleEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffe
         }
     }
 
-    parallel_for(0, cache->curNumStrobe, [&strobe, &buffer, max_modulo, max_modulo2, colorcnt, reRandomize, Strobe, new_algorithm, cache](int x) {
+    // each light gets its own generator so the result doesnt depend on how the lights are split between threads
+    uint64_t randomBase = buffer.GetRandom().Next();
+    parallel_for(0, cache->curNumStrobe, [&strobe, &buffer, max_modulo, max_modulo2, colorcnt, reRandomize, Strobe, new_algorithm, cache, randomBase](int x) {
         strobe[x].duration++;
         if (new_algorithm) {
             if (!strobe[x].strobing) {
@@ -377,8 +375,10 @@ void TwinkleEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffe
                 cache->lights_to_renew++;
                 strobe[x].strobing = false;
             } else if (reRandomize) {
-                strobe[x].duration -= dist(eng) % max_modulo2;
-                strobe[x].colorindex = dist(eng) % colorcnt;
+                RenderRandom rng;
+                rng.Seed(FNV1a(randomBase, (uint64_t)x));
+                strobe[x].duration -= rng.Rand() % max_modulo2;
+                strobe[x].colorindex = rng.Rand() % colorcnt;
             }
         }
         int i7 = strobe[x].duration;
@@ -2755,7 +2755,7 @@ void VUMeterEffect::RenderLevelBarFrame(RenderBuffer &buffer, int bars, int sens
             if (random && bars > 2) {
                 int lb = lastbar;
                 while (lb == (int)lastbar) {
-                    lastbar = 1 + rand01() * bars;
+                    lastbar = 1 + buffer.Rand01() * bars;
                 }
                 if (lastbar > bars) lastbar = 1;
             }
@@ -2826,7 +2826,7 @@ void VUMeterEffect::RenderTimingEventBarFrame(RenderBuffer &buffer, int bars, st
                 if (random && bars > 2) {
                     int lb = lastbar;
                     while (lb == (int)lastbar) {
-                        lastbar = 1 + rand01() * bars;
+                        lastbar = 1 + buffer.Rand01() * bars;
                     }
                     if (lastbar > bars + 1) lastbar = 1;
                 }
@@ -2919,7 +2919,7 @@ void VUMeterEffect::RenderNoteLevelBarFrame(RenderBuffer &buffer, int bars, int
             if (random && bars > 2) {
                 int lb = lastbar;
                 while (lb == (int)lastbar) {
-                    lastbar = 1 + rand01() * bars;
+                    lastbar = 1 + buffer.Rand01() * bars;
                 }
                 if (lastbar > bars) lastbar = 1;
             }
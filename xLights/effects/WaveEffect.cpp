@@ -186,14 +186,14 @@ void WaveEffect::Render(Effect *effect, SettingsMap &SettingsMap, RenderBuffer &
             int delta = 0; //next branch length, angle
             WaveBuffer0.resize(NumberWaves * buffer.BufferWi);
             for (int x1 = 0; x1 < NumberWaves * buffer.BufferWi; ++x1) {
-                //                if (delay < 1) angle = (rand() % 45) - 22.5;
+                //                if (delay < 1) angle = (buffer.Rand() % 45) - 22.5;
                 //                int xx = WaveDirection? NumberWaves * BufferWi - x - 1: x;
                 WaveBuffer0[x1] = (delay-- > 0) ? WaveBuffer0[x1 - 1] + delta : 2 * yc;
                 if (WaveBuffer0[x1] >= 2 * buffer.BufferHt) { delta = -2; WaveBuffer0[x1] = 2 * buffer.BufferHt - 1; if (delay > 1) delay = 1; }
                 if (WaveBuffer0[x1] < 0) { delta = 2; WaveBuffer0[x1] = 0; if (delay > 1) delay = 1; }
                 if (delay < 1) {
-                    delta = (rand() % 7) - 3;
-                    delay = 2 + (rand() % 3);
+                    delta = (buffer.Rand() % 7) - 3;
+                    delay = 2 + (buffer.Rand() % 3);
                 }
             }
         }
@@ -0,0 +1,159 @@
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <wx/wx.h>
+#include <wx/tokenzr.h>
+
+#include "FaceStateDefinition.h"
+#include "Model.h"
+#include "../UtilFunctions.h"
+
+static void AddSpan(std::vector<std::pair<int, int>>& spans, int start, int end)
+{
+    if (!spans.empty() && start <= end && spans.back().first <= spans.back().second && spans.back().second + 1 == start) {
+        spans.back().second = end;
+    } else {
+        spans.push_back({ start, end });
+    }
+}
+
+// "1-5,7" ... one based node numbers
+static void ParseNodeRanges(const std::string& channels, std::vector<std::pair<int, int>>& spans)
+{
+    wxStringTokenizer wtkz(channels, ",");
+    while (wtkz.HasMoreTokens()) {
+        wxString valstr = wtkz.GetNextToken();
+
+        int start, end;
+        if (valstr.Contains("-")) {
+            int idx = valstr.Index('-');
+            start = wxAtoi(valstr.Left(idx));
+            end = wxAtoi(valstr.Right(valstr.size() - idx - 1));
+            if (end < start) {
+                std::swap(start, end);
+            }
+        } else {
+            start = end = wxAtoi(valstr);
+        }
+        if (start > end) {
+            start = end;
+        }
+        AddSpan(spans, start - 1, end - 1);
+    }
+}
+
+static void ParseNodeNames(const std::string& channels, const std::map<std::string, std::vector<int>>& nodes, std::vector<std::pair<int, int>>& spans)
+{
+    wxStringTokenizer wtkz(channels, ",");
+    while (wtkz.HasMoreTokens()) {
+        auto it = nodes.find(wtkz.GetNextToken().ToStdString());
+        if (it != nodes.end()) {
+            for (int n : it->second) {
+                AddSpan(spans, n, n);
+            }
+        }
+    }
+}
+
+FaceStateDefinition::FaceStateDefinition(const Model* model, const std::string& name, const std::map<std::string, std::string>& info, bool face)
+{
+    auto type = info.find("Type");
+    _type = (type == info.end() || type->second == "") ? name : type->second;
+    auto cc = info.find("CustomColors");
+    _customColors = cc != info.end() && cc->second == "1";
+
+    // faces and states have always matched node names slightly differently
+    bool byName;
+    bool byRange;
+    if (face) {
+        byName = _type == "Coro" || _type == "SingleNode";
+        byRange = _type == "NodeRange";
+    } else {
+        byName = _type == "SingleNode";
+        byRange = !byName;
+    }
+    std::map<std::string, std::vector<int>> nodes;
+    if (byName) {
+        for (size_t x = 0; x < model->GetNodeCount(); x++) {
+            std::string nn = model->GetNodeName(x, true);
+            if (face) {
+                // one node per name with Node N also usable for named nodes
+                nodes[nn] = { (int)x };
+                std::string def = wxString::Format("Node %d", (int)x + 1).ToStdString();
+                if (nn != def) {
+                    nodes[def] = { (int)x };
+                }
+            } else {
+                nodes[nn].push_back((int)x);
+            }
+        }
+    }
+
+    for (const auto& it : info) {
+        if (EndsWith(it.first, "-Color") || EndsWith(it.first, "-Name")) {
+            continue;
+        }
+        Part part;
+        part.name = it.first;
+        part.value = it.second;
+        auto color = info.find(it.first + "-Color");
+        if (color != info.end() && color->second != "") {
+            part.color = xlColor(color->second);
+            part.hasColor = true;
+        }
+        if (byName) {
+            ParseNodeNames(it.second, nodes, part.spans);
+        } else if (byRange) {
+            ParseNodeRanges(it.second, part.spans);
+        }
+        if (!face && it.first.size() > 1) {
+            part.number = wxAtoi(it.first.substr(1));
+        }
+        _ids[it.first] = _parts.size();
+        _parts.push_back(part);
+    }
+
+    if (!face) {
+        // states are drawn in the order their names appear in the definition
+        for (const auto& it : info) {
+            if (EndsWith(it.first, "-Name") && it.second != "") {
+                _allStateNames.push_back(Lower(it.second));
+                std::string statename = BeforeFirst(it.first, '-');
+                int id = GetPartId(statename);
+                if (statename != "" && id != -1 && _parts[id].value != "") {
+                    _stateNames[it.second].push_back(id);
+                }
+            }
+        }
+    }
+}
+
+int FaceStateDefinition::GetPartId(const std::string& name) const
+{
+    auto it = _ids.find(name);
+    if (it == _ids.end()) {
+        return -1;
+    }
+    return it->second;
+}
+
+const std::string& FaceStateDefinition::GetValue(const std::string& name) const
+{
+    static const std::string empty;
+    int id = GetPartId(name);
+    return id == -1 ? empty : _parts[id].value;
+}
+
+const std::vector<int>& FaceStateDefinition::GetStatesNamed(const std::string& name) const
+{
+    static const std::vector<int> none;
+    auto it = _stateNames.find(name);
+    return it == _stateNames.end() ? none : it->second;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+/***************************************************************
+ * This source files comes from the xLights project
+ * https://www.xlights.org
+ * https://github.com/smeighan/xLights
+ * See the github commit history for a record of contributing
+ * developers.
+ * Copyright claimed based on commit dates recorded in Github
+ * License: https://github.com/smeighan/xLights/blob/master/License.txt
+ **************************************************************/
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../Color.h"
+
+class Model;
+
+// A face or state definition from a model's faceInfo/stateInfo compiled down to node indexes and colours.
+//
+// The Faces and State effects used to look up, tokenise and parse these strings every frame. The model builds these
+// the first time they are needed after it changes and the effects then work with part ids and node spans.
+class FaceStateDefinition
+{
+public:
+    struct Part
+    {
+        std::string name;                       // key in the definition eg Mouth-AI or s1
+        std::string value;                      // raw value ... image file names for matrix faces
+        std::vector<std::pair<int, int>> spans; // zero based inclusive node ranges in drawing order
+        xlColor color = xlWHITE;                // the custom colour or white if none was set
+        bool hasColor = false;                  // a colour was set
+        int number = 0;                         // states only, 1 for s1
+    };
+
+    FaceStateDefinition(const Model* model, const std::string& name, const std::map<std::string, std::string>& info, bool face);
+
+    // the Type entry or the definition name if there isnt one
+    const std::string& GetType() const { return _type; }
+    bool HasCustomColors() const { return _customColors; }
+
+    // -1 if the definition has no such entry
+    int GetPartId(const std::string& name) const;
+    const Part& GetPart(int id) const { return _parts[id]; }
+    const std::string& GetValue(const std::string& name) const;
+
+    // ids of the states with this name which have nodes
+    const std::vector<int>& GetStatesNamed(const std::string& name) const;
+    // lower case names of every named state for * and <ALL>
+    const std::vector<std::string>& GetAllStateNames() const { return _allStateNames; }
+
+private:
+    std::string _type;
+    bool _customColors = false;
+    std::vector<Part> _parts;
+    std::map<std::string, int> _ids;
+    std::map<std::string, std::vector<int>> _stateNames;
+    std::vector<std::string> _allStateNames;
+};
@@ -48,6 +48,7 @@
 #include "../Pixels.h"
 #include "../ExternalHooks.h"
 #include "CustomModel.h"
+#include "FaceStateDefinition.h"
 
 #include <log4cpp/Category.hh>
 
@@ -2146,12 +2147,55 @@ void Model::AddFace(wxXmlNode* n)
 {
     ParseFaceInfo(n, faceInfo);
     Model::WriteFaceInfo(ModelXml, faceInfo);
+    ClearCompiledDefinitions();
 }
 
 void Model::AddState(wxXmlNode* n)
 {
     ParseStateInfo(n, stateInfo);
     Model::WriteStateInfo(ModelXml, stateInfo);
+    ClearCompiledDefinitions();
+}
+
+void Model::ClearCompiledDefinitions()
+{
+    std::unique_lock<std::mutex> lock(compiledDefinitionsLock);
+    compiledFaces.clear();
+    compiledStates.clear();
+}
+
+std::shared_ptr<const FaceStateDefinition> Model::GetCompiledDefinition(const std::string& name, bool face)
+{
+    std::unique_lock<std::mutex> lock(compiledDefinitionsLock);
+    // node names and the definitions can only change along with the change count
+    if (compiledDefinitionsChangeCount != GetChangeCount()) {
+        compiledDefinitionsChangeCount = GetChangeCount();
+        compiledFaces.clear();
+        compiledStates.clear();
+    }
+    auto& compiled = face ? compiledFaces : compiledStates;
+    auto it = compiled.find(name);
+    if (it != compiled.end()) {
+        return it->second;
+    }
+    std::shared_ptr<const FaceStateDefinition> def;
+    const auto& info = face ? faceInfo : stateInfo;
+    auto i = info.find(name);
+    if (i != info.end()) {
+        def = std::make_shared<const FaceStateDefinition>(this, name, i->second, face);
+    }
+    compiled[name] = def;
+    return def;
+}
+
+std::shared_ptr<const FaceStateDefinition> Model::GetFaceDefinition(const std::string& name)
+{
+    return GetCompiledDefinition(name, true);
+}
+
+std::shared_ptr<const FaceStateDefinition> Model::GetStateDefinition(const std::string& name)
+{
+    return GetCompiledDefinition(name, false);
 }
 
 void Model::ImportShadowModels(wxXmlNode* n, xLightsFrame* xlights)
@@ -2837,6 +2881,7 @@ void Model::SetFromXml(wxXmlNode* ModelNode, bool zb)
     wxXmlNode* f = ModelNode->GetChildren();
     faceInfo.clear();
     stateInfo.clear();
+    ClearCompiledDefinitions();
     wxXmlNode* dimmingCurveNode = nullptr;
     wxXmlNode* controllerConnectionNode = nullptr;
     while (f != nullptr) {
@@ -15,6 +15,8 @@
 #include <vector>
 #include <list>
 #include <tuple>
+#include <memory>
+#include <mutex>
 
 #include "ModelScreenLocation.h"
 #include "BoxedScreenLocation.h"
@@ -48,6 +50,7 @@ class xlVertexIndexedColorAccumulator;
 class xlVertexColorAccumulator;
 class xlVertexAccumulator;
 class xlGraphicsContext;
+class FaceStateDefinition;
 typedef std::unique_ptr<NodeBaseClass> NodeBaseClassPtr;
 
 #define NO_CONTROLLER "No Controller"
@@ -155,6 +158,11 @@ public:
     std::map<std::string, std::map<std::string, std::string> > stateInfo;
     void AddFace(wxXmlNode* n);
     void AddState(wxXmlNode* n);
+
+    // faceInfo/stateInfo compiled for rendering ... nullptr if there is no such definition
+    std::shared_ptr<const FaceStateDefinition> GetFaceDefinition(const std::string& name);
+    std::shared_ptr<const FaceStateDefinition> GetStateDefinition(const std::string& name);
+    void ClearCompiledDefinitions();
     void AddSubmodel(wxXmlNode* n);
     void ImportShadowModels(wxXmlNode* n, xLightsFrame* xlights);
 
@@ -654,7 +662,12 @@ protected:
     };
     std::map<std::string, PreviewGraphicsCacheInfo*> uiCaches;
     virtual void deleteUIObjects();
-    
+
+    std::mutex compiledDefinitionsLock;
+    unsigned long compiledDefinitionsChangeCount = 0;
+    std::map<std::string, std::shared_ptr<const FaceStateDefinition>> compiledFaces;
+    std::map<std::string, std::shared_ptr<const FaceStateDefinition>> compiledStates;
+    std::shared_ptr<const FaceStateDefinition> GetCompiledDefinition(const std::string& name, bool face);
 };
 
 template <class ScreenLocation>
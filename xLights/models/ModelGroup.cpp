@@ -17,6 +17,7 @@
 #include "SingleLineModel.h"
 #include "ModelScreenLocation.h"
 #include "../UtilFunctions.h"
+#include "../MemoryAccounting.h"
 
 #include <log4cpp/Category.hh>
 
@@ -453,6 +454,10 @@ bool ModelGroup::Reset(bool zeroBased) {
     models.clear();
     modelNames.clear();
     changeCount = 0;
+    {
+        std::unique_lock<std::mutex> lock(_layoutCacheLock);
+        ClearLayoutCache();
+    }
     wxArrayString mn = wxSplit(ModelXml->GetAttribute("models"), ',');
     int nc = 0;
     for (int x = 0; x < mn.size(); x++) {
@@ -632,7 +637,13 @@ void ModelGroup::ResetModels()
     }
 }
 
-ModelGroup::~ModelGroup() {}
+ModelGroup::~ModelGroup() {
+    if (_layoutReclaimerId != -1) {
+        MemoryAccounting::UnregisterReclaimer(_layoutReclaimerId);
+    }
+    std::unique_lock<std::mutex> lock(_layoutCacheLock);
+    ClearLayoutCache();
+}
 
 unsigned ModelGroup::GetFirstChannel() const
 {
@@ -803,8 +814,86 @@ bool ModelGroup::CheckForChanges() const {
     return false;
 }
 
+// Hash of everything the buffer layouts depend on. It looks up the member models so must be called without the
+// cache lock held ... the model manager lock is taken while the cache lock is held by the other side of a reset
+uint64_t ModelGroup::GetLayoutSignature() const {
+    uint64_t sig = FNV1A_SEED;
+    auto mix = [&sig](uint64_t v) {
+        sig = FNV1a(sig, v);
+    };
+    mix(GetChangeCount());
+    mix(std::hash<std::string>()(defaultBufferStyle));
+    for (const auto& it : modelNames) {
+        Model* m = modelManager[it];
+        mix((uint64_t)(uintptr_t)m);
+        if (m != nullptr) {
+            mix(m->GetChangeCount());
+        }
+    }
+    for (const auto& m : GetFlatModels(false)) {
+        mix((uint64_t)(uintptr_t)m);
+        mix(m->GetChangeCount());
+        mix(m->GetNodeCount());
+        mix(m->GetFirstChannel());
+        mix(m->IsActive());
+    }
+    return sig;
+}
+
+void ModelGroup::CheckLayoutCache(uint64_t signature) const {
+    if (signature != _layoutSignature) {
+        ClearLayoutCache();
+        _layoutSignature = signature;
+    }
+}
+
+void ModelGroup::ClearLayoutCache() const {
+    _layoutCache.clear();
+    _bufferSizeCache.clear();
+    MemoryAccounting::Remove(MemoryAccounting::PIXEL_BUFFERS, _layoutCacheBytes);
+    _layoutCacheBytes = 0;
+}
+
+// called by the memory accounting from any thread so it skips the cache if it is busy
+size_t ModelGroup::ReclaimLayoutCache(size_t bytesWanted) const {
+    std::unique_lock<std::mutex> lock(_layoutCacheLock, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return 0;
+    }
+    size_t freed = _layoutCacheBytes;
+    ClearLayoutCache();
+    return freed;
+}
+
 void ModelGroup::GetBufferSize(const std::string &tp, const std::string &camera, const std::string &transform, int &BufferWi, int &BufferHt) const {
     CheckForChanges();
+    // only 2D layouts are cached as camera positions can change without the models changing
+    if (camera != "2D") {
+        CalcBufferSize(tp, camera, transform, BufferWi, BufferHt);
+        return;
+    }
+
+    std::string key = tp + "|" + transform;
+    uint64_t sig = GetLayoutSignature();
+    {
+        std::unique_lock<std::mutex> lock(_layoutCacheLock);
+        CheckLayoutCache(sig);
+        auto it = _bufferSizeCache.find(key);
+        if (it != _bufferSizeCache.end()) {
+            BufferWi = it->second.first;
+            BufferHt = it->second.second;
+            return;
+        }
+    }
+    CalcBufferSize(tp, camera, transform, BufferWi, BufferHt);
+    std::unique_lock<std::mutex> lock(_layoutCacheLock);
+    // the group may have changed while the size was worked out
+    if (sig == _layoutSignature) {
+        _bufferSizeCache[key] = std::pair<int, int>(BufferWi, BufferHt);
+    }
+}
+
+void ModelGroup::CalcBufferSize(const std::string &tp, const std::string &camera, const std::string &transform, int &BufferWi, int &BufferHt) const {
     std::string type = tp;
     if (type.compare(0, 9, "Per Model") == 0) {
         type = "Default";
@@ -954,6 +1043,83 @@ void ModelGroup::InitRenderBufferNodes(const std::string& tp,
                                        int& BufferWi, int& BufferHt, bool deep) const
 {
     CheckForChanges();
+    if (camera != "2D" || !Nodes.empty()) {
+        BuildRenderBufferNodes(tp, camera, transform, Nodes, BufferWi, BufferHt, deep);
+        return;
+    }
+
+    std::string key = tp + "|" + transform + (deep ? "|deep" : "");
+    uint64_t sig = GetLayoutSignature();
+    {
+        std::unique_lock<std::mutex> lock(_layoutCacheLock);
+        CheckLayoutCache(sig);
+        auto it = _layoutCache.find(key);
+        if (it != _layoutCache.end()) {
+            it->second.lastUsed = ++_layoutUse;
+            Nodes.reserve(it->second.nodes.size());
+            for (const auto& n : it->second.nodes) {
+                Nodes.emplace_back(n->clone());
+            }
+            BufferWi = it->second.bufferWi;
+            BufferHt = it->second.bufferHt;
+            return;
+        }
+    }
+
+    BuildRenderBufferNodes(tp, camera, transform, Nodes, BufferWi, BufferHt, deep);
+
+    CachedLayout layout;
+    layout.bytes = sizeof(CachedLayout);
+    for (const auto& n : Nodes) {
+        layout.bytes += sizeof(NodeBaseClass) + n->Coords.size() * sizeof(NodeBaseClass::CoordStruct);
+    }
+    if (MemoryAccounting::WouldExceedBudget(layout.bytes)) {
+        // not worth pushing something else out to hold a second copy of the nodes
+        return;
+    }
+    layout.nodes.reserve(Nodes.size());
+    for (const auto& n : Nodes) {
+        layout.nodes.emplace_back(n->clone());
+    }
+    layout.bufferWi = BufferWi;
+    layout.bufferHt = BufferHt;
+
+    {
+        std::unique_lock<std::mutex> lock(_layoutCacheLock);
+        // the group may have changed while the nodes were built
+        if (sig != _layoutSignature) {
+            return;
+        }
+        while (_layoutCache.size() >= MAX_CACHED_LAYOUTS) {
+            auto oldest = _layoutCache.begin();
+            for (auto it = _layoutCache.begin(); it != _layoutCache.end(); ++it) {
+                if (it->second.lastUsed < oldest->second.lastUsed) {
+                    oldest = it;
+                }
+            }
+            _layoutCacheBytes -= oldest->second.bytes;
+            MemoryAccounting::Remove(MemoryAccounting::PIXEL_BUFFERS, oldest->second.bytes);
+            _layoutCache.erase(oldest);
+        }
+        layout.lastUsed = ++_layoutUse;
+        _layoutCacheBytes += layout.bytes;
+        MemoryAccounting::Add(MemoryAccounting::PIXEL_BUFFERS, layout.bytes);
+        _layoutCache[key] = std::move(layout);
+        // reclaimers only ever try the cache lock so registering while holding it is safe
+        if (_layoutReclaimerId == -1) {
+            _layoutReclaimerId = MemoryAccounting::RegisterReclaimer(MemoryAccounting::PIXEL_BUFFERS, MemoryAccounting::COST_REDRAW,
+                                                                     [this](size_t bytesWanted) { return ReclaimLayoutCache(bytesWanted); });
+        }
+    }
+    MemoryAccounting::CheckBudget();
+}
+
+void ModelGroup::BuildRenderBufferNodes(const std::string& tp,
+                                        const std::string& camera,
+                                        const std::string& transform,
+                                        std::vector<NodeBaseClassPtr>& Nodes,
+                                        int& BufferWi, int& BufferHt, bool deep) const
+{
     std::string type = tp;
     if (type.compare(0, 9, "Per Model") == 0) {
         type = "Default";
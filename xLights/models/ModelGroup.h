@@ -10,6 +10,8 @@
  * License: https://github.com/smeighan/xLights/blob/master/License.txt
  **************************************************************/
 
+#include <map>
+#include <mutex>
 #include <vector>
 #include <string>
 
@@ -74,10 +76,38 @@ class ModelGroup : public ModelWithScreenLocation<BoxedScreenLocation>
         static std::vector<std::string> GROUP_BUFFER_STYLES;
 
     private:
+        void CalcBufferSize(const std::string &type, const std::string &camera, const std::string &transform, int &BufferWi, int &BufferHi) const;
+        void BuildRenderBufferNodes(const std::string &type, const std::string &camera, const std::string &transform,
+                                    std::vector<NodeBaseClassPtr> &nodes, int &BufferWi, int &BufferHi, bool deep) const;
+        uint64_t GetLayoutSignature() const;
+        // these must be called with the cache lock held
+        void CheckLayoutCache(uint64_t signature) const;
+        void ClearLayoutCache() const;
+        size_t ReclaimLayoutCache(size_t bytesWanted) const;
 
         std::vector<std::string> modelNames;
         std::vector<Model *> models;
         bool selected;
         std::string defaultBufferStyle;
+
+        // Buffer layouts are expensive to build for large groups and the same ones get built for every render
+        // so they are kept until anything about the group or its models changes. Each cached layout is a second
+        // copy of the nodes so only the most recently used few are kept, they count against the memory budget
+        // and they are the first thing given back when over it.
+        struct CachedLayout {
+            std::vector<NodeBaseClassPtr> nodes;
+            int bufferWi = 0;
+            int bufferHt = 0;
+            size_t bytes = 0;
+            uint64_t lastUsed = 0;
+        };
+        static const size_t MAX_CACHED_LAYOUTS = 4;
+        mutable std::mutex _layoutCacheLock;
+        mutable uint64_t _layoutSignature = 0;
+        mutable uint64_t _layoutUse = 0;
+        mutable size_t _layoutCacheBytes = 0;
+        mutable int _layoutReclaimerId = -1;
+        mutable std::map<std::string, CachedLayout> _layoutCache;
+        mutable std::map<std::string, std::pair<int, int>> _bufferSizeCache;
 };
 
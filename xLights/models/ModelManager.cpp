@@ -45,6 +45,7 @@
 #include "../sequencer/Element.h"
 #include "../xLightsMain.h"
 #include "UtilFunctions.h"
+#include "UtilClasses.h"
 #include "outputs/Output.h"
 #include "outputs/Controller.h"
 #include "outputs/ControllerEthernet.h"
@@ -261,6 +262,31 @@ uint32_t ModelManager::GetLastChannel() const {
     return max;
 }
 
+// Returns the (start, count) channel spans mapped by at least one model.  Spans closer than minGap
+// channels are merged as there is nothing to gain by tracking small holes separately.
+std::vector<std::pair<uint32_t, uint32_t>> ModelManager::GetUsedChannelRanges(int minGap) const
+{
+    std::lock_guard<std::recursive_mutex> lock(_modelMutex);
+    RangeAccumulator ranges;
+    for (const auto& it : models) {
+        if (it.second->GetDisplayAs() != "ModelGroup" && it.second->GetNodeCount() > 0) {
+            uint32_t first = it.second->GetFirstChannel();
+            uint32_t last = it.second->GetLastChannel();
+            if (first <= last) {
+                ranges.Add((int)first, (int)last);
+            }
+        }
+    }
+    ranges.Consolidate(minGap);
+
+    std::vector<std::pair<uint32_t, uint32_t>> res;
+    res.reserve(ranges.size());
+    for (const auto& it : ranges) {
+        res.push_back(std::pair<uint32_t, uint32_t>(it.first, it.second - it.first + 1));
+    }
+    return res;
+}
+
 void ModelManager::ResetModelGroups() const
 {
     //static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
@@ -460,91 +486,99 @@ void ModelManager::AddModelGroups(wxXmlNode* n, int w, int h, const std::string&
     AddModel(mg);
 }
 
+// Adds the model a start channel string chains off or is relative to
+static void AddStartChannelDependency(const std::string& name, const std::string& startChannel, const std::map<std::string, Model*>& models, std::set<std::string>& dependsOn)
+{
+    std::string sc = Trim(startChannel);
+    if (sc.size() > 1 && (sc[0] == '>' || sc[0] == '@') && sc.find(':') != std::string::npos) {
+        std::string dep = Trim(sc.substr(1, sc.find(':') - 1));
+        auto it = models.find(dep);
+        if (dep != name && it != models.end() && it->second->GetDisplayAs() != "ModelGroup") {
+            dependsOn.emplace(dep);
+        }
+    }
+}
+
 bool ModelManager::RecalcStartChannels() const {
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
     std::lock_guard<std::recursive_mutex> lock(_modelMutex);
 
     wxStopWatch sw;
     bool changed = false;
-    std::set<std::string> modelsDone;
-    std::set<std::string> modelsOnNoController;
 
+    // parse every start channel once and build the graph of which models depend on which
+    std::map<std::string, std::list<std::string>> dependents;
+    std::map<std::string, size_t> waitingOn;
+    std::map<std::string, bool> wasValid;
+    std::list<std::string> ready;
     for (const auto& it : models) {
+        if (it.second->GetDisplayAs() == "ModelGroup") continue;
+
+        wasValid[it.first] = it.second->CouldComputeStartChannel;
         it.second->CouldComputeStartChannel = false;
-    }
 
-    // first go through all models whose start channels are not dependent on other models
-    for (const auto& it : models) {
-        if (it.second->GetDisplayAs() != "ModelGroup")
-        {
-            char first = '0';
-            if (Trim(it.second->ModelStartChannel) != "") first = Trim(it.second->ModelStartChannel)[0];
-            if (first != '>' && first != '@')
-            {
-                modelsDone.emplace(it.first);
-                auto oldsc = it.second->GetFirstChannel();
-                it.second->SetFromXml(it.second->GetModelXml());
-                if (oldsc != it.second->GetFirstChannel())
-                {
-                    changed = true;
+        wxXmlNode* xml = it.second->GetModelXml();
+        std::set<std::string> dependsOn;
+        AddStartChannelDependency(it.first, xml->GetAttribute("StartChannel", "1").ToStdString(), models, dependsOn);
+        if (xml->GetAttribute("Advanced", "0") == "1") {
+            // individual string start channels can chain off other models too
+            for (wxXmlAttribute* attr = xml->GetAttributes(); attr != nullptr; attr = attr->GetNext()) {
+                if (attr->GetName().StartsWith("String") && attr->GetName().Mid(6).IsNumber()) {
+                    AddStartChannelDependency(it.first, attr->GetValue().ToStdString(), models, dependsOn);
                 }
             }
-            if (it.second->GetControllerName() == NO_CONTROLLER) {
-                modelsOnNoController.emplace(it.first);
-            }
+        }
+        waitingOn[it.first] = dependsOn.size();
+        for (const auto& d : dependsOn) {
+            dependents[d].push_back(it.first);
+        }
+        if (dependsOn.empty()) {
+            ready.push_back(it.first);
         }
     }
 
-    // now go through all undone models that depend on something
-    bool workDone = false;
-    do
-    {
-        workDone = false;
-
-        for (const auto& it : models) {
-            if (it.second->GetDisplayAs() != "ModelGroup")
-            {
-                char first = '0';
-                if (Trim(it.second->ModelStartChannel) != "") first = Trim(it.second->ModelStartChannel)[0];
-                if ((first == '>' || first == '@') && !it.second->CouldComputeStartChannel)
-                {
-                    std::string dependsOn = Trim(Trim(it.second->ModelStartChannel).substr(1, Trim(it.second->ModelStartChannel).find(':') - 1));
-
-                    if (first == '>'  && modelsOnNoController.find(dependsOn) != modelsOnNoController.end()) {
-                        modelsOnNoController.emplace(it.first);
-                    }
-
-                    if (modelsDone.find(dependsOn) != modelsDone.end() && modelsOnNoController.find(dependsOn) == modelsOnNoController.end())
-                    {
-                        // the depends on model is done
-                        modelsDone.emplace(it.first);
-                        auto oldsc = it.second->GetFirstChannel();
-                        it.second->SetFromXml(it.second->GetModelXml());
-                        if (oldsc != it.second->GetFirstChannel())
-                        {
-                            changed = true;
-                        }
-                        if (it.second->CouldComputeStartChannel)
-                        {
-                            workDone = true;
-                        }
-                    }
-                }
+    // resolve in dependency order so every model a start channel refers to is already done
+    int reinitialised = 0;
+    int resolved = 0;
+    while (!ready.empty()) {
+        std::string name = ready.front();
+        ready.pop_front();
+        Model* m = models.at(name);
+        resolved++;
+
+        bool valid = false;
+        std::string dependsOnModel;
+        std::string sc = m->GetModelXml()->GetAttribute("StartChannel", "1").ToStdString();
+        int32_t start = m->GetNumberFromChannelString(sc, valid, dependsOnModel);
+        auto oldsc = m->GetFirstChannel();
+        if (wasValid[name] && valid && sc == m->ModelStartChannel && m->GetNodeCount() > 0 &&
+            m->GetModelXml()->GetAttribute("Advanced", "0") != "1" && start - 1 == (int32_t)oldsc) {
+            // the start channel has not moved so there is no need to rebuild the model
+            m->CouldComputeStartChannel = true;
+        } else {
+            m->SetFromXml(m->GetModelXml());
+            reinitialised++;
+            if (oldsc != m->GetFirstChannel()) {
+                changed = true;
             }
         }
 
-    } while (workDone);
+        for (const auto& d : dependents[name]) {
+            if (--waitingOn[d] == 0) {
+                ready.push_back(d);
+            }
+        }
+    }
 
-    // now process anything unprocessed
+    // anything left is part of, or depends on, a circular reference
     int countInvalid = 0;
     for (const auto& it : models) {
         if (it.second->GetDisplayAs() != "ModelGroup") {
-            char first = '0';
-            if (Trim(it.second->ModelStartChannel) != "") first = Trim(it.second->ModelStartChannel)[0];
-            if ((first == '>' || first == '@') && !it.second->CouldComputeStartChannel) {
-                modelsDone.emplace(it.first);
+            if (waitingOn[it.first] != 0) {
+                logger_base.warn("Start channel of model '%s' (%s) is part of or depends on a circular reference.", (const char*)it.first.c_str(), (const char*)it.second->ModelStartChannel.c_str());
                 auto oldsc = it.second->GetFirstChannel();
                 it.second->SetFromXml(it.second->GetModelXml());
+                reinitialised++;
                 if (oldsc != it.second->GetFirstChannel()) {
                     changed = true;
                 }
@@ -554,6 +588,7 @@ bool ModelManager::RecalcStartChannels() const {
             }
         }
     }
+    logger_base.debug("RecalcStartChannels resolved %d models, %d needed reinitialising.", resolved, reinitialised);
 
     ResetModelGroups();
 
@@ -41,6 +41,7 @@ class ModelManager : public ObjectManager
 
         bool RecalcStartChannels() const;
         uint32_t GetLastChannel() const;
+        std::vector<std::pair<uint32_t, uint32_t>> GetUsedChannelRanges(int minGap = 4096) const;
         void DisplayStartChannelCalcWarning() const;
         bool ReworkStartChannel() const;
 
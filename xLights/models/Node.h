@@ -142,6 +142,21 @@ public:
         }
     }
 
+    // GetForChannels with a lookup table applied to each of red, green and blue. false if this type of node works out
+    // its channels some other way and the colour must be changed first
+    virtual bool GetForChannelsCurved(unsigned char* buf, const uint8_t* const* tables) const
+    {
+        if (chanCnt != NODE_RGB_CHAN_CNT) {
+            return false;
+        }
+        for (int x = 0; x < 3; x++) {
+            if (offsets[x] != 255) {
+                buf[offsets[x]] = tables[x][c[x]];
+            }
+        }
+        return true;
+    }
+
     virtual const std::string &GetNodeType() const;
 
     uint32_t GetChanCount() const
@@ -482,6 +497,10 @@ public:
 
     virtual void SetFromChannels(const unsigned char* buf) override;
     virtual void GetForChannels(unsigned char* buf) const override;
+    virtual bool GetForChannelsCurved(unsigned char* buf, const uint8_t* const* tables) const override
+    {
+        return false;
+    }
     virtual NodeBaseClass* clone() const override
     {
         return new NodeClassSuperString(*this);
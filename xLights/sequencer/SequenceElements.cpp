@@ -14,6 +14,8 @@
 #include <wx/filename.h>
 
 #include <algorithm>
+#include <atomic>
+#include <map>
 
 #include "SequenceElements.h"
 #include "TimeLine.h"
@@ -28,6 +30,8 @@
 #include "../JukeboxPanel.h"
 #include "../TraceLog.h"
 #include "../UtilFunctions.h"
+#include "../Parallel.h"
+#include "../SequenceCache.h"
 
 #include <log4cpp/Category.hh>
 
@@ -641,6 +645,30 @@ void SequenceElements::MoveElement(int index,int destinationIndex)
     SortElements();
 }
 
+static void FixEffectSettings(std::string& settings)
+{
+    if (settings.find("E_FILEPICKER_Pictures_Filename") != std::string::npos) {
+        settings = FixEffectFileParameter("E_FILEPICKER_Pictures_Filename", settings, "");
+    }
+    else if (settings.find("E_FILEPICKER_Glediator_Filename") != std::string::npos) {
+        settings = FixEffectFileParameter("E_FILEPICKER_Glediator_Filename", settings, "");
+    }
+}
+
+// returns true if the effect db entry was changed
+static bool FixEffectDBEntry(wxString& content, const wxString& ShowDir)
+{
+    if (content.Find("E_FILEPICKER_Pictures_Filename") >= 0) {
+        content = FixEffectFileParameter("E_FILEPICKER_Pictures_Filename", content, ShowDir);
+        return true;
+    }
+    else if (content.Find("E_TEXTCTRL_Glediator_Filename") >= 0) {
+        content = FixEffectFileParameter("E_TEXTCTRL_Glediator_Filename", content, ShowDir);
+        return true;
+    }
+    return false;
+}
+
 int SequenceElements::LoadEffects(EffectLayer* effectLayer,
     const std::string& type,
     wxXmlNode* effectLayerNode,
@@ -686,12 +714,7 @@ int SequenceElements::LoadEffects(EffectLayer* effectLayer,
                     settings = ToStdString(effect->GetNodeContent());
                 }
 
-                if (settings.find("E_FILEPICKER_Pictures_Filename") != std::string::npos) {
-                    settings = FixEffectFileParameter("E_FILEPICKER_Pictures_Filename", settings, "");
-                }
-                else if (settings.find("E_FILEPICKER_Glediator_Filename") != std::string::npos) {
-                    settings = FixEffectFileParameter("E_FILEPICKER_Glediator_Filename", settings, "");
-                }
+                FixEffectSettings(settings);
 
                 wxString tmp;
                 if (effect->GetAttribute(STR_PALETTE, &tmp)) {
@@ -707,7 +730,7 @@ int SequenceElements::LoadEffects(EffectLayer* effectLayer,
                 pal = colorPalettes[palette];
             }
             effectLayer->AddEffect(id, effectName, settings, pal,
-                startTime, endTime, EFFECT_NOT_SELECTED, bProtected);
+                startTime, endTime, EFFECT_NOT_SELECTED, bProtected, true);
         }
         else if (effect->GetName() == STR_NODE && effectLayerNode->GetName() == STR_STRAND) {
             StrandElement* se = (StrandElement*)effectLayer->GetParentElement();
@@ -720,9 +743,205 @@ int SequenceElements::LoadEffects(EffectLayer* effectLayer,
         }
         loaded++;
     }
+    // effects were added unsorted so sort them just once now they are all in
+    effectLayer->SortEffects();
     return loaded;
 }
 
+// Same as LoadEffects but from a layer of the sequence snapshot
+int SequenceElements::LoadCachedEffects(EffectLayer* effectLayer,
+    const std::string& type,
+    const SequenceCache& cache,
+    const SequenceCache::CachedLayer& layer,
+    const std::vector<std::string>& effectStrings,
+    const std::vector<std::string>& colorPalettes)
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    for (uint32_t i = layer.firstEffect; i < layer.firstEffect + layer.effectCount; i++) {
+        const SequenceCache::CachedEffect& effect = cache.GetEffect(i);
+        double startTime = TimeLine::RoundToMultipleOfPeriod(effect.startTime, mFrequency);
+        double endTime = TimeLine::RoundToMultipleOfPeriod(effect.endTime, mFrequency);
+        std::string effectName = cache.GetString(effect.name);
+        std::string settings;
+        std::string pal = STR_EMPTY;
+        if (type != STR_TIMING) {
+            if (effect.settings < 0) {
+                if (effect.ref < 0 || effect.ref >= effectStrings.size()) {
+                    logger_base.warn("Effect string not found for effect %s between %d and %d. Settings ignored.", (const char*)effectName.c_str(), (int)startTime, (int)endTime);
+                }
+                else {
+                    settings = effectStrings[effect.ref];
+                }
+            }
+            else {
+                settings = cache.GetString(effect.settings);
+            }
+            FixEffectSettings(settings);
+
+            if (effect.palette >= 0 && effect.palette < colorPalettes.size()) {
+                pal = colorPalettes[effect.palette];
+            }
+        }
+        effectLayer->AddEffect(effect.id, effectName, settings, pal,
+            startTime, endTime, EFFECT_NOT_SELECTED, effect.isProtected != 0, true);
+    }
+    effectLayer->SortEffects();
+    return layer.effectCount;
+}
+
+// Creates the layers for one <Element> node and loads its effects. Only touches the element passed in
+// and the things it owns so it is safe to call for different elements concurrently
+int SequenceElements::LoadElementEffects(Element* element,
+    wxXmlNode* elementNode,
+    const SequenceCache* cache,
+    int cacheIndex,
+    int sequenceEndMS,
+    const std::vector<std::string>& effectStrings,
+    const std::vector<std::string>& colorPalettes)
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    int loaded = 0;
+
+    // check for fixed timing interval
+    int interval = 0;
+    if (elementNode->GetAttribute(STR_TYPE) == STR_TIMING)
+    {
+        interval = wxAtoi(elementNode->GetAttribute("fixed"));
+    }
+    if (interval > 0)
+    {
+        if (interval != TimeLine::RoundToMultipleOfPeriod(interval, mFrequency))
+        {
+            int newinterval = TimeLine::RoundToMultipleOfPeriod(interval, mFrequency);
+            if (newinterval == 0) newinterval = 1000/mFrequency;
+            logger_base.warn("Timing interval of %dms not a multiple of frame time so changed to %dms.", interval, newinterval);
+            interval = newinterval;
+        }
+        dynamic_cast<TimingElement*>(element)->SetFixedTiming(interval);
+        EffectLayer* effectLayer = element->AddEffectLayer();
+        int time = 0;
+        while (time < sequenceEndMS)
+        {
+            int startTime = time;
+            int endTime = time + interval;
+            effectLayer->AddEffect(0, "", "", "", startTime, endTime, EFFECT_NOT_SELECTED, false, true); // we can suppress sort because we know we are adding them in time order
+            time += interval;
+        }
+        effectLayer->NumberEffects();
+        return loaded;
+    }
+
+    if (cache != nullptr)
+    {
+        // the xml only holds a shell of the element ... the layers come from the snapshot
+        const SequenceCache::CachedElement& ce = cache->GetElement(cacheIndex);
+        std::string type = elementNode->GetAttribute(STR_TYPE).ToStdString();
+        ModelElement* me = dynamic_cast<ModelElement*>(element);
+        for (uint32_t l = ce.firstLayer; l < ce.firstLayer + ce.layerCount; l++) {
+            const SequenceCache::CachedLayer& cl = cache->GetLayer(l);
+            EffectLayer* effectLayer = nullptr;
+            if (cl.type == SequenceCache::LayerType::EFFECT_LAYER) {
+                effectLayer = element->AddEffectLayer();
+            }
+            else if (me == nullptr) {
+                logger_base.error("Element %s was not a model element. This typically happens when a timing track is created with the same name as a model.", (const char *)element->GetName().c_str());
+            }
+            else if (cl.type == SequenceCache::LayerType::SUBMODEL_LAYER) {
+                SubModelElement* se = me->GetSubModel(cache->GetString(cl.name), true);
+                while (cl.layer >= se->GetEffectLayerCount()) {
+                    se->AddEffectLayer();
+                }
+                effectLayer = se->GetEffectLayer(cl.layer);
+            }
+            else {
+                StrandElement* se = me->GetStrand(cl.index, true);
+                if (cl.type == SequenceCache::LayerType::STRAND_LAYER) {
+                    while (cl.layer >= se->GetEffectLayerCount()) {
+                        se->AddEffectLayer();
+                    }
+                    effectLayer = se->GetEffectLayer(cl.layer);
+                    if (cl.name >= 0) {
+                        se->SetName(cache->GetString(cl.name));
+                    }
+                }
+                else {
+                    NodeLayer* nl = se->GetNodeLayer(cl.layer, true);
+                    if (cl.name >= 0) {
+                        nl->SetName(cache->GetString(cl.name));
+                    }
+                    effectLayer = nl;
+                }
+            }
+            if (effectLayer != nullptr) {
+                loaded += LoadCachedEffects(effectLayer, type, *cache, cl, effectStrings, colorPalettes);
+            }
+        }
+        return loaded;
+    }
+
+    for (wxXmlNode* effectLayerNode = elementNode->GetChildren(); effectLayerNode != nullptr; effectLayerNode = effectLayerNode->GetNext())
+    {
+        EffectLayer* effectLayer = nullptr;
+        if (effectLayerNode->GetName() == STR_EFFECTLAYER) {
+            effectLayer = element->AddEffectLayer();
+        }
+        else if (effectLayerNode->GetName() == STR_SUBMODEL_EFFECTLAYER) {
+            wxString name = effectLayerNode->GetAttribute("name").Trim(true).Trim(false);
+            if (name != effectLayerNode->GetAttribute("name")) {
+                effectLayerNode->DeleteAttribute("name");
+                effectLayerNode->AddAttribute("name", name);
+            }
+            int layer = wxAtoi(effectLayerNode->GetAttribute("layer", "0"));
+            SubModelElement *se = dynamic_cast<ModelElement*>(element)->GetSubModel(name.ToStdString(), true);
+            wxASSERT(se != nullptr);
+            while (layer >= se->GetEffectLayerCount()) {
+                se->AddEffectLayer();
+            }
+            effectLayer = se->GetEffectLayer(layer);
+        }
+        else {
+            if (dynamic_cast<ModelElement*>(element) != nullptr) {
+                StrandElement* se = dynamic_cast<ModelElement*>(element)->GetStrand(wxAtoi(effectLayerNode->GetAttribute(STR_INDEX)), true);
+                int layer = wxAtoi(effectLayerNode->GetAttribute("layer", "0"));
+                while (layer >= se->GetEffectLayerCount()) {
+                    se->AddEffectLayer();
+                }
+                effectLayer = se->GetEffectLayer(layer);
+                if (effectLayerNode->GetAttribute(STR_NAME, STR_EMPTY) != STR_EMPTY) {
+                    se->SetName(effectLayerNode->GetAttribute(STR_NAME).Trim(true).Trim(false).ToStdString());
+                }
+            }
+            else                                         {
+                logger_base.error("Element %s was not a model element: %s. This typically happens when a timing track is created with the same name as a model.", (const char *)element->GetName().c_str());
+            }
+        }
+        if (effectLayer != nullptr) {
+            loaded += LoadEffects(effectLayer, elementNode->GetAttribute(STR_TYPE).ToStdString(), effectLayerNode, effectStrings, colorPalettes);
+        }
+        else
+        {
+            wxASSERT(false);
+        }
+    }
+    return loaded;
+}
+
+// the snapshot holds the effects for the Element nodes of its shell xml one to one
+static bool SnapshotMatches(wxXmlNode* root, const SequenceCache* cache)
+{
+    int elementNodes = 0;
+    for (wxXmlNode* e = root->GetChildren(); e != nullptr; e = e->GetNext()) {
+        if (e->GetName() == "ElementEffects") {
+            for (wxXmlNode* elementNode = e->GetChildren(); elementNode != nullptr; elementNode = elementNode->GetNext()) {
+                if (elementNode->GetName() == STR_ELEMENT) elementNodes++;
+            }
+        }
+    }
+    return elementNodes == (int)cache->GetElementCount();
+}
+
 bool SequenceElements::LoadSequencerFile(xLightsXmlFile& xml_file, const wxString &ShowDir)
 {
     static log4cpp::Category &logger_base = log4cpp::Category::getInstance(std::string("log_base"));
@@ -739,12 +958,30 @@ bool SequenceElements::LoadSequencerFile(xLightsXmlFile& xml_file, const wxStrin
     Clear();
     TraceLog::AddTraceMessage("   Cleared");
     supportsModelBlending = xml_file.supportsModelBlending();
+    const SequenceCache* cache = xml_file.GetLoadCache();
+    if (cache != nullptr && !SnapshotMatches(root, cache)) {
+        // the shell xml has no effects so carrying on without the snapshot would lose them all
+        logger_base.error("Sequence snapshot does not match the sequence. Loading the whole sequence file.");
+        if (!xml_file.ReloadWithoutLoadCache()) {
+            return false;
+        }
+        root = seqDocument.GetRoot();
+        supportsModelBlending = xml_file.supportsModelBlending();
+        cache = nullptr;
+    }
+
+    // time each stage so slow loads can be tracked down from the log
+    wxStopWatch sw;
+    long elementsTime = 0;
+    long effectDBTime = 0;
+    long effectsTime = 0;
     for (wxXmlNode* e = root->GetChildren(); e != nullptr; e = e->GetNext())
     {
         TraceLog::PushTraceContext();
         TraceLog::AddTraceMessage("Processing " + e->GetName());;
         if (e->GetName() == "DisplayElements")
         {
+            sw.Start();
             std::list<wxXmlNode*> toremove;
             for (wxXmlNode* element = e->GetChildren(); element != nullptr; element = element->GetNext())
             {
@@ -789,6 +1026,7 @@ bool SequenceElements::LoadSequencerFile(xLightsXmlFile& xml_file, const wxStrin
             for (const auto& it : toremove) {
                 e->RemoveChild(it);
             }
+            elementsTime += sw.Time();
         }
         else if (e->GetName() == "TimingTags")
         {
@@ -808,26 +1046,36 @@ bool SequenceElements::LoadSequencerFile(xLightsXmlFile& xml_file, const wxStrin
         }
         else if (e->GetName() == "EffectDB")
         {
+            sw.Start();
             effectStrings.clear();
+            if (cache != nullptr) {
+                // the snapshot holds the effect db as it was in the file so the same fixes apply
+                effectStrings.reserve(cache->GetEffectDBSize());
+                for (size_t i = 0; i < cache->GetEffectDBSize(); i++) {
+                    wxString content = cache->GetEffectDBString(i);
+                    FixEffectDBEntry(content, ShowDir);
+                    effectStrings.push_back(ToStdString(content));
+                }
+            }
             for (wxXmlNode* elementNode = e->GetChildren(); elementNode != nullptr; elementNode = elementNode->GetNext())
             {
                 if (elementNode->GetName() == STR_EFFECT)
                 {
-                    if (elementNode->GetNodeContent().Find("E_FILEPICKER_Pictures_Filename") >= 0)
-                    {
-                        elementNode->SetContent(FixEffectFileParameter("E_FILEPICKER_Pictures_Filename", elementNode->GetNodeContent(), ShowDir));
-                    }
-                    else if (elementNode->GetNodeContent().Find("E_TEXTCTRL_Glediator_Filename") >= 0)
+                    // only pull the content out of the node once ... it gets rebuilt from the text children every call
+                    wxString content = elementNode->GetNodeContent();
+                    if (FixEffectDBEntry(content, ShowDir))
                     {
-                        elementNode->SetContent(FixEffectFileParameter("E_TEXTCTRL_Glediator_Filename", elementNode->GetNodeContent(), ShowDir));
+                        elementNode->SetContent(content);
                     }
 
-                    effectStrings.push_back(ToStdString(elementNode->GetNodeContent()));
+                    effectStrings.push_back(ToStdString(content));
                 }
             }
+            effectDBTime += sw.Time();
         }
         else if (e->GetName() == "ColorPalettes")
         {
+            sw.Start();
             colorPalettes.clear();
             for (wxXmlNode* elementNode = e->GetChildren(); elementNode != nullptr; elementNode = elementNode->GetNext())
             {
@@ -836,6 +1084,7 @@ bool SequenceElements::LoadSequencerFile(xLightsXmlFile& xml_file, const wxStrin
                     colorPalettes.push_back(ToStdString(elementNode->GetNodeContent()));
                 }
             }
+            effectDBTime += sw.Time();
         }
         else if (e->GetName() == "Jukebox")
         {
@@ -843,26 +1092,19 @@ bool SequenceElements::LoadSequencerFile(xLightsXmlFile& xml_file, const wxStrin
         }
         else if (e->GetName() == "ElementEffects")
         {
-            int count = 0;
-            for (wxXmlNode* elementNode = e->GetChildren(); elementNode != NULL; elementNode = elementNode->GetNext())
-            {
-                if (elementNode->GetName() == STR_ELEMENT)
-                {
-                    for (wxXmlNode* effectLayerNode = elementNode->GetChildren(); effectLayerNode != nullptr; effectLayerNode = effectLayerNode->GetNext())
-                    {
-                        for (wxXmlNode* effect = effectLayerNode->GetChildren(); effect != nullptr; effect = effect->GetNext())
-                        {
-                            count++;
-                        }
-                    }
-                }
-            }
-
-            int loaded = 0;
+            sw.Start();
+            // Resolve the element nodes to their elements first on this thread. Everything an element owns
+            // (layers, strands, submodels and node layers) is then only ever touched by one job below
+            // so the effects can be materialised for all the elements in parallel
+            // the Element nodes line up one to one with the elements in the snapshot when there is one
+            std::vector<std::pair<Element*, std::vector<std::pair<wxXmlNode*, int>>>> toLoad;
+            std::map<Element*, size_t> elementIndex;
+            int cacheIndex = 0;
             for (wxXmlNode* elementNode = e->GetChildren(); elementNode != NULL; elementNode = elementNode->GetNext())
             {
                 if (elementNode->GetName() == STR_ELEMENT)
                 {
+                    int nodeCacheIndex = cache == nullptr ? -1 : cacheIndex++;
                     auto nm = elementNode->GetAttribute(STR_NAME).Trim(true).Trim(false);
                     if (elementNode->GetAttribute(STR_NAME) != nm) {
                         elementNode->DeleteAttribute(STR_NAME);
@@ -871,83 +1113,13 @@ bool SequenceElements::LoadSequencerFile(xLightsXmlFile& xml_file, const wxStrin
                     Element* element = GetElement(elementNode->GetAttribute(STR_NAME));
                     if (element != nullptr)
                     {
-                        // check for fixed timing interval
-                        int interval = 0;
-                        if (elementNode->GetAttribute(STR_TYPE) == STR_TIMING)
-                        {
-                            interval = wxAtoi(elementNode->GetAttribute("fixed"));
+                        auto it = elementIndex.find(element);
+                        if (it == elementIndex.end()) {
+                            elementIndex[element] = toLoad.size();
+                            toLoad.push_back({ element, { { elementNode, nodeCacheIndex } } });
                         }
-                        if (interval > 0)
-                        {
-                            if (interval != TimeLine::RoundToMultipleOfPeriod(interval, mFrequency))
-                            {
-                                int newinterval = TimeLine::RoundToMultipleOfPeriod(interval, mFrequency);
-                                if (newinterval == 0) newinterval = 1000/mFrequency;
-                                logger_base.warn("Timing interval of %dms not a multiple of frame time so changed to %dms.", interval, newinterval);
-                                interval = newinterval;
-                            }
-                            dynamic_cast<TimingElement*>(element)->SetFixedTiming(interval);
-                            EffectLayer* effectLayer = element->AddEffectLayer();
-                            int time = 0;
-                            int end_time = TimeLine::RoundToMultipleOfPeriod(xml_file.GetSequenceDurationMS(), mFrequency);
-                            while (time < end_time)
-                            {
-                                int startTime = time;
-                                int endTime = time + interval;
-                                effectLayer->AddEffect(0, "", "", "", startTime, endTime, EFFECT_NOT_SELECTED, false, true); // we can suppress sort because we know we are adding them in time order
-                                time += interval;
-                            }
-                            effectLayer->NumberEffects();
-                        }
-                        else
-                        {
-                            for (wxXmlNode* effectLayerNode = elementNode->GetChildren(); effectLayerNode != nullptr; effectLayerNode = effectLayerNode->GetNext())
-                            {
-                                EffectLayer* effectLayer = nullptr;
-                                if (effectLayerNode->GetName() == STR_EFFECTLAYER) {
-                                    effectLayer = element->AddEffectLayer();
-                                }
-                                else if (effectLayerNode->GetName() == STR_SUBMODEL_EFFECTLAYER) {
-                                    wxString name = effectLayerNode->GetAttribute("name").Trim(true).Trim(false);
-                                    if (name != effectLayerNode->GetAttribute("name")) {
-                                        effectLayerNode->DeleteAttribute("name");
-                                        effectLayerNode->AddAttribute("name", name);
-                                    }
-                                    int layer = wxAtoi(effectLayerNode->GetAttribute("layer", "0"));
-                                    SubModelElement *se = dynamic_cast<ModelElement*>(element)->GetSubModel(name.ToStdString(), true);
-                                    wxASSERT(se != nullptr);
-                                    while (layer >= se->GetEffectLayerCount()) {
-                                        se->AddEffectLayer();
-                                    }
-                                    effectLayer = se->GetEffectLayer(layer);
-                                }
-                                else {
-                                    if (dynamic_cast<ModelElement*>(element) != nullptr) {
-                                        StrandElement* se = dynamic_cast<ModelElement*>(element)->GetStrand(wxAtoi(effectLayerNode->GetAttribute(STR_INDEX)), true);
-                                        int layer = wxAtoi(effectLayerNode->GetAttribute("layer", "0"));
-                                        while (layer >= se->GetEffectLayerCount()) {
-                                            se->AddEffectLayer();
-                                        }
-                                        effectLayer = se->GetEffectLayer(layer);
-                                        if (effectLayerNode->GetAttribute(STR_NAME, STR_EMPTY) != STR_EMPTY) {
-                                            se->SetName(effectLayerNode->GetAttribute(STR_NAME).Trim(true).Trim(false).ToStdString());
-                                        }
-                                    }
-                                    else                                         {
-                                        logger_base.error("Element %s was not a model element: %s. This typically happens when a timing track is created with the same name as a model.", (const char *)element->GetName().c_str());
-                                    }
-                                }
-                                if (effectLayer != nullptr) {
-                                    loaded += LoadEffects(effectLayer, elementNode->GetAttribute(STR_TYPE).ToStdString(), effectLayerNode, effectStrings, colorPalettes);
-                                    if (count) {
-                                        GetXLightsFrame()->SetStatusText(wxString::Format("Effects Loaded: %i%%.", loaded * 100 / count));
-                                    }
-                                }
-                                else
-                                {
-                                    wxASSERT(false);
-                                }
-                            }
+                        else {
+                            toLoad[it->second].second.push_back({ elementNode, nodeCacheIndex });
                         }
                     }
                     else
@@ -956,6 +1128,17 @@ bool SequenceElements::LoadSequencerFile(xLightsXmlFile& xml_file, const wxStrin
                     }
                 }
             }
+
+            GetXLightsFrame()->SetStatusText(wxString::Format("Loading effects for %d elements.", (int)toLoad.size()));
+            int end_time = TimeLine::RoundToMultipleOfPeriod(xml_file.GetSequenceDurationMS(), mFrequency);
+            std::atomic_int loaded(0);
+            parallel_for(0, toLoad.size(), [&](int i) {
+                for (const auto& elementNode : toLoad[i].second) {
+                    loaded += LoadElementEffects(toLoad[i].first, elementNode.first, elementNode.second < 0 ? nullptr : cache, elementNode.second, end_time, effectStrings, colorPalettes);
+                }
+            });
+            effectsTime += sw.Time();
+            GetXLightsFrame()->SetStatusText(wxString::Format("Effects Loaded: %d.", (int)loaded));
         }
         TraceLog::PopTraceContext();
     }
@@ -966,7 +1149,11 @@ bool SequenceElements::LoadSequencerFile(xLightsXmlFile& xml_file, const wxStrin
         }
     }
 
-    logger_base.debug("Sequencer file loaded.");
+    // the snapshot is only needed while loading
+    xml_file.ReleaseLoadCache();
+
+    logger_base.debug("Sequencer file loaded. Elements %ldms, EffectDB/Palettes %ldms (%d/%d), Effects %ldms.",
+        elementsTime, effectDBTime, (int)effectStrings.size(), (int)colorPalettes.size(), effectsTime);
 
     return true;
 }
@@ -17,9 +17,11 @@
 #include <set>
 #include <string>
 #include <mutex>
+#include <atomic>
 #include "wx/xml/xml.h"
 #include "wx/filename.h"
 #include "UndoManager.h"
+#include "../SequenceCache.h"
 
 class xLightsXmlFile;  // forward declaration needed due to circular dependency
 class SequenceViewManager;
@@ -209,11 +211,24 @@ public:
     xLightsFrame *GetXLightsFrame() const { return xframe; };
 protected:
 private:
+    int LoadElementEffects(Element *element,
+        wxXmlNode *elementNode,
+        const SequenceCache *cache,
+        int cacheIndex,
+        int sequenceEndMS,
+        const std::vector<std::string> & effectStrings,
+        const std::vector<std::string> & colorPalettes);
     int LoadEffects(EffectLayer *layer,
         const std::string &type,
         wxXmlNode *effectLayerNode,
         const std::vector<std::string> & effectStrings,
         const std::vector<std::string> & colorPalettes);
+    int LoadCachedEffects(EffectLayer *layer,
+        const std::string &type,
+        const SequenceCache &cache,
+        const SequenceCache::CachedLayer &cachedLayer,
+        const std::vector<std::string> & effectStrings,
+        const std::vector<std::string> & colorPalettes);
     static bool SortElementsByIndex(const Element *element1, const Element *element2)
     {
         return (element1->GetIndex() < element2->GetIndex());
@@ -252,7 +267,7 @@ private:
 
     // mFirstVisibleModelRow=0 is first model row not the row in Row_Information struct.
     int mFirstVisibleModelRow;
-    unsigned int mChangeCount;
+    std::atomic<unsigned int> mChangeCount;
     unsigned int mMasterViewChangeCount;
     UndoManager undo_mgr;
 
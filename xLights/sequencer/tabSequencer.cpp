@@ -255,10 +255,17 @@ void xLightsFrame::InitSequencer()
             wxString mss = CurrentSeqXmlFile->GetSequenceTiming();
             int ms = wxAtoi(mss);
 
-            _seqData.init(GetMaxNumChannels(), CurrentSeqXmlFile->GetSequenceDurationMS() / ms, ms);
+            InitSequenceData(CurrentSeqXmlFile->GetSequenceDurationMS() / ms, ms);
             _sequenceElements.IncrementChangeCount(nullptr);
 
             SetStatusTextColor("Render buffer recreated. A render all is required.", *wxRED);
+        } else if (_seqData.IsSparse()) {
+            auto ranges = AllModels.GetUsedChannelRanges();
+            if (!_seqData.CoversRanges(ranges)) {
+                logger_base.info("Models have moved into unused channels ... extending sparse sequence data.");
+                AbortRender();
+                _seqData.ExtendSparseRanges(ranges);
+            }
         }
     }
 
@@ -2348,6 +2355,10 @@ bool xLightsFrame::TimerRgbSeq(long msec)
     RecordTimingCheckpoint();
     int frame = curt / _seqData.FrameTime();
     if (frame < _seqData.NumFrames()) {
+        if (frame % 20 == 0) {
+            // keep the next second or so paged in if the sequence data is disk backed
+            _seqData.Prefetch(frame, 40);
+        }
         //have the frame, copy from SeqData
         if (playModel != nullptr) {
             int nn = playModel->GetNodeCount();
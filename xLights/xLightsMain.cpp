@@ -42,6 +42,8 @@
 #include "UpdaterDialog.h"
 #include "xLightsApp.h"
 #include "SeqSettingsDialog.h"
+#include "SequenceCache.h"
+#include "MemoryAccounting.h"
 #include "xLightsVersion.h"
 #include "RenderCommandEvent.h"
 #include "effects/RenderableEffect.h"
@@ -1793,6 +1795,21 @@ xLightsFrame::xLightsFrame(wxWindow* parent, int ab, wxWindowID id) :
     config->Read(_("xLightsShadersOnBackgroundThreads"), &bgShaders, false);
     ShaderEffect::SetBackgroundRender(bgShaders);
 
+    // sequences needing more than half the physical memory get their frame data backed by a file
+    long seqDataDiskThresholdMB = 0;
+    config->Read(_("xLightsSequenceDataDiskThresholdMB"), &seqDataDiskThresholdMB, (long)(GetPhysicalMemorySizeMB() / 2));
+    SequenceData::SetDiskBackingThreshold((size_t)seqDataDiskThresholdMB * 1024 * 1024);
+    SequenceData::SetDiskBackingFolder(config->Read(_("xLightsSequenceDataDiskFolder"), "").ToStdString());
+
+    // once sequence data, render cache, buffers and audio together pass this the cheapest caches are released first ... 0 disables
+    long memoryBudgetMB = 0;
+    config->Read(_("xLightsMemoryBudgetMB"), &memoryBudgetMB, (long)(GetPhysicalMemorySizeMB() * 3 / 4));
+    MemoryAccounting::SetBudget((uint64_t)std::max(0L, memoryBudgetMB) * 1024 * 1024);
+
+    bool sequenceLoadCache = true;
+    config->Read(_("xLightsSequenceLoadCache"), &sequenceLoadCache, true);
+    SequenceCache::SetEnabled(sequenceLoadCache);
+
     DrawingContext::Initialize(this);
 
     MenuItem_File_Save->Enable(true);
@@ -3451,6 +3468,13 @@ uint32_t xLightsFrame::GetMaxNumChannels() {
     return std::max((uint32_t)_outputManager.GetTotalChannels(), (uint32_t)(AllModels.GetLastChannel() + 1));
 }
 
+void xLightsFrame::InitSequenceData(unsigned int numFrames, unsigned int frameTime)
+{
+    // only the channels models map need memory, gaps between them are left untouched
+    _seqData.SetSparseRanges(AllModels.GetUsedChannelRanges());
+    _seqData.init(GetMaxNumChannels(), numFrames, frameTime);
+}
+
 void xLightsFrame::UpdateSequenceLength()
 {
     if( CurrentSeqXmlFile->GetSequenceLoaded() )
@@ -3459,7 +3483,7 @@ void xLightsFrame::UpdateSequenceLength()
         int ms = wxAtoi(mss);
 
         AbortRender();
-        _seqData.init(GetMaxNumChannels(), CurrentSeqXmlFile->GetSequenceDurationMS() / ms, ms);
+        InitSequenceData(CurrentSeqXmlFile->GetSequenceDurationMS() / ms, ms);
         _sequenceElements.IncrementChangeCount(nullptr);
 
         mainSequencer->PanelTimeLine->SetTimeLength(CurrentSeqXmlFile->GetSequenceDurationMS());
@@ -7643,7 +7667,9 @@ void xLightsFrame::TimerOutput(int period)
 {
     if (CheckBoxLightOutput->IsChecked())
     {
-        _outputManager.SetManyChannels(0, &_seqData[period][0], _seqData.NumChannels());
+        _seqData[period].ForEachUsedRange([this](uint32_t start, unsigned char* data, uint32_t count) {
+            _outputManager.SetManyChannels(start, data, count);
+        });
     }
 }
 
@@ -78,6 +78,7 @@
 #include "xLightsXmlFile.h"
 #include "sequencer/EffectsGrid.h"
 #include "RenderCache.h"
+#include "RenderCheckpoints.h"
 #include "outputs/ZCPP.h"
 #include "OutputModelManager.h"
 #include "models/Model.h"
@@ -315,6 +316,7 @@ public:
     int TxOverflowTotal = 0;
     std::mutex saveLock;
     RenderCache _renderCache;
+    RenderCheckpoints _renderCheckpoints;
     std::atomic_bool _exiting;
 
     PhonemeDictionary dictionary;
@@ -1407,6 +1409,7 @@ public:
 
     void SetXmlSetting(const wxString& settingName,const wxString& value);
     uint32_t GetMaxNumChannels();
+    void InitSequenceData(unsigned int numFrames, unsigned int frameTime);
 
     void UpdateSequenceVideoPanel( const wxString& path );
 
@@ -32,6 +32,7 @@
 #include "sequencer/TimeLine.h"
 #include "Vixen3.h"
 #include "ExternalHooks.h"
+#include "SequenceCache.h"
 
 #include <log4cpp/Category.hh>
 
@@ -72,6 +73,35 @@ xLightsXmlFile::~xLightsXmlFile()
         delete audio;
         audio = nullptr;
     }
+    ReleaseLoadCache();
+}
+
+void xLightsXmlFile::ReleaseLoadCache()
+{
+    if (load_cache != nullptr) {
+        delete load_cache;
+        load_cache = nullptr;
+    }
+}
+
+// the snapshot is taken from the document in memory ... the file is hashed and the snapshot written in the background
+void xLightsXmlFile::WriteLoadCache()
+{
+    WriteLoadCache(BuildLoadCache());
+}
+
+void xLightsXmlFile::WriteLoadCache(std::vector<uint8_t>&& snapshot)
+{
+    if (snapshot.empty()) return;
+
+    SequenceCache::WriteInBackground(SequenceCache::GetCacheFile(load_cache_folder.ToStdString(), GetName().ToStdString()),
+                                     GetFullPath().ToStdString(), std::move(snapshot));
+}
+
+std::vector<uint8_t> xLightsXmlFile::BuildLoadCache()
+{
+    if (load_cache_folder == "" || !SequenceCache::IsEnabled()) return std::vector<uint8_t>();
+    return SequenceCache::Build(seqDocument);
 }
 
 bool xLightsXmlFile::IsXmlSequence(wxFileName& fname)
@@ -987,6 +1017,7 @@ bool xLightsXmlFile::LoadV3Sequence()
     SaveCopy();
 
     UpdateVersion("4.2.19");
+    SequenceCache::SequenceFileChanging();
     seqDocument.Save(GetFullPath());
 
     was_converted = true;
@@ -1029,16 +1060,10 @@ void xLightsXmlFile::ConvertToFixedPointTiming()
     }
 }
 
-bool xLightsXmlFile::LoadSequence(const wxString& ShowDir, bool ignore_audio)
+// expands compressed sections, fixes old timings and fixes up file paths in a freshly parsed document
+void xLightsXmlFile::PrepareDocument()
 {
     static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
-    logger_base.info("LoadSequence: Loading sequence " + GetFullPath());
-
-    if (!seqDocument.Load(GetFullPath())) {
-        logger_base.error("LoadSequence: XML file load failed.");
-        return false;
-    }
-    is_open = true;
 
     wxXmlNode* root = seqDocument.GetRoot();
     for (wxXmlNode* e = root->GetChildren(); e != nullptr; e = e->GetNext()) {
@@ -1066,6 +1091,111 @@ bool xLightsXmlFile::LoadSequence(const wxString& ShowDir, bool ignore_audio)
         root->AddAttribute("FixedPointTiming", "1");
     }
 
+    for (wxXmlNode* e = root->GetChildren(); e != nullptr; e = e->GetNext()) {
+        if (e->GetName() == "head") {
+            for (wxXmlNode* element = e->GetChildren(); element != nullptr; element = element->GetNext()) {
+                if (element->GetName() == "mediaFile") {
+                    if (!load_ignore_audio) {
+                        logger_base.debug("LoadSequence: mediaFile %s", (const char*)element->GetNodeContent().c_str());
+                        wxString mf = FixFile(load_show_dir, element->GetNodeContent());
+                        if (mf != element->GetNodeContent()) element->SetContent(mf);
+                    }
+                }
+                else if (element->GetName() == "imageDir") {
+                    wxString id = FixFile(load_show_dir, element->GetNodeContent());
+                    if (id != element->GetNodeContent()) element->SetContent(id);
+                }
+            }
+        }
+        else if (e->GetName() == "DataLayers") {
+            for (wxXmlNode* element = e->GetChildren(); element != nullptr; element = element->GetNext()) {
+                if (element->GetName() == "DataLayer") {
+                    wxString data = element->GetAttribute("data");
+                    if (!data.StartsWith("<")) {
+                        wxString fixed = FixFile("", data);
+                        if (fixed != data) {
+                            element->DeleteAttribute("data");
+                            element->AddAttribute("data", fixed);
+                        }
+                    }
+                    wxString source = element->GetAttribute("source");
+                    wxString fixed = FixFile("", source);
+                    if (fixed != source) {
+                        element->DeleteAttribute("source");
+                        element->AddAttribute("source", fixed);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// The snapshot the sequence was loaded from does not match it. Throw the snapshot away and parse the whole file
+// again so nothing is loaded from a partial document.
+bool xLightsXmlFile::ReloadWithoutLoadCache()
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+
+    ReleaseLoadCache();
+    if (load_cache_folder != "") {
+        std::string loadCacheFile = SequenceCache::GetCacheFile(load_cache_folder.ToStdString(), GetName().ToStdString());
+        if (wxFileExists(loadCacheFile)) {
+            wxRemoveFile(loadCacheFile);
+        }
+    }
+
+    logger_base.info("ReloadWithoutLoadCache: Loading sequence " + GetFullPath());
+    if (!seqDocument.Load(GetFullPath())) {
+        logger_base.error("ReloadWithoutLoadCache: XML file load failed.");
+        return false;
+    }
+    PrepareDocument();
+    WriteLoadCache();
+    return true;
+}
+
+bool xLightsXmlFile::LoadSequence(const wxString& ShowDir, bool ignore_audio)
+{
+    static log4cpp::Category& logger_base = log4cpp::Category::getInstance(std::string("log_base"));
+    logger_base.info("LoadSequence: Loading sequence " + GetFullPath());
+
+    wxStopWatch sw;
+    load_show_dir = ShowDir;
+    load_ignore_audio = ignore_audio;
+
+    // if the sequence has not changed since we last saw it the bulk of the xml can come from the binary snapshot
+    ReleaseLoadCache();
+    uint64_t fileHash = 0;
+    uint64_t fileSize = 0;
+    bool useLoadCache = load_cache_folder != "" && SequenceCache::IsEnabled() && SequenceCache::HashFile(GetFullPath().ToStdString(), fileHash, fileSize);
+    std::string loadCacheFile = useLoadCache ? SequenceCache::GetCacheFile(load_cache_folder.ToStdString(), GetName().ToStdString()) : "";
+    if (useLoadCache) {
+        load_cache = SequenceCache::Read(loadCacheFile, fileHash, fileSize);
+        if (load_cache != nullptr) {
+            wxMemoryInputStream in(load_cache->GetXml().data(), load_cache->GetXml().size());
+            if (seqDocument.Load(in)) {
+                logger_base.debug("LoadSequence: Using snapshot %s.", (const char*)loadCacheFile.c_str());
+            }
+            else {
+                ReleaseLoadCache();
+            }
+        }
+    }
+
+    if (load_cache == nullptr && !seqDocument.Load(GetFullPath())) {
+        logger_base.error("LoadSequence: XML file load failed.");
+        return false;
+    }
+    logger_base.debug("LoadSequence: XML parsed in %ldms.", sw.Time());
+    is_open = true;
+
+    PrepareDocument();
+    wxXmlNode* root = seqDocument.GetRoot();
+
+    if (useLoadCache && load_cache == nullptr) {
+        WriteLoadCache();
+    }
+
     std::string mediaFileName = "";
     for (wxXmlNode* e = root->GetChildren(); e != nullptr; e = e->GetNext()) {
         if (e->GetName() == "head") {
@@ -1106,9 +1236,7 @@ bool xLightsXmlFile::LoadSequence(const wxString& ShowDir, bool ignore_audio)
                 }
                 else if (element->GetName() == "mediaFile") {
                     if (!ignore_audio) {
-                        logger_base.debug("LoadSequence: mediaFile %s", (const char*)element->GetNodeContent().c_str());
-                        media_file = FixFile(ShowDir, element->GetNodeContent());
-                        if (media_file != element->GetNodeContent()) element->SetContent(media_file);
+                        media_file = element->GetNodeContent();
                         logger_base.debug("LoadSequence: mediaFile after fix %s", (const char*)media_file.c_str());
                         wxFileName mf = media_file;
                         if (audio != nullptr) {
@@ -1134,8 +1262,7 @@ bool xLightsXmlFile::LoadSequence(const wxString& ShowDir, bool ignore_audio)
                     SetSequenceDuration(element->GetNodeContent());
                 }
                 else if (element->GetName() == "imageDir") {
-                    image_dir = FixFile(ShowDir, element->GetNodeContent());
-                    if (image_dir != element->GetNodeContent()) element->SetContent(image_dir);
+                    image_dir = element->GetNodeContent();
                 }
             }
         }
@@ -1166,20 +1293,6 @@ bool xLightsXmlFile::LoadSequence(const wxString& ShowDir, bool ignore_audio)
                     element->GetAttribute("num_channels", &num_channels);
                     element->GetAttribute("channel_offset", &channel_offset);
                     element->GetAttribute("lor_params", &lor_params);
-                    if (!data.StartsWith("<")) {
-                        auto oldData = data;
-                        data = FixFile("", data);
-                        if (data != oldData) {
-                            element->DeleteAttribute("data");
-                            element->AddAttribute("data", data);
-                        }
-                    }
-                    auto oldSource = source;
-                    source = FixFile("", source);
-                    if (source != oldSource) {
-                        element->DeleteAttribute("source");
-                        element->AddAttribute("source", source);
-                    }
                     if (name == "Nutcracker") {
                         mDataLayers.RemoveDataLayer(0);
                     }
@@ -2545,6 +2658,7 @@ wxArrayString xLightsXmlFile::GetTimingList(const SequenceElements& seq_elements
 bool xLightsXmlFile::Save()
 {
     UpdateVersion();
+    SequenceCache::SequenceFileChanging();
     return seqDocument.Save(GetFullPath());
 }
 
@@ -2805,6 +2919,9 @@ void xLightsXmlFile::Save(SequenceElements& seq_elements)
     }
     UpdateVersion();
 
+    // snapshot the document before it is compressed so reopening what we are saving is quick
+    std::vector<uint8_t> snapshot = BuildLoadCache();
+
 #ifdef USE_COMPRESSION
     for (wxXmlNode* e = root->GetChildren(); e != nullptr; e = e->GetNext()) {
         wxString name = e->GetName();
@@ -2836,7 +2953,9 @@ void xLightsXmlFile::Save(SequenceElements& seq_elements)
     }
 #endif
 
+    SequenceCache::SequenceFileChanging();
     seqDocument.Save(GetFullPath());
+    WriteLoadCache(std::move(snapshot));
 }
 
 bool xLightsXmlFile::TimingAlreadyExists(const std::string & section, xLightsFrame* xLightsParent)
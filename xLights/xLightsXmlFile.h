@@ -19,6 +19,7 @@
 
 class SequenceElements;  // forward declaration needed due to circular dependency
 class xLightsFrame;
+class SequenceCache;
 
 WX_DECLARE_STRING_HASH_MAP( int, StringIntMap );
 
@@ -133,6 +134,19 @@ public:
         return sequence_loaded;
     }
 
+    // folder whose RenderCache subfolder holds the binary snapshot of this sequence ... blank disables the snapshot
+    void SetLoadCacheFolder(const wxString& folder)
+    {
+        load_cache_folder = folder;
+    }
+    SequenceCache* GetLoadCache() const
+    {
+        return load_cache;
+    }
+    void ReleaseLoadCache();
+    // discards the snapshot and parses the whole sequence file again
+    bool ReloadWithoutLoadCache();
+
     void AddNewTimingSection(const std::string& interval_name, xLightsFrame* xLightsParent);
     void AddNewTimingSection(const std::string& interval_name, xLightsFrame* xLightsParent, std::vector<int>& starts,
                              std::vector<int>& ends, std::vector<std::string>& labels);
@@ -209,6 +223,7 @@ public:
     static bool IsXmlSequence(wxFileName& fname);
 
 private:
+    void PrepareDocument();
     wxXmlDocument seqDocument;
     wxArrayString models;
     wxArrayString header_info;
@@ -225,8 +240,15 @@ private:
     bool sequence_loaded = false; // flag to indicate the sequencer has been loaded with this xml data
     DataLayerSet mDataLayers;
     AudioManager* audio = nullptr;
+    wxString load_cache_folder;
+    SequenceCache* load_cache = nullptr;
+    wxString load_show_dir;     // what LoadSequence was given ... PrepareDocument fixes paths with them
+    bool load_ignore_audio = false;
 
     void CreateNew();
+    void WriteLoadCache();
+    void WriteLoadCache(std::vector<uint8_t>&& snapshot);
+    std::vector<uint8_t> BuildLoadCache();
     bool LoadSequence(const wxString& ShowDir, bool ignore_audio = false);
     bool LoadV3Sequence();
     bool Save();